@@ -0,0 +1,134 @@
+#ifndef ASYNCPAYMENTPIPELINE_H
+#define ASYNCPAYMENTPIPELINE_H
+
+#include "PaymentProcessor.cpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Decouples booking threads from gateway round trips. Charges are queued and
+// picked up by a pool of workers, each of which waits up to maxBatchDelay for
+// up to maxBatchSize charges and sends them in one processPayments() call.
+// Results come back through a future or a completion callback, which runs on
+// a worker thread.
+class AsyncPaymentPipeline {
+private:
+    struct PaymentRequest {
+        double amount;
+        std::promise<bool> result;
+        std::function<void(bool)> callback;
+    };
+
+    PaymentProcessor& processor;
+    size_t maxBatchSize;
+    std::chrono::microseconds maxBatchDelay;
+
+    mutable std::mutex mutex;
+    std::condition_variable queueNotEmpty;
+    std::deque<PaymentRequest> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void enqueue(PaymentRequest request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(request));
+        }
+        queueNotEmpty.notify_one();
+    }
+
+    void workerLoop() {
+        std::vector<PaymentRequest> batch;
+        std::vector<double> amounts;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queueNotEmpty.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                auto deadline = std::chrono::steady_clock::now() + maxBatchDelay;
+                while (!stopping && queue.size() < maxBatchSize &&
+                       queueNotEmpty.wait_until(lock, deadline) == std::cv_status::no_timeout) {
+                }
+                size_t count = std::min(queue.size(), maxBatchSize);
+                for (size_t i = 0; i < count; ++i) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+            }
+            if (batch.empty()) {
+                continue;
+            }
+
+            for (const PaymentRequest& request : batch) {
+                amounts.push_back(request.amount);
+            }
+            std::vector<bool> results;
+            try {
+                results = processor.processPayments(amounts);
+            } catch (...) {
+                results.clear();
+            }
+            results.resize(batch.size(), false);
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (batch[i].callback) {
+                    batch[i].callback(results[i]);
+                } else {
+                    batch[i].result.set_value(results[i]);
+                }
+            }
+            batch.clear();
+            amounts.clear();
+        }
+    }
+
+public:
+    AsyncPaymentPipeline(PaymentProcessor& processor, size_t workerCount = 4, size_t maxBatchSize = 32,
+                         std::chrono::microseconds maxBatchDelay = std::chrono::microseconds(500))
+        : processor(processor), maxBatchSize(std::max<size_t>(1, maxBatchSize)), maxBatchDelay(maxBatchDelay) {
+        for (size_t i = 0; i < std::max<size_t>(1, workerCount); ++i) {
+            workers.emplace_back(&AsyncPaymentPipeline::workerLoop, this);
+        }
+    }
+
+    AsyncPaymentPipeline(const AsyncPaymentPipeline&) = delete;
+    AsyncPaymentPipeline& operator=(const AsyncPaymentPipeline&) = delete;
+
+    // Charges still queued at shutdown are processed before the workers exit.
+    ~AsyncPaymentPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queueNotEmpty.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::future<bool> submit(double amount) {
+        PaymentRequest request{amount, std::promise<bool>(), nullptr};
+        std::future<bool> result = request.result.get_future();
+        enqueue(std::move(request));
+        return result;
+    }
+
+    void submit(double amount, std::function<void(bool)> callback) {
+        enqueue(PaymentRequest{amount, std::promise<bool>(), std::move(callback)});
+    }
+
+    size_t pendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+};
+
+#endif // ASYNCPAYMENTPIPELINE_H
@@ -0,0 +1,92 @@
+#include "RentalSystem.cpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Books and cancels random hour-granular reservations, some of them empty and
+// some of those exactly at midnight, then checks that the day-bitmap search
+// agrees with the exact interval search on whole-day queries and compares how
+// long both take.
+static std::vector<std::string> platesOf(const std::vector<Car>& cars) {
+    std::vector<std::string> plates;
+    for (const Car& car : cars) {
+        plates.push_back(car.getLicensePlate());
+    }
+    std::sort(plates.begin(), plates.end());
+    return plates;
+}
+
+int main() {
+    RentalSystem* rentalSystem = RentalSystem::getInstance();
+    const auto day = std::chrono::hours(24);
+    const auto horizonStart = std::chrono::system_clock::time_point{} + day * 20000;
+    const std::vector<std::string> models = {"Camry", "Corolla", "Prius"};
+
+    std::vector<Car> fleet;
+    for (int i = 0; i < 3000; ++i) {
+        fleet.emplace_back("Toyota", models[i % models.size()], 2022, "TY" + std::to_string(i), 40.0 + i % 30);
+        rentalSystem->addCar(fleet.back());
+    }
+    rentalSystem->enableAvailabilityBitmaps(horizonStart, 365);
+
+    std::mt19937 rng(7);
+    Customer customer("Demo Customer", "demo@example.com", "DL4242");
+    std::vector<std::string> reservationIds;
+    for (int i = 0; i < 60000; ++i) {
+        auto startDate = horizonStart + std::chrono::hours(rng() % (360 * 24));
+        auto endDate = startDate + std::chrono::hours(1 + rng() % (6 * 24));
+        // Some empty bookings, half of them exactly at midnight.
+        if (i % 40 == 0) {
+            startDate = std::chrono::time_point_cast<std::chrono::system_clock::duration>(horizonStart + day * (rng() % 360));
+        }
+        if (i % 20 == 0) {
+            endDate = startDate;
+        }
+        auto reservation = rentalSystem->makeReservation(customer, fleet[rng() % fleet.size()], startDate, endDate);
+        if (reservation) {
+            reservationIds.push_back(reservation->getReservationId());
+        }
+        if (!reservationIds.empty() && rng() % 4 == 0) {
+            size_t victim = rng() % reservationIds.size();
+            rentalSystem->cancelReservation(reservationIds[victim]);
+            reservationIds[victim] = reservationIds.back();
+            reservationIds.pop_back();
+        }
+    }
+
+    // Retire some cars and move others to a different model.
+    for (size_t i = 0; i < 300; i += 3) {
+        rentalSystem->removeCar(fleet[i].getLicensePlate());
+        rentalSystem->addCar(Car("Toyota", models[(i + 2) % models.size()], 2023, fleet[i + 1].getLicensePlate(), 45.0));
+    }
+
+    std::vector<std::pair<std::chrono::system_clock::time_point, std::chrono::system_clock::time_point>> queries;
+    for (int i = 0; i < 2000; ++i) {
+        auto startDate = horizonStart + day * (rng() % 355);
+        queries.emplace_back(startDate, startDate + day * (1 + rng() % 7));
+    }
+
+    int mismatches = 0;
+    std::chrono::duration<double> exactTime{0}, bitmapTime{0};
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const std::string& model = models[i % models.size()];
+        auto begin = std::chrono::steady_clock::now();
+        auto exact = rentalSystem->searchCars("Toyota", model, queries[i].first, queries[i].second);
+        auto middle = std::chrono::steady_clock::now();
+        auto fast = rentalSystem->searchCarsForDays("Toyota", model, queries[i].first, queries[i].second);
+        auto end = std::chrono::steady_clock::now();
+        exactTime += middle - begin;
+        bitmapTime += end - middle;
+        if (platesOf(exact) != platesOf(fast)) {
+            ++mismatches;
+        }
+    }
+
+    std::cout << "Queries: " << queries.size() << ", mismatches: " << mismatches << "\n";
+    std::cout << "Interval search: " << exactTime.count() * 1000 << " ms, bitmap search: "
+              << bitmapTime.count() * 1000 << " ms\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -13,6 +13,8 @@ private:
     bool available;
 
 public:
+    Car() : make(""), model(""), year(0), licensePlate(""), rentalPricePerDay(0.0), available(true) {}
+
     Car(std::string make, std::string model, int year, std::string licensePlate, double rentalPricePerDay)
         : make(make), model(model), year(year), licensePlate(licensePlate), rentalPricePerDay(rentalPricePerDay), available(true) {}
 
@@ -20,6 +22,7 @@ public:
     std::string getLicensePlate() const { return licensePlate; }
     std::string getMake() const { return make; }
     std::string getModel() const { return model; }
+    int getYear() const { return year; }
     bool isAvailable() const { return available; }
     void setAvailable(bool available) { this->available = available; }
 };
@@ -0,0 +1,85 @@
+#ifndef CARINDEX_H
+#define CARINDEX_H
+
+#include "Car.cpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct CarSearchQuery {
+    std::string make;
+    std::string model;
+    std::chrono::system_clock::time_point startDate;
+    std::chrono::system_clock::time_point endDate;
+};
+
+// Secondary indexes over the fleet. Entries point at the Car objects owned by
+// RentalSystem::cars, whose nodes stay put until the car is removed.
+class CarIndex {
+private:
+    std::map<std::pair<std::string, std::string>, std::vector<const Car*>> byMakeModel;
+    std::multimap<int, const Car*> byYear;
+    std::multimap<double, const Car*> byPrice;
+
+    template <typename Key>
+    static void eraseEntry(std::multimap<Key, const Car*>& index, const Key& key, const Car* car) {
+        auto range = index.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == car) {
+                index.erase(it);
+                return;
+            }
+        }
+    }
+
+public:
+    void add(const Car* car) {
+        byMakeModel[{car->getMake(), car->getModel()}].push_back(car);
+        byYear.emplace(car->getYear(), car);
+        byPrice.emplace(car->getRentalPricePerDay(), car);
+    }
+
+    void remove(const Car* car) {
+        auto it = byMakeModel.find({car->getMake(), car->getModel()});
+        if (it != byMakeModel.end()) {
+            auto& cars = it->second;
+            auto pos = std::find(cars.begin(), cars.end(), car);
+            if (pos != cars.end()) {
+                *pos = cars.back();
+                cars.pop_back();
+            }
+            if (cars.empty()) {
+                byMakeModel.erase(it);
+            }
+        }
+        eraseEntry(byYear, car->getYear(), car);
+        eraseEntry(byPrice, car->getRentalPricePerDay(), car);
+    }
+
+    const std::vector<const Car*>& findByMakeModel(const std::string& make, const std::string& model) const {
+        static const std::vector<const Car*> none;
+        auto it = byMakeModel.find({make, model});
+        return it == byMakeModel.end() ? none : it->second;
+    }
+
+    std::vector<const Car*> findByYear(int minYear, int maxYear) const {
+        std::vector<const Car*> result;
+        for (auto it = byYear.lower_bound(minYear); it != byYear.end() && it->first <= maxYear; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    std::vector<const Car*> findByPrice(double minPricePerDay, double maxPricePerDay) const {
+        std::vector<const Car*> result;
+        for (auto it = byPrice.lower_bound(minPricePerDay); it != byPrice.end() && it->first <= maxPricePerDay; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+};
+
+#endif // CARINDEX_H
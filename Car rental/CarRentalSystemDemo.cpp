@@ -24,7 +24,7 @@ void runCarRentalSystemDemo() {
     auto availableCars = rentalSystem->searchCars("Toyota", "Camry", startDate, endDate);
     if (!availableCars.empty()) {
         Car selectedCar = availableCars.front();
-        Reservation* reservation = rentalSystem->makeReservation(customer1, selectedCar, startDate, endDate);
+        std::optional<Reservation> reservation = rentalSystem->makeReservation(customer1, selectedCar, startDate, endDate);
         if (reservation) {
             bool paymentSuccess = rentalSystem->processPayment(*reservation);
             if (paymentSuccess) {
@@ -0,0 +1,371 @@
+#ifndef CONCURRENTRENTALSYSTEM_H
+#define CONCURRENTRENTALSYSTEM_H
+
+#include "Car.cpp"
+#include "Customer.cpp"
+#include "Reservation.cpp"
+#include "ReservationStore.cpp"
+#include "ReservationIndex.cpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A validated group booking. Committing it books every car or none; the
+// version stamps record each car's schedule as it was at validation time.
+struct GroupReservationPlan {
+    Customer customer;
+    std::vector<Car> cars;
+    std::vector<uint64_t> carVersions;
+    std::chrono::system_clock::time_point startDate;
+    std::chrono::system_clock::time_point endDate;
+};
+
+// Thread-safe variant of RentalSystem. Cars and their reservations are sharded
+// by license plate, each shard behind its own reader/writer lock, so writers
+// only contend with operations on the same shard. Reserving is a single
+// check-and-insert under the shard's exclusive lock. searchCars takes no lock
+// at all: every shard also publishes an immutable view of each registered car
+// and its bookings, which writers replace after each change, so searches never
+// hold up writers.
+class ConcurrentRentalSystem {
+private:
+    // A registered car as searches see it. Never modified once published;
+    // a booking or cancellation publishes a new entry.
+    struct SearchEntry {
+        Car car;
+        // Booked [start, end) epochs, sorted.
+        std::vector<std::pair<int64_t, int64_t>> bookings;
+
+        // Same test as ReservationIndex::overlaps: bookings of one car never
+        // overlap, so only the last one starting before endEpoch can.
+        bool overlaps(int64_t startEpoch, int64_t endEpoch) const {
+            auto it = std::lower_bound(bookings.begin(), bookings.end(),
+                                       std::make_pair(endEpoch, std::numeric_limits<int64_t>::min()));
+            return it != bookings.begin() && startEpoch < std::prev(it)->second;
+        }
+    };
+
+    // Holds a registered car's current entry, swapped with atomic_store.
+    struct SearchSlot {
+        std::shared_ptr<const SearchEntry> entry;
+    };
+
+    // Registered cars by make and model; rebuilt when cars come and go.
+    using SearchView = std::map<std::pair<std::string, std::string>, std::vector<std::shared_ptr<SearchSlot>>>;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        ReservationStore reservations;
+        ReservationIndex reservationIndex;
+        // Registered cars by license plate; the view below groups the same
+        // slots for searches. Only accessed through atomic_load/atomic_store.
+        std::unordered_map<std::string, std::shared_ptr<SearchSlot>> searchSlots;
+        std::shared_ptr<const SearchView> searchView = std::make_shared<const SearchView>();
+        // Bumped on every booking or cancellation of the car, by CarHandle.
+        std::vector<uint64_t> carVersions;
+
+        uint64_t carVersion(const std::string& licensePlate) const {
+            CarHandle handle = reservations.findCar(licensePlate);
+            return handle < carVersions.size() ? carVersions[handle] : 0;
+        }
+
+        void bumpCarVersion(CarHandle handle) {
+            if (handle >= carVersions.size()) {
+                carVersions.resize(handle + 1, 0);
+            }
+            ++carVersions[handle];
+        }
+
+        ReservationHandle insert(uint64_t reservationNumber, const Car& car, const Customer& customer,
+                                 int64_t startEpoch, int64_t endEpoch, double totalPrice) {
+            CarHandle carHandle = reservations.internCar(car);
+            ReservationHandle handle = reservations.add(reservationNumber, carHandle, reservations.internCustomer(customer),
+                                                        startEpoch, endEpoch, totalPrice);
+            reservationIndex.insert(carHandle, startEpoch, endEpoch, handle);
+            bumpCarVersion(carHandle);
+            publishBooking(car.getLicensePlate(), startEpoch, endEpoch, true);
+            return handle;
+        }
+
+        void cancel(ReservationHandle handle) {
+            const ReservationRecord& record = reservations.get(handle);
+            reservationIndex.erase(record.car, record.startEpoch, record.endEpoch);
+            bumpCarVersion(record.car);
+            publishBooking(reservations.getCar(record.car).getLicensePlate(), record.startEpoch, record.endEpoch, false);
+            reservations.remove(handle);
+        }
+
+        // Publishes the car's entry with one booking added or taken away.
+        void publishBooking(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch, bool booked) {
+            auto it = searchSlots.find(licensePlate);
+            if (it == searchSlots.end()) {
+                return;
+            }
+            auto next = std::make_shared<SearchEntry>(*std::atomic_load(&it->second->entry));
+            auto position = std::lower_bound(next->bookings.begin(), next->bookings.end(), std::make_pair(startEpoch, endEpoch));
+            if (booked) {
+                next->bookings.insert(position, {startEpoch, endEpoch});
+            } else if (position != next->bookings.end() && *position == std::make_pair(startEpoch, endEpoch)) {
+                next->bookings.erase(position);
+            }
+            std::atomic_store(&it->second->entry, std::shared_ptr<const SearchEntry>(std::move(next)));
+        }
+
+        // Registers or replaces a car, carrying over any bookings it already
+        // has, and republishes the view.
+        void publishCar(const Car& car) {
+            auto entry = std::make_shared<SearchEntry>(SearchEntry{car, {}});
+            CarHandle carHandle = reservations.findCar(car.getLicensePlate());
+            if (carHandle != INVALID_HANDLE) {
+                for (ReservationHandle handle : reservationIndex.reservationsOf(carHandle)) {
+                    const ReservationRecord& record = reservations.get(handle);
+                    entry->bookings.emplace_back(record.startEpoch, record.endEpoch);
+                }
+                std::sort(entry->bookings.begin(), entry->bookings.end());
+            }
+            std::shared_ptr<SearchSlot>& slot = searchSlots[car.getLicensePlate()];
+            if (!slot) {
+                slot = std::make_shared<SearchSlot>();
+            }
+            std::atomic_store(&slot->entry, std::shared_ptr<const SearchEntry>(std::move(entry)));
+            publishSearchView();
+        }
+
+        void publishSearchView() {
+            auto view = std::make_shared<SearchView>();
+            for (const auto& [licensePlate, slot] : searchSlots) {
+                const Car& car = std::atomic_load(&slot->entry)->car;
+                (*view)[{car.getMake(), car.getModel()}].push_back(slot);
+            }
+            std::atomic_store(&searchView, std::shared_ptr<const SearchView>(std::move(view)));
+        }
+
+        bool overlaps(const std::string& licensePlate, const std::chrono::system_clock::time_point& startDate,
+                      const std::chrono::system_clock::time_point& endDate) const {
+            CarHandle handle = reservations.findCar(licensePlate);
+            return handle != INVALID_HANDLE &&
+                   reservationIndex.overlaps(handle, ReservationStore::toEpoch(startDate), ReservationStore::toEpoch(endDate));
+        }
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<uint64_t> nextReservationNumber{0};
+
+    size_t shardIndexFor(const std::string& licensePlate) const {
+        return std::hash<std::string>{}(licensePlate) % shards.size();
+    }
+
+    Shard& shardFor(const std::string& licensePlate) const {
+        return *shards[shardIndexFor(licensePlate)];
+    }
+
+    // Reservation numbers encode their shard so cancellation does not need a
+    // global id -> shard map: sequence * shardCount + shardIndex.
+    Shard* shardForReservation(const std::string& reservationId) const {
+        uint64_t reservationNumber = 0;
+        if (!ReservationStore::parseReservationId(reservationId, reservationNumber)) {
+            return nullptr;
+        }
+        return shards[reservationNumber % shards.size()].get();
+    }
+
+    uint64_t generateReservationNumber(const std::string& licensePlate) {
+        size_t shardIndex = shardIndexFor(licensePlate);
+        uint64_t sequence = nextReservationNumber.fetch_add(1, std::memory_order_relaxed);
+        return sequence * shards.size() + shardIndex;
+    }
+
+public:
+    explicit ConcurrentRentalSystem(size_t shardCount = 64) : shards(shardCount ? shardCount : 1) {
+        for (auto& shard : shards) {
+            shard = std::make_unique<Shard>();
+        }
+    }
+
+    // Adding a car is rare and republishes its shard's search view, which
+    // costs time linear in the shard's fleet.
+    void addCar(const Car& car) {
+        Shard& shard = shardFor(car.getLicensePlate());
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.publishCar(car);
+    }
+
+    void removeCar(const std::string& licensePlate) {
+        Shard& shard = shardFor(licensePlate);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (shard.searchSlots.erase(licensePlate)) {
+            shard.publishSearchView();
+        }
+    }
+
+    // Lock-free: reads each shard's published view, so it never waits for
+    // writers nor makes them wait. Each car is seen as of some moment during
+    // the search; a car booked concurrently may or may not be reported.
+    std::vector<Car> searchCars(const std::string& make, const std::string& model,
+                                const std::chrono::system_clock::time_point& startDate,
+                                const std::chrono::system_clock::time_point& endDate) const {
+        int64_t startEpoch = ReservationStore::toEpoch(startDate);
+        int64_t endEpoch = ReservationStore::toEpoch(endDate);
+        std::vector<Car> availableCars;
+        for (const auto& shard : shards) {
+            std::shared_ptr<const SearchView> view = std::atomic_load(&shard->searchView);
+            auto it = view->find({make, model});
+            if (it == view->end()) {
+                continue;
+            }
+            for (const std::shared_ptr<SearchSlot>& slot : it->second) {
+                std::shared_ptr<const SearchEntry> entry = std::atomic_load(&slot->entry);
+                if (entry->car.isAvailable() && !entry->overlaps(startEpoch, endEpoch)) {
+                    availableCars.push_back(entry->car);
+                }
+            }
+        }
+        return availableCars;
+    }
+
+    bool isCarAvailable(const Car& car, const std::chrono::system_clock::time_point& startDate,
+                        const std::chrono::system_clock::time_point& endDate) const {
+        const Shard& shard = shardFor(car.getLicensePlate());
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return !shard.overlaps(car.getLicensePlate(), startDate, endDate);
+    }
+
+    // Returns a copy because the stored reservation may be cancelled by another
+    // thread as soon as the shard lock is released.
+    std::optional<Reservation> makeReservation(const Customer& customer, const Car& car,
+                                               const std::chrono::system_clock::time_point& startDate,
+                                               const std::chrono::system_clock::time_point& endDate) {
+        if (endDate < startDate) {
+            return std::nullopt;
+        }
+        Shard& shard = shardFor(car.getLicensePlate());
+        uint64_t reservationNumber = generateReservationNumber(car.getLicensePlate());
+        int64_t startEpoch = ReservationStore::toEpoch(startDate);
+        int64_t endEpoch = ReservationStore::toEpoch(endDate);
+        double totalPrice = Reservation::calculateTotalPrice(car, startDate, endDate);
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (shard.overlaps(car.getLicensePlate(), startDate, endDate)) {
+            return std::nullopt;
+        }
+        ReservationHandle handle = shard.insert(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+        return shard.reservations.materialize(handle);
+    }
+
+    // Checks every car of a group booking without booking anything, taking
+    // each car's shard lock shared only for its own check, and stamps each
+    // car with its current schedule version.
+    std::optional<GroupReservationPlan> prepareGroupReservation(const Customer& customer, const std::vector<Car>& cars,
+                                                                const std::chrono::system_clock::time_point& startDate,
+                                                                const std::chrono::system_clock::time_point& endDate) const {
+        if (endDate < startDate || cars.empty()) {
+            return std::nullopt;
+        }
+        GroupReservationPlan plan{customer, cars, {}, startDate, endDate};
+        plan.carVersions.reserve(cars.size());
+        std::unordered_set<std::string> licensePlates;
+        for (const Car& car : cars) {
+            if (!licensePlates.insert(car.getLicensePlate()).second) {
+                return std::nullopt;
+            }
+            const Shard& shard = shardFor(car.getLicensePlate());
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (shard.overlaps(car.getLicensePlate(), startDate, endDate)) {
+                return std::nullopt;
+            }
+            plan.carVersions.push_back(shard.carVersion(car.getLicensePlate()));
+        }
+        return plan;
+    }
+
+    // Books every car of the plan, or none if one of them has been taken since
+    // it was prepared. The shards of all the cars are locked exclusively, in
+    // index order so concurrent groups cannot deadlock, and held while the
+    // plan is validated and booked: a car whose version stamp is unchanged
+    // still has the schedule prepare checked, and any other car is checked
+    // again.
+    std::optional<std::vector<Reservation>> commitGroupReservation(const GroupReservationPlan& plan) {
+        std::vector<size_t> shardIndexes;
+        for (const Car& car : plan.cars) {
+            shardIndexes.push_back(shardIndexFor(car.getLicensePlate()));
+        }
+        std::sort(shardIndexes.begin(), shardIndexes.end());
+        shardIndexes.erase(std::unique(shardIndexes.begin(), shardIndexes.end()), shardIndexes.end());
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        locks.reserve(shardIndexes.size());
+        for (size_t shardIndex : shardIndexes) {
+            locks.emplace_back(shards[shardIndex]->mutex);
+        }
+
+        for (size_t i = 0; i < plan.cars.size(); ++i) {
+            const Shard& shard = shardFor(plan.cars[i].getLicensePlate());
+            if (shard.carVersion(plan.cars[i].getLicensePlate()) != plan.carVersions[i] &&
+                shard.overlaps(plan.cars[i].getLicensePlate(), plan.startDate, plan.endDate)) {
+                return std::nullopt;
+            }
+        }
+
+        int64_t startEpoch = ReservationStore::toEpoch(plan.startDate);
+        int64_t endEpoch = ReservationStore::toEpoch(plan.endDate);
+        std::vector<Reservation> booked;
+        booked.reserve(plan.cars.size());
+        for (const Car& car : plan.cars) {
+            Shard& shard = shardFor(car.getLicensePlate());
+            double totalPrice = Reservation::calculateTotalPrice(car, plan.startDate, plan.endDate);
+            ReservationHandle handle = shard.insert(generateReservationNumber(car.getLicensePlate()), car, plan.customer,
+                                                    startEpoch, endEpoch, totalPrice);
+            booked.push_back(shard.reservations.materialize(handle));
+        }
+        return booked;
+    }
+
+    std::optional<std::vector<Reservation>> makeGroupReservation(const Customer& customer, const std::vector<Car>& cars,
+                                                                 const std::chrono::system_clock::time_point& startDate,
+                                                                 const std::chrono::system_clock::time_point& endDate) {
+        std::optional<GroupReservationPlan> plan = prepareGroupReservation(customer, cars, startDate, endDate);
+        if (!plan) {
+            return std::nullopt;
+        }
+        return commitGroupReservation(*plan);
+    }
+
+    bool cancelReservation(const std::string& reservationId) {
+        Shard* shard = shardForReservation(reservationId);
+        if (!shard) {
+            return false;
+        }
+        std::unique_lock<std::shared_mutex> lock(shard->mutex);
+        ReservationHandle handle = shard->reservations.find(reservationId);
+        if (handle == INVALID_HANDLE) {
+            return false;
+        }
+        shard->cancel(handle);
+        return true;
+    }
+
+    std::vector<Reservation> getReservations(const std::string& licensePlate) const {
+        const Shard& shard = shardFor(licensePlate);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        std::vector<Reservation> result;
+        CarHandle carHandle = shard.reservations.findCar(licensePlate);
+        if (carHandle != INVALID_HANDLE) {
+            for (ReservationHandle handle : shard.reservationIndex.reservationsOf(carHandle)) {
+                result.push_back(shard.reservations.materialize(handle));
+            }
+        }
+        return result;
+    }
+};
+
+#endif // CONCURRENTRENTALSYSTEM_H
@@ -0,0 +1,82 @@
+#include "ConcurrentRentalSystem.cpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Hammers one ConcurrentRentalSystem from several threads with overlapping
+// bookings on a small fleet, every eighth of them a three-car group booking,
+// then checks that no car ended up double-booked and that every group was
+// booked whole or not at all. Returns the number of booking attempts per
+// second.
+double runBookingStress(int threadCount, int carCount, int bookingsPerThread, bool& consistent) {
+    ConcurrentRentalSystem rentalSystem;
+    std::vector<Car> fleet;
+    for (int i = 0; i < carCount; ++i) {
+        fleet.emplace_back("Toyota", "Camry", 2022, "CAR" + std::to_string(i), 50.0);
+        rentalSystem.addCar(fleet.back());
+    }
+    Customer customer("Stress Tester", "stress@example.com", "DL0000");
+    auto epoch = std::chrono::system_clock::time_point{};
+    std::atomic<size_t> bookedCount{0};
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> carDist(0, carCount - 1);
+            std::uniform_int_distribution<int> dayDist(0, 365);
+            std::uniform_int_distribution<int> lengthDist(1, 7);
+            for (int i = 0; i < bookingsPerThread; ++i) {
+                auto startDate = epoch + std::chrono::hours(24 * dayDist(rng));
+                auto endDate = startDate + std::chrono::hours(24 * lengthDist(rng));
+                if (i % 8 == 0) {
+                    std::vector<Car> group = {fleet[carDist(rng)], fleet[carDist(rng)], fleet[carDist(rng)]};
+                    auto booked = rentalSystem.makeGroupReservation(customer, group, startDate, endDate);
+                    bookedCount += booked ? booked->size() : 0;
+                } else {
+                    bookedCount += rentalSystem.makeReservation(customer, fleet[carDist(rng)], startDate, endDate) ? 1 : 0;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    consistent = true;
+    size_t storedCount = 0;
+    for (const Car& car : fleet) {
+        auto reservations = rentalSystem.getReservations(car.getLicensePlate());
+        storedCount += reservations.size();
+        std::sort(reservations.begin(), reservations.end(), [](const Reservation& a, const Reservation& b) {
+            return a.getStartDate() < b.getStartDate();
+        });
+        for (size_t i = 1; i < reservations.size(); ++i) {
+            if (reservations[i].getStartDate() < reservations[i - 1].getEndDate()) {
+                consistent = false;
+            }
+        }
+    }
+    consistent = consistent && storedCount == bookedCount;
+    return threadCount * bookingsPerThread / seconds;
+}
+
+int main() {
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int threads = 1; threads <= cores; threads *= 2) {
+        bool consistent = false;
+        double throughput = runBookingStress(threads, 2000, 50000, consistent);
+        std::cout << threads << " thread(s): " << static_cast<long long>(throughput) << " booking attempts/s, "
+                  << (consistent ? "no double bookings" : "DOUBLE BOOKING DETECTED") << "\n";
+        if (!consistent) {
+            return 1;
+        }
+    }
+    return 0;
+}
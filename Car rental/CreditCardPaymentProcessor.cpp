@@ -8,7 +8,7 @@ public:
     bool processPayment(double amount) override {
         // Process credit card payment
         // ...
-        std::cout << "Processing credit card payment of amount: " << amount << std::endl;
+        std::cout << "Processing credit card payment of amount: " << amount << '\n';
         return true;
     }
 };
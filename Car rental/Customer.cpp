@@ -10,6 +10,8 @@ private:
     std::string driversLicenseNumber;
 
 public:
+    Customer() : name(""), contactInfo(""), driversLicenseNumber("") {}
+
     Customer(std::string name, std::string contactInfo, std::string driversLicenseNumber)
         : name(name), contactInfo(contactInfo), driversLicenseNumber(driversLicenseNumber) {}
 
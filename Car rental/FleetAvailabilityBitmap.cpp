@@ -0,0 +1,213 @@
+#ifndef FLEETAVAILABILITYBITMAP_H
+#define FLEETAVAILABILITYBITMAP_H
+
+#include "Car.cpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// One bit per car per day over a fixed horizon, grouped by (make, model). A
+// set bit means some booking covers part of that day. Within a group the bits
+// are stored word-major (all cars' word 0, then all cars' word 1, ...), so a
+// range query is a straight OR over contiguous uint64_t columns that the
+// compiler vectorizes, instead of one interval lookup per car.
+//
+// An empty booking at midnight covers no part of any day, yet the interval
+// search still counts it against windows that strictly contain it, so it
+// blocks a range of days only if the range includes the days on both sides.
+// Bits cannot say that; such bookings are kept per car as a list of boundary
+// days and checked separately for the few cars that have any.
+class FleetAvailabilityBitmap {
+private:
+    struct ModelGroup {
+        std::vector<const Car*> cars;
+        std::vector<uint64_t> busy;
+        size_t capacity = 0;
+        // Day d here means an empty booking at the midnight starting day d.
+        std::unordered_map<const Car*, std::multiset<int64_t>> boundaryDays;
+    };
+
+    int64_t horizonStartDay;
+    size_t wordCount;
+    std::map<std::pair<std::string, std::string>, ModelGroup> groups;
+    std::unordered_map<std::string, std::pair<ModelGroup*, size_t>> slotByPlate;
+
+    void grow(ModelGroup& group) {
+        size_t capacity = std::max<size_t>(16, group.capacity * 2);
+        std::vector<uint64_t> busy(wordCount * capacity, 0);
+        for (size_t word = 0; word < wordCount; ++word) {
+            std::copy_n(group.busy.begin() + word * group.capacity, group.cars.size(), busy.begin() + word * capacity);
+        }
+        group.busy.swap(busy);
+        group.capacity = capacity;
+    }
+
+    // Clips [firstDay, endDay) to the horizon and calls apply(word, mask) for
+    // each 64-day word it touches.
+    template <typename Apply>
+    void forEachWord(int64_t firstDay, int64_t endDay, Apply apply) const {
+        int64_t first = std::max<int64_t>(firstDay - horizonStartDay, 0);
+        int64_t end = std::min<int64_t>(endDay - horizonStartDay, getHorizonDays());
+        for (int64_t day = first; day < end;) {
+            size_t word = static_cast<size_t>(day / 64);
+            int64_t wordEnd = std::min<int64_t>(end, static_cast<int64_t>(word + 1) * 64);
+            unsigned int low = static_cast<unsigned int>(day % 64);
+            unsigned int count = static_cast<unsigned int>(wordEnd - day);
+            uint64_t mask = count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << low;
+            apply(word, mask);
+            day = wordEnd;
+        }
+    }
+
+    void setBits(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch, bool busy) {
+        auto it = slotByPlate.find(licensePlate);
+        if (it == slotByPlate.end()) {
+            return;
+        }
+        ModelGroup& group = *it->second.first;
+        size_t slot = it->second.second;
+        int64_t firstDay = floorDay(startEpoch);
+        if (isMidnightInstant(startEpoch, endEpoch)) {
+            std::multiset<int64_t>& days = group.boundaryDays[group.cars[slot]];
+            if (busy) {
+                days.insert(firstDay);
+            } else if (days.count(firstDay)) {
+                days.erase(days.find(firstDay));
+            }
+            if (days.empty()) {
+                group.boundaryDays.erase(group.cars[slot]);
+            }
+            return;
+        }
+        int64_t endDay = std::max(ceilDay(endEpoch), firstDay + 1);
+        forEachWord(firstDay, endDay, [&](size_t word, uint64_t mask) {
+            uint64_t& bits = group.busy[word * group.capacity + slot];
+            bits = busy ? (bits | mask) : (bits & ~mask);
+        });
+    }
+
+    // True if an empty midnight booking of car falls strictly inside
+    // [firstDay, endDay), i.e. between two days of the range.
+    static bool hasBoundaryDayWithin(const ModelGroup& group, const Car* car, int64_t firstDay, int64_t endDay) {
+        if (group.boundaryDays.empty()) {
+            return false;
+        }
+        auto it = group.boundaryDays.find(car);
+        if (it == group.boundaryDays.end()) {
+            return false;
+        }
+        auto day = it->second.upper_bound(firstDay);
+        return day != it->second.end() && *day < endDay;
+    }
+
+public:
+    static int64_t ticksPerDay() {
+        return std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(24)).count();
+    }
+
+    static int64_t floorDay(int64_t epoch) {
+        int64_t day = epoch / ticksPerDay();
+        return (epoch % ticksPerDay() < 0) ? day - 1 : day;
+    }
+
+    static int64_t ceilDay(int64_t epoch) {
+        int64_t day = floorDay(epoch);
+        return day * ticksPerDay() == epoch ? day : day + 1;
+    }
+
+    // An empty booking exactly at midnight; it sets no day bits.
+    static bool isMidnightInstant(int64_t startEpoch, int64_t endEpoch) {
+        return startEpoch == endEpoch && floorDay(startEpoch) * ticksPerDay() == startEpoch;
+    }
+
+    FleetAvailabilityBitmap(int64_t horizonStartDay, size_t horizonDays)
+        : horizonStartDay(horizonStartDay), wordCount((horizonDays + 63) / 64) {}
+
+    int64_t getHorizonStartDay() const { return horizonStartDay; }
+    int64_t getHorizonDays() const { return static_cast<int64_t>(wordCount * 64); }
+
+    bool covers(int64_t firstDay, int64_t endDay) const {
+        return firstDay >= horizonStartDay && endDay <= horizonStartDay + getHorizonDays();
+    }
+
+    void addCar(const Car* car) {
+        ModelGroup& group = groups[{car->getMake(), car->getModel()}];
+        if (group.cars.size() == group.capacity) {
+            grow(group);
+        }
+        size_t slot = group.cars.size();
+        group.cars.push_back(car);
+        for (size_t word = 0; word < wordCount; ++word) {
+            group.busy[word * group.capacity + slot] = 0;
+        }
+        slotByPlate[car->getLicensePlate()] = {&group, slot};
+    }
+
+    void removeCar(const std::string& licensePlate) {
+        auto it = slotByPlate.find(licensePlate);
+        if (it == slotByPlate.end()) {
+            return;
+        }
+        ModelGroup& group = *it->second.first;
+        size_t slot = it->second.second;
+        group.boundaryDays.erase(group.cars[slot]);
+        size_t last = group.cars.size() - 1;
+        if (slot != last) {
+            group.cars[slot] = group.cars[last];
+            for (size_t word = 0; word < wordCount; ++word) {
+                group.busy[word * group.capacity + slot] = group.busy[word * group.capacity + last];
+            }
+            slotByPlate[group.cars[slot]->getLicensePlate()].second = slot;
+        }
+        group.cars.pop_back();
+        slotByPlate.erase(it);
+    }
+
+    // Marks every day that [startEpoch, endEpoch) touches. An empty booking
+    // exactly at midnight is recorded as a boundary day instead, and must
+    // not be marked twice.
+    void markBusy(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch) {
+        setBits(licensePlate, startEpoch, endEpoch, true);
+    }
+
+    // Clears the days of a cancelled booking. Other bookings of the same car
+    // that share its first or last day have to be marked again by the caller.
+    void clearBusy(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch) {
+        setBits(licensePlate, startEpoch, endEpoch, false);
+    }
+
+    // Cars of the model with no booked day in [firstDay, endDay). The range
+    // must lie inside the horizon (see covers()).
+    std::vector<const Car*> findFree(const std::string& make, const std::string& model,
+                                     int64_t firstDay, int64_t endDay) const {
+        std::vector<const Car*> result;
+        auto groupIt = groups.find({make, model});
+        if (groupIt == groups.end()) {
+            return result;
+        }
+        const ModelGroup& group = groupIt->second;
+        size_t carCount = group.cars.size();
+        std::vector<uint64_t> booked(carCount, 0);
+        forEachWord(firstDay, endDay, [&](size_t word, uint64_t mask) {
+            const uint64_t* column = group.busy.data() + word * group.capacity;
+            uint64_t* accumulator = booked.data();
+            for (size_t slot = 0; slot < carCount; ++slot) {
+                accumulator[slot] |= column[slot] & mask;
+            }
+        });
+        for (size_t slot = 0; slot < carCount; ++slot) {
+            if (booked[slot] == 0 && !hasBoundaryDayWithin(group, group.cars[slot], firstDay, endDay)) {
+                result.push_back(group.cars[slot]);
+            }
+        }
+        return result;
+    }
+};
+
+#endif // FLEETAVAILABILITYBITMAP_H
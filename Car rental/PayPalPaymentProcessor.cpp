@@ -8,7 +8,7 @@ public:
     bool processPayment(double amount) override {
         // Process PayPal payment
         // ...
-        std::cout << "Processing PayPal payment of amount: " << amount << std::endl;
+        std::cout << "Processing PayPal payment of amount: " << amount << '\n';
         return true;
     }
 };
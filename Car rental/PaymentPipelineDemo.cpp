@@ -0,0 +1,43 @@
+#include "AsyncPaymentPipeline.cpp"
+#include "StubPaymentProcessor.cpp"
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <vector>
+
+// Compares charging one payment at a time against the batched pipeline, both
+// against a stub gateway with a fixed round-trip time and a small decline rate.
+int main() {
+    const int paymentCount = 2000;
+    const auto gatewayLatency = std::chrono::milliseconds(2);
+
+    StubPaymentProcessor syncGateway(gatewayLatency, 0.01);
+    auto begin = std::chrono::steady_clock::now();
+    int syncApproved = 0;
+    for (int i = 0; i < paymentCount / 10; ++i) {
+        syncApproved += syncGateway.processPayment(50.0);
+    }
+    double syncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Synchronous: " << static_cast<long long>(paymentCount / 10 / syncSeconds) << " payments/s ("
+              << syncApproved << " approved of " << paymentCount / 10 << ")\n";
+
+    StubPaymentProcessor batchedGateway(gatewayLatency, 0.01);
+    begin = std::chrono::steady_clock::now();
+    int asyncApproved = 0;
+    {
+        AsyncPaymentPipeline pipeline(batchedGateway, 4, 64);
+        std::vector<std::future<bool>> results;
+        results.reserve(paymentCount);
+        for (int i = 0; i < paymentCount; ++i) {
+            results.push_back(pipeline.submit(50.0));
+        }
+        for (auto& result : results) {
+            asyncApproved += result.get();
+        }
+    }
+    double asyncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Pipelined:   " << static_cast<long long>(paymentCount / asyncSeconds) << " payments/s ("
+              << asyncApproved << " approved of " << paymentCount << ", "
+              << batchedGateway.getGatewayCalls() << " gateway calls)\n";
+    return 0;
+}
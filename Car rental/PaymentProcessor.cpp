@@ -6,6 +6,17 @@ class PaymentProcessor {
 public:
     virtual ~PaymentProcessor() = default; // Virtual destructor
     virtual bool processPayment(double amount) = 0; // Pure virtual function
+
+    // Charges several amounts in one provider call. Gateways that support
+    // batching override this; the default charges them one at a time.
+    virtual std::vector<bool> processPayments(const std::vector<double>& amounts) {
+        std::vector<bool> results;
+        results.reserve(amounts.size());
+        for (double amount : amounts) {
+            results.push_back(processPayment(amount));
+        }
+        return results;
+    }
 };
 
 #endif // PAYMENTPROCESSOR_H
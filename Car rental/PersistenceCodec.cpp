@@ -0,0 +1,45 @@
+#ifndef PERSISTENCECODEC_H
+#define PERSISTENCECODEC_H
+
+#include "Car.cpp"
+#include "Customer.cpp"
+#include "../Common/BinaryCodec.cpp"
+#include <cstdint>
+#include <string>
+
+// Layout of cars and customers in the WAL and the snapshots.
+inline void writeCar(BinaryWriter& writer, const Car& car) {
+    writer.writeString(car.getMake());
+    writer.writeString(car.getModel());
+    writer.write(static_cast<int32_t>(car.getYear()));
+    writer.writeString(car.getLicensePlate());
+    writer.write(car.getRentalPricePerDay());
+    writer.write(static_cast<uint8_t>(car.isAvailable()));
+}
+
+inline void writeCustomer(BinaryWriter& writer, const Customer& customer) {
+    writer.writeString(customer.getName());
+    writer.writeString(customer.getContactInfo());
+    writer.writeString(customer.getDriversLicenseNumber());
+}
+
+inline Car readCar(BinaryReader& reader) {
+    std::string make = reader.readString();
+    std::string model = reader.readString();
+    int year = reader.read<int32_t>();
+    std::string licensePlate = reader.readString();
+    double rentalPricePerDay = reader.read<double>();
+    bool available = reader.read<uint8_t>() != 0;
+    Car car(make, model, year, licensePlate, rentalPricePerDay);
+    car.setAvailable(available);
+    return car;
+}
+
+inline Customer readCustomer(BinaryReader& reader) {
+    std::string name = reader.readString();
+    std::string contactInfo = reader.readString();
+    std::string driversLicenseNumber = reader.readString();
+    return Customer(name, contactInfo, driversLicenseNumber);
+}
+
+#endif // PERSISTENCECODEC_H
@@ -6,101 +6,673 @@
 #include "Reservation.cpp"
 #include "CreditCardPaymentProcessor.cpp"
 #include "PaymentProcessor.cpp"
+#include "AsyncPaymentPipeline.cpp"
+#include "ReservationStore.cpp"
+#include "ReservationIndex.cpp"
+#include "ReservationColumns.cpp"
+#include "ReservationAnalytics.cpp"
+#include "CarIndex.cpp"
+#include "FleetAvailabilityBitmap.cpp"
+#include "PersistenceCodec.cpp"
+#include "WriteAheadLog.cpp"
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <future>
+#include <optional>
 #include <vector>
 #include <string>
+#include <tuple>
 #include <chrono>
 #include <random>
 #include <ctime>
 #include <iostream>
 
+// A car of the requested model and the earliest window it is free for.
+struct AvailableSlot {
+    Car car;
+    std::chrono::system_clock::time_point startDate;
+    std::chrono::system_clock::time_point endDate;
+};
+
 class RentalSystem {
 private:
-    static RentalSystem* instance;
     std::unordered_map<std::string, Car> cars;
-    std::unordered_map<std::string, Reservation> reservations;
+    ReservationStore reservations;
+    ReservationIndex reservationIndex;
+    ReservationColumns reservationColumns;
+    CarIndex carIndex;
+    std::unique_ptr<FleetAvailabilityBitmap> availabilityBitmap;
     PaymentProcessor* paymentProcessor;
+    std::unique_ptr<AsyncPaymentPipeline> paymentPipeline;
+    std::unique_ptr<WriteAheadLog> wal;
+    std::string snapshotPath;
+    size_t snapshotEveryRecords = 0;
+    size_t recordsSinceSnapshot = 0;
+    // Declared after wal so it is destroyed, and so waited for, first.
+    std::future<bool> backgroundCheckpoint;
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x31534352; // "RCS1"
 
     RentalSystem() : paymentProcessor(new CreditCardPaymentProcessor()) {}
 
 public:
     static RentalSystem* getInstance() {
-        if (!instance) {
-            instance = new RentalSystem();
-        }
-        return instance;
+        static RentalSystem instance;
+        return &instance;
     }
 
     void addCar(const Car& car) {
-        cars[car.getLicensePlate()] = car;
+        storeCar(car);
+        if (wal) {
+            std::vector<char> payload;
+            BinaryWriter writer(payload);
+            writeCar(writer, car);
+            logMutation(WalRecordType::ADD_CAR, payload);
+        }
     }
 
     void removeCar(const std::string& licensePlate) {
-        cars.erase(licensePlate);
+        if (eraseCar(licensePlate) && wal) {
+            std::vector<char> payload;
+            BinaryWriter(payload).writeString(licensePlate);
+            logMutation(WalRecordType::REMOVE_CAR, payload);
+        }
     }
 
     std::vector<Car> searchCars(const std::string& make, const std::string& model,
                                 const std::chrono::system_clock::time_point& startDate,
                                 const std::chrono::system_clock::time_point& endDate) {
-        std::vector<Car> availableCars;
-        for (const auto& [licensePlate, car] : cars) {
-            if (car.getMake() == make && car.getModel() == model && car.isAvailable()) {
-                if (isCarAvailable(car, startDate, endDate)) {
-                    availableCars.push_back(car);
+        return filterAvailable(carIndex.findByMakeModel(make, model), startDate, endDate);
+    }
+
+    std::vector<Car> searchCarsByYear(int minYear, int maxYear,
+                                      const std::chrono::system_clock::time_point& startDate,
+                                      const std::chrono::system_clock::time_point& endDate) {
+        return filterAvailable(carIndex.findByYear(minYear, maxYear), startDate, endDate);
+    }
+
+    std::vector<Car> searchCarsByPrice(double minPricePerDay, double maxPricePerDay,
+                                       const std::chrono::system_clock::time_point& startDate,
+                                       const std::chrono::system_clock::time_point& endDate) {
+        return filterAvailable(carIndex.findByPrice(minPricePerDay, maxPricePerDay), startDate, endDate);
+    }
+
+    // Answers many searches at once. Queries for the same make and model share
+    // a single walk over that model's cars; results are returned in query order.
+    std::vector<std::vector<Car>> searchCarsBatch(const std::vector<CarSearchQuery>& queries) {
+        std::vector<std::vector<Car>> results(queries.size());
+        std::map<std::pair<std::string, std::string>, std::vector<size_t>> queriesByMakeModel;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            queriesByMakeModel[{queries[i].make, queries[i].model}].push_back(i);
+        }
+        for (const auto& [makeModel, queryIds] : queriesByMakeModel) {
+            for (const Car* car : carIndex.findByMakeModel(makeModel.first, makeModel.second)) {
+                if (!car->isAvailable()) {
+                    continue;
                 }
+                for (size_t i : queryIds) {
+                    if (isCarAvailable(*car, queries[i].startDate, queries[i].endDate)) {
+                        results[i].push_back(*car);
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+    // Builds per-model day bitmaps for horizonDays starting at startDate's day.
+    // Call it again (e.g. nightly) to roll the horizon forward.
+    void enableAvailabilityBitmaps(const std::chrono::system_clock::time_point& startDate, size_t horizonDays = 365) {
+        int64_t startDay = FleetAvailabilityBitmap::floorDay(ReservationStore::toEpoch(startDate));
+        availabilityBitmap = std::make_unique<FleetAvailabilityBitmap>(startDay, horizonDays);
+        for (const auto& [licensePlate, car] : cars) {
+            availabilityBitmap->addCar(&car);
+        }
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            if (record.car != INVALID_HANDLE) {
+                availabilityBitmap->markBusy(reservations.getCar(record.car).getLicensePlate(),
+                                             record.startEpoch, record.endEpoch);
+            }
+        }
+    }
+
+    // Whole-day variant of searchCars: [startDate, endDate) is widened to the
+    // days it touches and answered from the bitmaps, so a car is returned only
+    // if it has no booking on any of those days. Falls back to searchCars when
+    // bitmaps are off or the days leave the horizon.
+    std::vector<Car> searchCarsForDays(const std::string& make, const std::string& model,
+                                       const std::chrono::system_clock::time_point& startDate,
+                                       const std::chrono::system_clock::time_point& endDate) {
+        int64_t firstDay = FleetAvailabilityBitmap::floorDay(ReservationStore::toEpoch(startDate));
+        int64_t endDay = std::max(FleetAvailabilityBitmap::ceilDay(ReservationStore::toEpoch(endDate)), firstDay + 1);
+        if (!availabilityBitmap || !availabilityBitmap->covers(firstDay, endDay)) {
+            int64_t ticksPerDay = FleetAvailabilityBitmap::ticksPerDay();
+            return searchCars(make, model, ReservationStore::fromEpoch(firstDay * ticksPerDay),
+                              ReservationStore::fromEpoch(endDay * ticksPerDay));
+        }
+        std::vector<Car> availableCars;
+        for (const Car* car : availabilityBitmap->findFree(make, model, firstDay, endDay)) {
+            if (car->isAvailable()) {
+                availableCars.push_back(*car);
             }
         }
         return availableCars;
     }
 
-    bool isCarAvailable(const Car& car, const std::chrono::system_clock::time_point& startDate,
-                        const std::chrono::system_clock::time_point& endDate) {
-        for (const auto& [reservationId, reservation] : reservations) {
-            if (reservation.getCar().getLicensePlate() == car.getLicensePlate()) {
-                auto resStart = reservation.getStartDate();
-                auto resEnd = reservation.getEndDate();
-                if (startDate < resEnd && endDate > resStart) {
-                    return false;
-                }
+    // The k earliest windows of the given length, starting no sooner than
+    // notBefore, on distinct cars of the model. Each car's earliest window
+    // comes from the free-gap index of its bookings rather than from repeated
+    // searches with shifted dates. Ordered by start date, then license plate.
+    std::vector<AvailableSlot> findEarliestAvailableSlots(const std::string& make, const std::string& model,
+                                                          const std::chrono::system_clock::time_point& notBefore,
+                                                          std::chrono::system_clock::duration length, size_t k) {
+        int64_t notBeforeEpoch = ReservationStore::toEpoch(notBefore);
+        std::vector<std::pair<int64_t, const Car*>> candidates;
+        for (const Car* car : carIndex.findByMakeModel(make, model)) {
+            if (!car->isAvailable()) {
+                continue;
             }
+            CarHandle handle = reservations.findCar(car->getLicensePlate());
+            int64_t startEpoch = handle == INVALID_HANDLE
+                ? notBeforeEpoch
+                : reservationIndex.earliestFreeStart(handle, notBeforeEpoch, length.count());
+            candidates.emplace_back(startEpoch, car);
         }
-        return true;
+        auto earlier = [](const std::pair<int64_t, const Car*>& a, const std::pair<int64_t, const Car*>& b) {
+            if (a.first != b.first) return a.first < b.first;
+            return a.second->getLicensePlate() < b.second->getLicensePlate();
+        };
+        size_t count = std::min(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), earlier);
+
+        std::vector<AvailableSlot> slots;
+        for (size_t i = 0; i < count; ++i) {
+            auto startDate = ReservationStore::fromEpoch(candidates[i].first);
+            slots.push_back(AvailableSlot{*candidates[i].second, startDate, startDate + length});
+        }
+        return slots;
+    }
+
+    bool isCarAvailable(const Car& car, const std::chrono::system_clock::time_point& startDate,
+                        const std::chrono::system_clock::time_point& endDate) {
+        CarHandle handle = reservations.findCar(car.getLicensePlate());
+        return handle == INVALID_HANDLE ||
+               !reservationIndex.overlaps(handle, ReservationStore::toEpoch(startDate), ReservationStore::toEpoch(endDate));
     }
 
-    Reservation* makeReservation(const Customer& customer, const Car& car,
-                                 const std::chrono::system_clock::time_point& startDate,
-                                 const std::chrono::system_clock::time_point& endDate) {
+    // With persistence on, the booking is logged but not yet durable when
+    // this returns: the WAL group-commits it within a few milliseconds, and a
+    // crash before that loses it. Call syncPersistence() before confirming
+    // bookings to anyone who must not lose them.
+    std::optional<Reservation> makeReservation(const Customer& customer, const Car& car,
+                                               const std::chrono::system_clock::time_point& startDate,
+                                               const std::chrono::system_clock::time_point& endDate) {
+        if (endDate < startDate) {
+            return std::nullopt;
+        }
         if (isCarAvailable(car, startDate, endDate)) {
-            std::string reservationId = generateReservationId();
-            Reservation reservation(reservationId, customer, car, startDate, endDate);
-            reservations[reservationId] = reservation;
+            uint64_t reservationNumber = generateReservationNumber();
+            while (reservations.contains(reservationNumber)) {
+                reservationNumber = generateReservationNumber();
+            }
+            int64_t startEpoch = ReservationStore::toEpoch(startDate);
+            int64_t endEpoch = ReservationStore::toEpoch(endDate);
+            double totalPrice = Reservation::calculateTotalPrice(car, startDate, endDate);
+            ReservationHandle handle = insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+            if (wal) {
+                std::vector<char> payload;
+                BinaryWriter writer(payload);
+                writer.write(reservationNumber);
+                writeCar(writer, car);
+                writeCustomer(writer, customer);
+                writer.write(startEpoch);
+                writer.write(endEpoch);
+                writer.write(totalPrice);
+                logMutation(WalRecordType::MAKE_RESERVATION, payload);
+            }
             const_cast<Car&>(car).setAvailable(false); // We need to cast away const for setting availability
-            return &reservations[reservationId];
+            return reservations.materialize(handle);
         }
-        return nullptr;
+        return std::nullopt;
+    }
+
+    // Books every car for the same dates, or none if any of them is taken or
+    // listed twice. The group is logged as one record, so recovery also
+    // restores all of it or none of it; like makeReservation it returns
+    // before that record is durable. RentalSystem is single-threaded, so
+    // checking and booking in one call is already atomic; concurrent callers
+    // should use ConcurrentRentalSystem's group reservations.
+    std::optional<std::vector<Reservation>> makeGroupReservation(const Customer& customer, const std::vector<Car>& cars,
+                                                                 const std::chrono::system_clock::time_point& startDate,
+                                                                 const std::chrono::system_clock::time_point& endDate) {
+        if (endDate < startDate || cars.empty()) {
+            return std::nullopt;
+        }
+        std::unordered_set<std::string> licensePlates;
+        for (const Car& car : cars) {
+            if (!licensePlates.insert(car.getLicensePlate()).second || !isCarAvailable(car, startDate, endDate)) {
+                return std::nullopt;
+            }
+        }
+
+        int64_t startEpoch = ReservationStore::toEpoch(startDate);
+        int64_t endEpoch = ReservationStore::toEpoch(endDate);
+        std::vector<char> payload;
+        BinaryWriter writer(payload);
+        if (wal) {
+            writer.write(startEpoch);
+            writer.write(endEpoch);
+            writeCustomer(writer, customer);
+            writer.write(static_cast<uint32_t>(cars.size()));
+        }
+        std::vector<ReservationHandle> handles;
+        handles.reserve(cars.size());
+        for (const Car& car : cars) {
+            uint64_t reservationNumber = generateReservationNumber();
+            while (reservations.contains(reservationNumber)) {
+                reservationNumber = generateReservationNumber();
+            }
+            double totalPrice = Reservation::calculateTotalPrice(car, startDate, endDate);
+            handles.push_back(insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice));
+            if (wal) {
+                writer.write(reservationNumber);
+                writeCar(writer, car);
+                writer.write(totalPrice);
+            }
+        }
+        if (wal) {
+            logMutation(WalRecordType::GROUP_RESERVATION, payload);
+        }
+
+        std::vector<Reservation> booked;
+        booked.reserve(handles.size());
+        for (ReservationHandle handle : handles) {
+            booked.push_back(reservations.materialize(handle));
+        }
+        return booked;
     }
 
     void cancelReservation(const std::string& reservationId) {
-        auto it = reservations.find(reservationId);
-        if (it != reservations.end()) {
-            Reservation& reservation = it->second;
-            reservation.getCar().setAvailable(true);
-            reservations.erase(it);
+        ReservationHandle handle = reservations.find(reservationId);
+        if (handle != INVALID_HANDLE) {
+            uint64_t reservationNumber = reservations.get(handle).reservationNumber;
+            eraseReservation(handle);
+            if (wal) {
+                std::vector<char> payload;
+                BinaryWriter(payload).write(reservationNumber);
+                logMutation(WalRecordType::CANCEL_RESERVATION, payload);
+            }
         }
     }
 
+    // Copy of the columnar reservation data. Run ReservationAnalytics on it
+    // from another thread and bookings here carry on while the report runs.
+    std::shared_ptr<const ReservationColumns> snapshotReservationColumns() const {
+        return std::make_shared<const ReservationColumns>(reservationColumns);
+    }
+
+    std::vector<DailyRevenue> getRevenueByMakePerDay() const {
+        return ReservationAnalytics::revenueByMakePerDay(reservationColumns);
+    }
+
+    // Share of [startDate, endDate) each fleet car is booked for.
+    std::unordered_map<std::string, double> getUtilizationPerCar(const std::chrono::system_clock::time_point& startDate,
+                                                                 const std::chrono::system_clock::time_point& endDate) const {
+        std::vector<double> utilizationByHandle = ReservationAnalytics::utilizationPerCar(
+            reservationColumns, reservations.getRegisteredCars().size(),
+            ReservationStore::toEpoch(startDate), ReservationStore::toEpoch(endDate));
+        std::unordered_map<std::string, double> utilization;
+        for (const auto& [licensePlate, car] : cars) {
+            CarHandle handle = reservations.findCar(licensePlate);
+            utilization[licensePlate] = handle == INVALID_HANDLE ? 0 : utilizationByHandle[handle];
+        }
+        return utilization;
+    }
+
+    std::chrono::system_clock::duration getAverageRentalLength() const {
+        return std::chrono::system_clock::duration(
+            static_cast<std::chrono::system_clock::rep>(ReservationAnalytics::averageRentalLength(reservationColumns)));
+    }
+
     bool processPayment(const Reservation& reservation) {
         return paymentProcessor->processPayment(reservation.getTotalPrice());
     }
 
+    // Queues the charge and returns at once; the caller only waits on the
+    // gateway if it calls get() on the returned future.
+    std::future<bool> processPaymentAsync(const Reservation& reservation) {
+        if (!paymentPipeline) {
+            paymentPipeline = std::make_unique<AsyncPaymentPipeline>(*paymentProcessor);
+        }
+        return paymentPipeline->submit(reservation.getTotalPrice());
+    }
+
+    // Restores the fleet and bookings from the latest snapshot in `directory`
+    // plus the WAL records written after it, then logs every later mutation.
+    // Call once, before the system is used. A new snapshot is taken after
+    // every snapshotEveryRecords logged mutations (0 disables that); only its
+    // serialization runs on the mutating thread, the write in the background.
+    // Mutations become durable shortly after they return, not before; see
+    // syncPersistence().
+    bool enablePersistence(const std::string& directory, size_t snapshotEveryRecords = 1000000) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        snapshotPath = directory + "/rental.snapshot";
+        std::string walPath = directory + "/rental.wal";
+
+        uint64_t lastLsn = 0;
+        if (!loadSnapshot(lastLsn)) {
+            return false;
+        }
+        size_t validBytes = WriteAheadLog::replay(walPath, [&](uint64_t lsn, WalRecordType type, BinaryReader& payload) {
+            if (lsn > lastLsn) {
+                applyLogRecord(type, payload);
+                lastLsn = lsn;
+            }
+        });
+
+        this->snapshotEveryRecords = snapshotEveryRecords;
+        wal = std::make_unique<WriteAheadLog>();
+        return wal->open(walPath, validBytes, lastLsn + 1);
+    }
+
+    // Blocks until every mutation logged so far is on disk.
+    bool syncPersistence() {
+        return wal && wal->waitDurable(wal->sync());
+    }
+
+    // Writes a snapshot covering everything logged so far and empties the WAL,
+    // so the next recovery only replays what is written after this point.
+    // Blocks until done, including any automatic checkpoint still running.
+    bool checkpoint() {
+        if (!wal) {
+            return false;
+        }
+        if (backgroundCheckpoint.valid()) {
+            backgroundCheckpoint.get();
+        }
+        recordsSinceSnapshot = 0;
+        uint64_t lastLsn = wal->sync();
+        return writeSnapshot(serializeSnapshot(lastLsn)) && wal->truncateThrough(lastLsn);
+    }
+
 private:
-    std::string generateReservationId() {
+    void storeCar(const Car& car) {
+        auto it = cars.find(car.getLicensePlate());
+        if (it != cars.end()) {
+            carIndex.remove(&it->second);
+            it->second = car;
+        } else {
+            it = cars.emplace(car.getLicensePlate(), car).first;
+        }
+        carIndex.add(&it->second);
+        if (availabilityBitmap) {
+            availabilityBitmap->removeCar(car.getLicensePlate());
+            availabilityBitmap->addCar(&it->second);
+            CarHandle carHandle = reservations.findCar(car.getLicensePlate());
+            if (carHandle != INVALID_HANDLE) {
+                for (ReservationHandle handle : reservationIndex.reservationsOf(carHandle)) {
+                    const ReservationRecord& record = reservations.get(handle);
+                    availabilityBitmap->markBusy(car.getLicensePlate(), record.startEpoch, record.endEpoch);
+                }
+            }
+        }
+    }
+
+    bool eraseCar(const std::string& licensePlate) {
+        auto it = cars.find(licensePlate);
+        if (it == cars.end()) {
+            return false;
+        }
+        carIndex.remove(&it->second);
+        if (availabilityBitmap) {
+            availabilityBitmap->removeCar(licensePlate);
+        }
+        cars.erase(it);
+        return true;
+    }
+
+    ReservationHandle insertReservation(uint64_t reservationNumber, const Car& car, const Customer& customer,
+                                        int64_t startEpoch, int64_t endEpoch, double totalPrice) {
+        CarHandle carHandle = reservations.internCar(car);
+        ReservationHandle handle = reservations.add(reservationNumber, carHandle, reservations.internCustomer(customer),
+                                                    startEpoch, endEpoch, totalPrice);
+        reservationIndex.insert(carHandle, startEpoch, endEpoch, handle);
+        reservationColumns.add(handle, reservations.get(handle), car.getMake());
+        if (availabilityBitmap) {
+            availabilityBitmap->markBusy(car.getLicensePlate(), startEpoch, endEpoch);
+        }
+        return handle;
+    }
+
+    void eraseReservation(ReservationHandle handle) {
+        const ReservationRecord& record = reservations.get(handle);
+        reservationIndex.erase(record.car, record.startEpoch, record.endEpoch);
+        reservationColumns.remove(handle);
+        if (availabilityBitmap) {
+            // Clearing the booking's days may also clear days it shared with
+            // neighbouring bookings of the same car, so re-mark those.
+            const std::string& licensePlate = reservations.getCar(record.car).getLicensePlate();
+            int64_t ticksPerDay = FleetAvailabilityBitmap::ticksPerDay();
+            availabilityBitmap->clearBusy(licensePlate, record.startEpoch, record.endEpoch);
+            reservationIndex.forEachTouching(record.car,
+                                             (FleetAvailabilityBitmap::floorDay(record.startEpoch) - 1) * ticksPerDay,
+                                             (FleetAvailabilityBitmap::ceilDay(record.endEpoch) + 1) * ticksPerDay,
+                                             [&](int64_t startEpoch, int64_t endEpoch, ReservationHandle) {
+                // Midnight instants own no day bits, so clearing cannot lose them.
+                if (!FleetAvailabilityBitmap::isMidnightInstant(startEpoch, endEpoch)) {
+                    availabilityBitmap->markBusy(licensePlate, startEpoch, endEpoch);
+                }
+            });
+        }
+        reservations.remove(handle);
+    }
+
+    void logMutation(WalRecordType type, const std::vector<char>& payload) {
+        uint64_t lsn = wal->append(type, payload);
+        if (snapshotEveryRecords && ++recordsSinceSnapshot >= snapshotEveryRecords) {
+            startBackgroundCheckpoint(lsn);
+        }
+    }
+
+    // Serializes the state here, where nothing can change it underneath, and
+    // leaves the file write, fsync and WAL truncation to a background task,
+    // so bookings only pay for an in-memory copy. If the previous checkpoint
+    // is still being written, this one waits for a later mutation.
+    void startBackgroundCheckpoint(uint64_t lastLsn) {
+        if (backgroundCheckpoint.valid()) {
+            if (backgroundCheckpoint.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            backgroundCheckpoint.get();
+        }
+        recordsSinceSnapshot = 0;
+        backgroundCheckpoint = std::async(std::launch::async, [this, snapshot = serializeSnapshot(lastLsn), lastLsn]() {
+            return writeSnapshot(snapshot) && wal->truncateThrough(lastLsn);
+        });
+    }
+
+    void applyLogRecord(WalRecordType type, BinaryReader& payload) {
+        switch (type) {
+        case WalRecordType::ADD_CAR: {
+            Car car = readCar(payload);
+            if (payload.ok()) {
+                storeCar(car);
+            }
+            break;
+        }
+        case WalRecordType::REMOVE_CAR: {
+            std::string licensePlate = payload.readString();
+            if (payload.ok()) {
+                eraseCar(licensePlate);
+            }
+            break;
+        }
+        case WalRecordType::MAKE_RESERVATION: {
+            uint64_t reservationNumber = payload.read<uint64_t>();
+            Car car = readCar(payload);
+            Customer customer = readCustomer(payload);
+            int64_t startEpoch = payload.read<int64_t>();
+            int64_t endEpoch = payload.read<int64_t>();
+            double totalPrice = payload.read<double>();
+            if (payload.ok() && !reservations.contains(reservationNumber)) {
+                insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+            }
+            break;
+        }
+        case WalRecordType::GROUP_RESERVATION: {
+            int64_t startEpoch = payload.read<int64_t>();
+            int64_t endEpoch = payload.read<int64_t>();
+            Customer customer = readCustomer(payload);
+            std::vector<std::tuple<uint64_t, Car, double>> bookings;
+            for (uint32_t i = payload.read<uint32_t>(); i > 0 && payload.ok(); --i) {
+                uint64_t reservationNumber = payload.read<uint64_t>();
+                Car car = readCar(payload);
+                bookings.emplace_back(reservationNumber, car, payload.read<double>());
+            }
+            if (payload.ok()) {
+                for (const auto& [reservationNumber, car, totalPrice] : bookings) {
+                    if (!reservations.contains(reservationNumber)) {
+                        insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+                    }
+                }
+            }
+            break;
+        }
+        case WalRecordType::CANCEL_RESERVATION: {
+            ReservationHandle handle = reservations.find(payload.read<uint64_t>());
+            if (payload.ok() && handle != INVALID_HANDLE) {
+                eraseReservation(handle);
+            }
+            break;
+        }
+        }
+    }
+
+    // Snapshot layout: magic, last covered lsn, fleet cars, the reservation
+    // store's car and customer registries in handle order, live reservation
+    // records, and a trailing checksum.
+    std::vector<char> serializeSnapshot(uint64_t lastLsn) const {
+        std::vector<char> buffer;
+        BinaryWriter writer(buffer);
+        writer.write(SNAPSHOT_MAGIC);
+        writer.write(lastLsn);
+        writer.write(static_cast<uint64_t>(cars.size()));
+        for (const auto& [licensePlate, car] : cars) {
+            writeCar(writer, car);
+        }
+        writer.write(static_cast<uint64_t>(reservations.getRegisteredCars().size()));
+        for (const Car& car : reservations.getRegisteredCars()) {
+            writeCar(writer, car);
+        }
+        writer.write(static_cast<uint64_t>(reservations.getRegisteredCustomers().size()));
+        for (const Customer& customer : reservations.getRegisteredCustomers()) {
+            writeCustomer(writer, customer);
+        }
+        uint64_t liveRecords = 0;
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            liveRecords += record.car != INVALID_HANDLE;
+        }
+        writer.write(liveRecords);
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            if (record.car != INVALID_HANDLE) {
+                writer.write(record.reservationNumber);
+                writer.write(record.car);
+                writer.write(record.customer);
+                writer.write(record.startEpoch);
+                writer.write(record.endEpoch);
+                writer.write(record.totalPrice);
+            }
+        }
+        writer.write(checksum(buffer.data(), buffer.size()));
+        return buffer;
+    }
+
+    // Written to a temp file and renamed, so a crash keeps the old snapshot.
+    bool writeSnapshot(const std::vector<char>& buffer) const {
+        std::string tempPath = snapshotPath + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && syncToDisk(file);
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(tempPath, snapshotPath, error);
+        return written && !error;
+    }
+
+    // Parses the snapshot straight out of the mapped file. A missing snapshot
+    // is an empty system; a damaged one fails recovery.
+    bool loadSnapshot(uint64_t& lastLsn) {
+        std::error_code error;
+        if (!std::filesystem::exists(snapshotPath, error)) {
+            return true;
+        }
+        MappedFile mapped;
+        if (!mapped.open(snapshotPath) || mapped.getSize() < sizeof(uint32_t)) {
+            return false;
+        }
+        size_t bodySize = mapped.getSize() - sizeof(uint32_t);
+        BinaryReader trailer(mapped.getData() + bodySize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(mapped.getData(), bodySize)) {
+            return false;
+        }
+        BinaryReader reader(mapped.getData(), bodySize);
+        if (reader.read<uint32_t>() != SNAPSHOT_MAGIC) {
+            return false;
+        }
+        lastLsn = reader.read<uint64_t>();
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            storeCar(readCar(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            reservations.internCar(readCar(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            reservations.internCustomer(readCustomer(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            uint64_t reservationNumber = reader.read<uint64_t>();
+            CarHandle carHandle = reader.read<CarHandle>();
+            CustomerHandle customerHandle = reader.read<CustomerHandle>();
+            int64_t startEpoch = reader.read<int64_t>();
+            int64_t endEpoch = reader.read<int64_t>();
+            double totalPrice = reader.read<double>();
+            if (!reader.ok() || carHandle >= reservations.getRegisteredCars().size() ||
+                customerHandle >= reservations.getRegisteredCustomers().size() ||
+                reservations.contains(reservationNumber)) {
+                return false;
+            }
+            ReservationHandle handle = reservations.add(reservationNumber, carHandle, customerHandle,
+                                                        startEpoch, endEpoch, totalPrice);
+            reservationIndex.insert(carHandle, startEpoch, endEpoch, handle);
+            reservationColumns.add(handle, reservations.get(handle), reservations.getCar(carHandle).getMake());
+        }
+        return reader.ok();
+    }
+
+    std::vector<Car> filterAvailable(const std::vector<const Car*>& candidates,
+                                     const std::chrono::system_clock::time_point& startDate,
+                                     const std::chrono::system_clock::time_point& endDate) {
+        std::vector<Car> availableCars;
+        for (const Car* car : candidates) {
+            if (car->isAvailable() && isCarAvailable(*car, startDate, endDate)) {
+                availableCars.push_back(*car);
+            }
+        }
+        return availableCars;
+    }
+
+    uint64_t generateReservationNumber() {
         static std::mt19937 rng(std::time(nullptr));
         static std::uniform_int_distribution<int> dist(0, 99999999);
-        return "RES" + std::to_string(dist(rng));
+        return dist(rng);
     }
 };
 
-RentalSystem* RentalSystem::instance = nullptr;
-
 #endif // RENTALSYSTEM_H
@@ -15,20 +15,30 @@ private:
     std::chrono::system_clock::time_point endDate;
     double totalPrice;
 
-    double calculateTotalPrice() const {
+public:
+    static double calculateTotalPrice(const Car& car, const std::chrono::system_clock::time_point& startDate,
+                                      const std::chrono::system_clock::time_point& endDate) {
         auto duration = std::chrono::duration_cast<std::chrono::days>(endDate - startDate).count() + 1;
         return car.getRentalPricePerDay() * duration;
     }
 
-public:
+    Reservation() : reservationId(""), customer(), car(), startDate(), endDate(), totalPrice(0.0) {}
+
     Reservation(std::string reservationId, Customer customer, Car car,
                 std::chrono::system_clock::time_point startDate, std::chrono::system_clock::time_point endDate)
         : reservationId(reservationId), customer(customer), car(car),
-          startDate(startDate), endDate(endDate), totalPrice(calculateTotalPrice()) {}
+          startDate(startDate), endDate(endDate), totalPrice(calculateTotalPrice(car, startDate, endDate)) {}
+
+    Reservation(std::string reservationId, Customer customer, Car car,
+                std::chrono::system_clock::time_point startDate, std::chrono::system_clock::time_point endDate,
+                double totalPrice)
+        : reservationId(reservationId), customer(customer), car(car),
+          startDate(startDate), endDate(endDate), totalPrice(totalPrice) {}
 
     std::chrono::system_clock::time_point getStartDate() const { return startDate; }
     std::chrono::system_clock::time_point getEndDate() const { return endDate; }
-    Car getCar() const { return car; }
+    const Car& getCar() const { return car; }
+    const Customer& getCustomer() const { return customer; }
     double getTotalPrice() const { return totalPrice; }
     std::string getReservationId() const { return reservationId; }
 };
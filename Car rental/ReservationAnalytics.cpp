@@ -0,0 +1,242 @@
+#ifndef RESERVATIONANALYTICS_H
+#define RESERVATIONANALYTICS_H
+
+#include "ReservationColumns.cpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct DailyRevenue {
+    std::string make;
+    std::chrono::system_clock::time_point day;
+    double revenue;
+};
+
+// Reports over ReservationColumns. Each one splits the rows into one chunk
+// per thread, scans its chunk with plain loops over the columns that the
+// compiler can vectorize, and merges the per-thread partials at the end.
+class ReservationAnalytics {
+private:
+    static constexpr size_t MIN_ROWS_PER_THREAD = 1 << 16;
+    static constexpr size_t SUM_LANES = 8;
+    static constexpr size_t MAX_DENSE_REVENUE_CELLS = 1 << 20;
+
+    // Runs scan(begin, end, partial) over contiguous chunks of [0, rows), the
+    // first on the calling thread, and returns the partials in chunk order.
+    template <typename Partial, typename Scan>
+    static std::vector<Partial> parallelScan(size_t rows, unsigned threadCount, const Partial& initial, Scan scan) {
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(threadCount, rows / MIN_ROWS_PER_THREAD));
+        size_t chunkSize = (rows + chunks - 1) / chunks;
+        std::vector<Partial> partials(chunks, initial);
+        std::vector<std::thread> threads;
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            threads.emplace_back([&, chunk]() {
+                scan(std::min(rows, chunk * chunkSize), std::min(rows, (chunk + 1) * chunkSize), partials[chunk]);
+            });
+        }
+        scan(0, std::min(rows, chunkSize), partials[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return partials;
+    }
+
+    static int64_t ticksPerDay() {
+        return std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(24)).count();
+    }
+
+    static int64_t floorDay(int64_t epoch) {
+        int64_t day = epoch / ticksPerDay();
+        return (epoch % ticksPerDay() < 0) ? day - 1 : day;
+    }
+
+    // Last instant a booking occupies, so floorDay() of it is its last day.
+    static int64_t lastTick(int64_t startEpoch, int64_t endEpoch) {
+        return endEpoch > startEpoch ? endEpoch - 1 : startEpoch;
+    }
+
+    // Calls add(day, share) for every day [startEpoch, endEpoch) covers, the
+    // price split in proportion to the time booked on each day. An empty
+    // booking puts all of it on its start day.
+    template <typename Add>
+    static void spreadOverDays(int64_t startEpoch, int64_t endEpoch, double price, Add add) {
+        int64_t day = floorDay(startEpoch);
+        if (endEpoch <= startEpoch) {
+            add(day, price);
+            return;
+        }
+        double perTick = price / static_cast<double>(endEpoch - startEpoch);
+        for (int64_t dayStart = day * ticksPerDay(); dayStart < endEpoch; ++day, dayStart += ticksPerDay()) {
+            int64_t booked = std::min(endEpoch, dayStart + ticksPerDay()) - std::max(startEpoch, dayStart);
+            add(day, perTick * static_cast<double>(booked));
+        }
+    }
+
+public:
+    static unsigned defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Mean booking length in system_clock ticks, or 0 without bookings. Sums
+    // in SUM_LANES independent doubles so the loop needs no reassociation.
+    static double averageRentalLength(const ReservationColumns& columns, unsigned threadCount = defaultThreadCount()) {
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        auto partials = parallelScan(columns.size(), threadCount, 0.0, [&](size_t begin, size_t end, double& total) {
+            double lanes[SUM_LANES] = {};
+            size_t row = begin;
+            for (; row + SUM_LANES <= end; row += SUM_LANES) {
+                for (size_t lane = 0; lane < SUM_LANES; ++lane) {
+                    lanes[lane] += static_cast<double>(ends[row + lane] - starts[row + lane]);
+                }
+            }
+            for (; row < end; ++row) {
+                lanes[0] += static_cast<double>(ends[row] - starts[row]);
+            }
+            for (double lane : lanes) {
+                total += lane;
+            }
+        });
+        double total = 0;
+        for (double partial : partials) {
+            total += partial;
+        }
+        return columns.size() == 0 ? 0 : total / static_cast<double>(columns.size());
+    }
+
+    // Share of [fromEpoch, toEpoch) each car is booked for, indexed by car
+    // handle. Bookings of one car never overlap, so the clipped lengths add up.
+    static std::vector<double> utilizationPerCar(const ReservationColumns& columns, size_t carCount,
+                                                 int64_t fromEpoch, int64_t toEpoch,
+                                                 unsigned threadCount = defaultThreadCount()) {
+        std::vector<double> utilization(carCount, 0);
+        if (toEpoch <= fromEpoch) {
+            return utilization;
+        }
+        const CarHandle* cars = columns.getCars().data();
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        auto partials = parallelScan(columns.size(), threadCount, std::vector<int64_t>(),
+                                     [&](size_t begin, size_t end, std::vector<int64_t>& booked) {
+            booked.assign(carCount, 0);
+            for (size_t row = begin; row < end; ++row) {
+                int64_t clipped = std::min(ends[row], toEpoch) - std::max(starts[row], fromEpoch);
+                booked[cars[row]] += std::max<int64_t>(clipped, 0);
+            }
+        });
+        double window = static_cast<double>(toEpoch - fromEpoch);
+        for (size_t car = 0; car < carCount; ++car) {
+            int64_t booked = 0;
+            for (const std::vector<int64_t>& partial : partials) {
+                booked += partial[car];
+            }
+            utilization[car] = static_cast<double>(booked) / window;
+        }
+        return utilization;
+    }
+
+    // Revenue earned on each day, per make, ordered by make then day; days
+    // without revenue are left out. A booking's price is spread over the days
+    // it covers in proportion to the time booked on each. Uses a dense make x
+    // day grid per thread when the date range is small and a hash map
+    // otherwise.
+    static std::vector<DailyRevenue> revenueByMakePerDay(const ReservationColumns& columns,
+                                                         unsigned threadCount = defaultThreadCount()) {
+        std::vector<DailyRevenue> result;
+        if (columns.size() == 0) {
+            return result;
+        }
+        const uint32_t* makes = columns.getMakes().data();
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        const double* prices = columns.getTotalPrices().data();
+        const std::vector<std::string>& makeNames = columns.getMakeNames();
+
+        auto bounds = parallelScan(columns.size(), threadCount,
+                                   std::make_pair(std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()),
+                                   [&](size_t begin, size_t end, std::pair<int64_t, int64_t>& range) {
+            int64_t low = range.first;
+            int64_t high = range.second;
+            for (size_t row = begin; row < end; ++row) {
+                low = std::min(low, starts[row]);
+                high = std::max(high, lastTick(starts[row], ends[row]));
+            }
+            range = {low, high};
+        });
+        int64_t firstStart = std::numeric_limits<int64_t>::max();
+        int64_t lastBooked = std::numeric_limits<int64_t>::min();
+        for (const auto& [low, high] : bounds) {
+            firstStart = std::min(firstStart, low);
+            lastBooked = std::max(lastBooked, high);
+        }
+        int64_t firstDay = floorDay(firstStart);
+        size_t dayCount = static_cast<size_t>(floorDay(lastBooked) - firstDay + 1);
+        size_t makeCount = makeNames.size();
+
+        std::vector<std::unordered_map<uint64_t, double>> revenueByDay(makeCount);
+        if (dayCount <= MAX_DENSE_REVENUE_CELLS / std::max<size_t>(makeCount, 1)) {
+            auto partials = parallelScan(columns.size(), threadCount, std::vector<double>(),
+                                         [&](size_t begin, size_t end, std::vector<double>& grid) {
+                grid.assign(makeCount * dayCount, 0);
+                for (size_t row = begin; row < end; ++row) {
+                    double* makeRow = grid.data() + makes[row] * dayCount;
+                    spreadOverDays(starts[row], ends[row], prices[row], [&](int64_t day, double share) {
+                        makeRow[static_cast<size_t>(day - firstDay)] += share;
+                    });
+                }
+            });
+            for (size_t make = 0; make < makeCount; ++make) {
+                for (size_t day = 0; day < dayCount; ++day) {
+                    double revenue = 0;
+                    for (const std::vector<double>& grid : partials) {
+                        revenue += grid[make * dayCount + day];
+                    }
+                    if (revenue != 0) {
+                        revenueByDay[make][day] = revenue;
+                    }
+                }
+            }
+        } else {
+            auto partials = parallelScan(columns.size(), threadCount, std::unordered_map<uint64_t, double>(),
+                                         [&](size_t begin, size_t end, std::unordered_map<uint64_t, double>& revenue) {
+                for (size_t row = begin; row < end; ++row) {
+                    uint64_t make = static_cast<uint64_t>(makes[row]) << 40;
+                    spreadOverDays(starts[row], ends[row], prices[row], [&](int64_t day, double share) {
+                        revenue[make | static_cast<uint64_t>(day - firstDay)] += share;
+                    });
+                }
+            });
+            for (const auto& partial : partials) {
+                for (const auto& [key, revenue] : partial) {
+                    revenueByDay[key >> 40][key & ((uint64_t(1) << 40) - 1)] += revenue;
+                }
+            }
+        }
+
+        std::vector<size_t> makeOrder(makeCount);
+        for (size_t make = 0; make < makeCount; ++make) {
+            makeOrder[make] = make;
+        }
+        std::sort(makeOrder.begin(), makeOrder.end(), [&](size_t a, size_t b) { return makeNames[a] < makeNames[b]; });
+        for (size_t make : makeOrder) {
+            std::vector<std::pair<uint64_t, double>> days(revenueByDay[make].begin(), revenueByDay[make].end());
+            std::sort(days.begin(), days.end());
+            for (const auto& [day, revenue] : days) {
+                if (revenue == 0) {
+                    continue;
+                }
+                auto dayStart = std::chrono::system_clock::time_point(
+                    std::chrono::system_clock::duration((firstDay + static_cast<int64_t>(day)) * ticksPerDay()));
+                result.push_back(DailyRevenue{makeNames[make], dayStart, revenue});
+            }
+        }
+        return result;
+    }
+};
+
+#endif // RESERVATIONANALYTICS_H
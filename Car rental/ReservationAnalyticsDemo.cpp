@@ -0,0 +1,71 @@
+#include "ReservationAnalytics.cpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Fills the reservation columns with synthetic bookings (row count from the
+// command line, 10 million by default), times each report with all hardware
+// threads, and checks the results against a single-threaded run and the daily
+// revenue against the total booked.
+template <typename Report>
+static auto timed(const char* name, Report report) {
+    auto begin = std::chrono::steady_clock::now();
+    auto result = report();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << name << ": " << elapsed.count() * 1000 << " ms\n";
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const size_t carCount = 20000;
+    const std::vector<std::string> makes = {"Toyota", "Honda", "Ford", "BMW", "Kia"};
+    const int64_t hour = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(1)).count();
+    const int64_t horizonStart = 20000 * 24 * hour;
+
+    ReservationColumns columns;
+    double totalBooked = 0;
+    std::mt19937_64 rng(11);
+    for (size_t row = 0; row < rows; ++row) {
+        CarHandle car = static_cast<CarHandle>(rng() % carCount);
+        int64_t startEpoch = horizonStart + static_cast<int64_t>(rng() % (365 * 24)) * hour;
+        int64_t endEpoch = startEpoch + static_cast<int64_t>(1 + rng() % (7 * 24)) * hour;
+        ReservationRecord record{startEpoch, endEpoch, 40.0 + static_cast<double>(rng() % 100), row, car, 0};
+        columns.add(static_cast<ReservationHandle>(row), record, makes[car % makes.size()]);
+        totalBooked += record.totalPrice;
+    }
+    unsigned threads = ReservationAnalytics::defaultThreadCount();
+    std::cout << "Rows: " << columns.size() << ", threads: " << threads << "\n";
+
+    int64_t from = horizonStart + 30 * 24 * hour;
+    int64_t to = from + 30 * 24 * hour;
+    auto revenue = timed("Revenue by make per day", [&]() { return ReservationAnalytics::revenueByMakePerDay(columns, threads); });
+    auto utilization = timed("Utilization per car", [&]() {
+        return ReservationAnalytics::utilizationPerCar(columns, carCount, from, to, threads);
+    });
+    double averageLength = timed("Average rental length", [&]() {
+        return ReservationAnalytics::averageRentalLength(columns, threads);
+    });
+
+    auto serialRevenue = ReservationAnalytics::revenueByMakePerDay(columns, 1);
+    auto serialUtilization = ReservationAnalytics::utilizationPerCar(columns, carCount, from, to, 1);
+    double serialAverageLength = ReservationAnalytics::averageRentalLength(columns, 1);
+    bool matches = revenue.size() == serialRevenue.size() && utilization == serialUtilization &&
+                   std::abs(averageLength - serialAverageLength) <= 1e-9 * serialAverageLength;
+    double totalDailyRevenue = 0;
+    for (size_t i = 0; matches && i < revenue.size(); ++i) {
+        matches = revenue[i].make == serialRevenue[i].make && revenue[i].day == serialRevenue[i].day &&
+                  std::abs(revenue[i].revenue - serialRevenue[i].revenue) <= 1e-9 * serialRevenue[i].revenue;
+        totalDailyRevenue += revenue[i].revenue;
+    }
+    matches = matches && std::abs(totalDailyRevenue - totalBooked) <= 1e-9 * totalBooked;
+
+    std::cout << "Average rental length: " << averageLength / hour << " hours\n";
+    std::cout << "Revenue spread over days: " << totalDailyRevenue << " of " << totalBooked << " booked\n";
+    std::cout << "Parallel results match single-threaded run: " << (matches ? "yes" : "no") << "\n";
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#ifndef RESERVATIONCOLUMNS_H
+#define RESERVATIONCOLUMNS_H
+
+#include "ReservationStore.cpp"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Live reservations as one array per field, for reports that scan every
+// booking. Rows are dense: a cancelled booking's row is filled with the last
+// row, so a scan never has to skip free slots. Makes are interned to small ids
+// when a booking is added.
+class ReservationColumns {
+private:
+    std::vector<CarHandle> cars;
+    std::vector<uint32_t> makes;
+    std::vector<int64_t> startEpochs;
+    std::vector<int64_t> endEpochs;
+    std::vector<double> totalPrices;
+    std::vector<ReservationHandle> handles;
+    std::vector<uint32_t> rowByHandle;
+    std::vector<std::string> makeNames;
+    std::unordered_map<std::string, uint32_t> makeIds;
+
+public:
+    void add(ReservationHandle handle, const ReservationRecord& record, const std::string& make) {
+        auto [it, inserted] = makeIds.emplace(make, static_cast<uint32_t>(makeNames.size()));
+        if (inserted) {
+            makeNames.push_back(make);
+        }
+        if (handle >= rowByHandle.size()) {
+            rowByHandle.resize(handle + 1, INVALID_HANDLE);
+        }
+        rowByHandle[handle] = static_cast<uint32_t>(handles.size());
+        cars.push_back(record.car);
+        makes.push_back(it->second);
+        startEpochs.push_back(record.startEpoch);
+        endEpochs.push_back(record.endEpoch);
+        totalPrices.push_back(record.totalPrice);
+        handles.push_back(handle);
+    }
+
+    void remove(ReservationHandle handle) {
+        if (handle >= rowByHandle.size() || rowByHandle[handle] == INVALID_HANDLE) {
+            return;
+        }
+        uint32_t row = rowByHandle[handle];
+        uint32_t last = static_cast<uint32_t>(handles.size() - 1);
+        cars[row] = cars[last];
+        makes[row] = makes[last];
+        startEpochs[row] = startEpochs[last];
+        endEpochs[row] = endEpochs[last];
+        totalPrices[row] = totalPrices[last];
+        handles[row] = handles[last];
+        rowByHandle[handles[row]] = row;
+        rowByHandle[handle] = INVALID_HANDLE;
+        cars.pop_back();
+        makes.pop_back();
+        startEpochs.pop_back();
+        endEpochs.pop_back();
+        totalPrices.pop_back();
+        handles.pop_back();
+    }
+
+    size_t size() const { return handles.size(); }
+
+    const std::vector<CarHandle>& getCars() const { return cars; }
+    const std::vector<uint32_t>& getMakes() const { return makes; }
+    const std::vector<int64_t>& getStartEpochs() const { return startEpochs; }
+    const std::vector<int64_t>& getEndEpochs() const { return endEpochs; }
+    const std::vector<double>& getTotalPrices() const { return totalPrices; }
+    const std::vector<std::string>& getMakeNames() const { return makeNames; }
+};
+
+#endif // RESERVATIONCOLUMNS_H
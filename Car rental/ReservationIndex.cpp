@@ -0,0 +1,169 @@
+#ifndef RESERVATIONINDEX_H
+#define RESERVATIONINDEX_H
+
+#include "ReservationStore.cpp"
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Per-car sorted interval index. Reservations of one car never overlap, so
+// ordering them by (start, end) also orders their end dates, and an overlap
+// query only has to look at the last interval starting before the query end.
+// A multiset because two empty bookings at the same instant do not overlap.
+class ReservationIndex {
+private:
+    struct Interval {
+        int64_t start;
+        int64_t end;
+        ReservationHandle reservation;
+
+        bool operator<(const Interval& other) const {
+            if (start != other.start) return start < other.start;
+            return end < other.end;
+        }
+    };
+
+    // Free gaps between consecutive bookings, keyed by (length class, start)
+    // where the class is floor(log2(length)). Open-ended gaps before the first
+    // and after the last booking use the int64 limits and the top class.
+    using GapKey = std::pair<int, int64_t>;
+
+    struct CarSchedule {
+        std::multiset<Interval> intervals;
+        std::map<GapKey, int64_t> gaps;
+    };
+
+    std::vector<CarSchedule> schedules;
+
+    static int64_t gapLength(int64_t start, int64_t end) {
+        if (start == std::numeric_limits<int64_t>::min() || end == std::numeric_limits<int64_t>::max()) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        return end - start;
+    }
+
+    static int lengthClass(int64_t length) {
+        int lengthClass = 0;
+        for (uint64_t rest = static_cast<uint64_t>(length); rest > 1; rest >>= 1) {
+            ++lengthClass;
+        }
+        return lengthClass;
+    }
+
+    static void addGap(CarSchedule& schedule, int64_t start, int64_t end) {
+        if (start < end) {
+            schedule.gaps.emplace(GapKey{lengthClass(gapLength(start, end)), start}, end);
+        }
+    }
+
+    static void removeGap(CarSchedule& schedule, int64_t start, int64_t end) {
+        if (start < end) {
+            schedule.gaps.erase(GapKey{lengthClass(gapLength(start, end)), start});
+        }
+    }
+
+    // The gap an interval at `it` sits in: from the end of the booking before
+    // it to the start of the booking after it.
+    static std::pair<int64_t, int64_t> surroundingGap(const std::multiset<Interval>& intervals,
+                                                      std::multiset<Interval>::const_iterator it) {
+        int64_t gapStart = it == intervals.begin() ? std::numeric_limits<int64_t>::min() : std::prev(it)->end;
+        auto next = std::next(it);
+        int64_t gapEnd = next == intervals.end() ? std::numeric_limits<int64_t>::max() : next->start;
+        return {gapStart, gapEnd};
+    }
+
+public:
+    bool overlaps(CarHandle car, int64_t startEpoch, int64_t endEpoch) const {
+        if (car >= schedules.size() || schedules[car].intervals.empty()) {
+            return false;
+        }
+        const auto& intervals = schedules[car].intervals;
+        auto it = intervals.lower_bound(Interval{endEpoch, std::numeric_limits<int64_t>::min(), 0});
+        if (it == intervals.begin()) {
+            return false;
+        }
+        --it;
+        return startEpoch < it->end;
+    }
+
+    void insert(CarHandle car, int64_t startEpoch, int64_t endEpoch, ReservationHandle reservation) {
+        if (car >= schedules.size()) {
+            schedules.resize(car + 1);
+        }
+        CarSchedule& schedule = schedules[car];
+        auto it = schedule.intervals.insert(Interval{startEpoch, endEpoch, reservation});
+        auto [gapStart, gapEnd] = surroundingGap(schedule.intervals, it);
+        removeGap(schedule, gapStart, gapEnd);
+        addGap(schedule, gapStart, startEpoch);
+        addGap(schedule, endEpoch, gapEnd);
+    }
+
+    void erase(CarHandle car, int64_t startEpoch, int64_t endEpoch) {
+        if (car >= schedules.size()) {
+            return;
+        }
+        CarSchedule& schedule = schedules[car];
+        auto it = schedule.intervals.find(Interval{startEpoch, endEpoch, 0});
+        if (it != schedule.intervals.end()) {
+            auto [gapStart, gapEnd] = surroundingGap(schedule.intervals, it);
+            removeGap(schedule, gapStart, startEpoch);
+            removeGap(schedule, endEpoch, gapEnd);
+            addGap(schedule, gapStart, gapEnd);
+            schedule.intervals.erase(it);
+        }
+    }
+
+    // Earliest s >= notBefore such that [s, s + length) overlaps no booking of
+    // the car. Either notBefore itself fits, or the answer is the start of the
+    // first long-enough gap after it: one lookup per length class.
+    int64_t earliestFreeStart(CarHandle car, int64_t notBefore, int64_t length) const {
+        if (!overlaps(car, notBefore, notBefore + length)) {
+            return notBefore;
+        }
+        const auto& gaps = schedules[car].gaps;
+        int64_t best = std::numeric_limits<int64_t>::max();
+        for (int gapClass = lengthClass(length); gapClass < 64; ++gapClass) {
+            for (auto it = gaps.lower_bound(GapKey{gapClass, notBefore});
+                 it != gaps.end() && it->first.first == gapClass && it->first.second < best; ++it) {
+                if (gapLength(it->first.second, it->second) >= length) {
+                    best = it->first.second;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Calls visit(start, end, reservation) for every interval of the car that
+    // touches [startEpoch, endEpoch], endpoints included.
+    template <typename Visit>
+    void forEachTouching(CarHandle car, int64_t startEpoch, int64_t endEpoch, Visit visit) const {
+        if (car >= schedules.size()) {
+            return;
+        }
+        const auto& intervals = schedules[car].intervals;
+        auto it = intervals.lower_bound(Interval{startEpoch, std::numeric_limits<int64_t>::min(), 0});
+        while (it != intervals.begin() && std::prev(it)->end >= startEpoch) {
+            --it;
+        }
+        for (; it != intervals.end() && it->start <= endEpoch; ++it) {
+            visit(it->start, it->end, it->reservation);
+        }
+    }
+
+    std::vector<ReservationHandle> reservationsOf(CarHandle car) const {
+        std::vector<ReservationHandle> result;
+        if (car < schedules.size()) {
+            for (const Interval& interval : schedules[car].intervals) {
+                result.push_back(interval.reservation);
+            }
+        }
+        return result;
+    }
+};
+
+#endif // RESERVATIONINDEX_H
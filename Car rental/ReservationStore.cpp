@@ -0,0 +1,149 @@
+#ifndef RESERVATIONSTORE_H
+#define RESERVATIONSTORE_H
+
+#include "Car.cpp"
+#include "Customer.cpp"
+#include "Reservation.cpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using CarHandle = uint32_t;
+using CustomerHandle = uint32_t;
+using ReservationHandle = uint32_t;
+
+constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+// One booking in 40 bytes: dense handles instead of embedded Car/Customer
+// copies, and dates as raw system_clock ticks. The reservation id is
+// "RES" + reservationNumber. A free slot has car == INVALID_HANDLE.
+struct ReservationRecord {
+    int64_t startEpoch;
+    int64_t endEpoch;
+    double totalPrice;
+    uint64_t reservationNumber;
+    CarHandle car;
+    CustomerHandle customer;
+};
+
+// Contiguous reservation storage plus the registries that hand out car and
+// customer handles. Cancelled slots are recycled, so handles stay dense.
+class ReservationStore {
+private:
+    std::vector<ReservationRecord> records;
+    std::vector<ReservationHandle> freeSlots;
+    std::unordered_map<uint64_t, ReservationHandle> handleByNumber;
+    std::vector<Car> carsByHandle;
+    std::unordered_map<std::string, CarHandle> carHandles;
+    std::vector<Customer> customersByHandle;
+    std::unordered_map<std::string, CustomerHandle> customerHandles;
+
+public:
+    static int64_t toEpoch(const std::chrono::system_clock::time_point& timePoint) {
+        return timePoint.time_since_epoch().count();
+    }
+
+    static std::chrono::system_clock::time_point fromEpoch(int64_t epoch) {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(epoch));
+    }
+
+    static std::string formatReservationId(uint64_t reservationNumber) {
+        return "RES" + std::to_string(reservationNumber);
+    }
+
+    static bool parseReservationId(const std::string& reservationId, uint64_t& reservationNumber) {
+        if (reservationId.size() <= 3 || reservationId.compare(0, 3, "RES") != 0) {
+            return false;
+        }
+        char* end = nullptr;
+        reservationNumber = std::strtoull(reservationId.c_str() + 3, &end, 10);
+        return *end == '\0';
+    }
+
+    CarHandle internCar(const Car& car) {
+        auto [it, inserted] = carHandles.emplace(car.getLicensePlate(), static_cast<CarHandle>(carsByHandle.size()));
+        if (inserted) {
+            carsByHandle.push_back(car);
+        } else {
+            carsByHandle[it->second] = car;
+        }
+        return it->second;
+    }
+
+    CarHandle findCar(const std::string& licensePlate) const {
+        auto it = carHandles.find(licensePlate);
+        return it == carHandles.end() ? INVALID_HANDLE : it->second;
+    }
+
+    CustomerHandle internCustomer(const Customer& customer) {
+        auto [it, inserted] = customerHandles.emplace(customer.getDriversLicenseNumber(),
+                                                      static_cast<CustomerHandle>(customersByHandle.size()));
+        if (inserted) {
+            customersByHandle.push_back(customer);
+        } else {
+            customersByHandle[it->second] = customer;
+        }
+        return it->second;
+    }
+
+    bool contains(uint64_t reservationNumber) const {
+        return handleByNumber.count(reservationNumber) != 0;
+    }
+
+    ReservationHandle add(uint64_t reservationNumber, CarHandle car, CustomerHandle customer,
+                          int64_t startEpoch, int64_t endEpoch, double totalPrice) {
+        ReservationRecord record{startEpoch, endEpoch, totalPrice, reservationNumber, car, customer};
+        ReservationHandle handle;
+        if (!freeSlots.empty()) {
+            handle = freeSlots.back();
+            freeSlots.pop_back();
+            records[handle] = record;
+        } else {
+            handle = static_cast<ReservationHandle>(records.size());
+            records.push_back(record);
+        }
+        handleByNumber[reservationNumber] = handle;
+        return handle;
+    }
+
+    void remove(ReservationHandle handle) {
+        handleByNumber.erase(records[handle].reservationNumber);
+        records[handle].car = INVALID_HANDLE;
+        freeSlots.push_back(handle);
+    }
+
+    ReservationHandle find(uint64_t reservationNumber) const {
+        auto it = handleByNumber.find(reservationNumber);
+        return it == handleByNumber.end() ? INVALID_HANDLE : it->second;
+    }
+
+    ReservationHandle find(const std::string& reservationId) const {
+        uint64_t reservationNumber = 0;
+        if (!parseReservationId(reservationId, reservationNumber)) {
+            return INVALID_HANDLE;
+        }
+        return find(reservationNumber);
+    }
+
+    const ReservationRecord& get(ReservationHandle handle) const { return records[handle]; }
+    const Car& getCar(CarHandle handle) const { return carsByHandle[handle]; }
+    const Customer& getCustomer(CustomerHandle handle) const { return customersByHandle[handle]; }
+
+    // Raw storage, including free slots, for snapshots and bulk scans.
+    const std::vector<ReservationRecord>& getRecords() const { return records; }
+    const std::vector<Car>& getRegisteredCars() const { return carsByHandle; }
+    const std::vector<Customer>& getRegisteredCustomers() const { return customersByHandle; }
+
+    // Builds the full Reservation object for callers outside the hot path.
+    Reservation materialize(ReservationHandle handle) const {
+        const ReservationRecord& record = records[handle];
+        return Reservation(formatReservationId(record.reservationNumber), customersByHandle[record.customer],
+                           carsByHandle[record.car], fromEpoch(record.startEpoch), fromEpoch(record.endEpoch),
+                           record.totalPrice);
+    }
+};
+
+#endif // RESERVATIONSTORE_H
@@ -0,0 +1,51 @@
+#ifndef STUBPAYMENTPROCESSOR_H
+#define STUBPAYMENTPROCESSOR_H
+
+#include "PaymentProcessor.cpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Offline stand-in for a payment gateway. Every provider call, single or
+// batched, costs one simulated round trip of `latency`, and each charge is
+// declined with probability `failureRate`. Safe to call from several threads.
+class StubPaymentProcessor : public PaymentProcessor {
+private:
+    std::chrono::microseconds latency;
+    double failureRate;
+    std::mutex rngMutex;
+    std::mt19937 rng;
+    std::atomic<size_t> gatewayCalls{0};
+    std::atomic<size_t> chargesProcessed{0};
+
+public:
+    StubPaymentProcessor(std::chrono::microseconds latency, double failureRate, unsigned int seed = 42)
+        : latency(latency), failureRate(failureRate), rng(seed) {}
+
+    bool processPayment(double amount) override {
+        return processPayments({amount}).front();
+    }
+
+    std::vector<bool> processPayments(const std::vector<double>& amounts) override {
+        gatewayCalls.fetch_add(1, std::memory_order_relaxed);
+        chargesProcessed.fetch_add(amounts.size(), std::memory_order_relaxed);
+        std::this_thread::sleep_for(latency);
+
+        std::vector<bool> results;
+        results.reserve(amounts.size());
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        std::lock_guard<std::mutex> lock(rngMutex);
+        for (double amount : amounts) {
+            results.push_back(amount > 0.0 && dist(rng) >= failureRate);
+        }
+        return results;
+    }
+
+    size_t getGatewayCalls() const { return gatewayCalls.load(); }
+    size_t getChargesProcessed() const { return chargesProcessed.load(); }
+};
+
+#endif // STUBPAYMENTPROCESSOR_H
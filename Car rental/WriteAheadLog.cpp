@@ -0,0 +1,247 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include "../Common/MappedFile.cpp"
+#include "../Common/BinaryCodec.cpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class WalRecordType : uint8_t {
+    ADD_CAR = 1,
+    REMOVE_CAR = 2,
+    MAKE_RESERVATION = 3,
+    CANCEL_RESERVATION = 4,
+    GROUP_RESERVATION = 5
+};
+
+// Append-only binary log. Each record is
+//   [u32 payload length][u64 lsn][u8 type][payload][u32 checksum]
+// Appends only copy into an in-memory group; a background thread writes and
+// fsyncs the whole group at once (group commit), every groupCommitInterval or
+// sooner when someone waits for durability.
+class WriteAheadLog {
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    std::chrono::milliseconds groupCommitInterval;
+
+    std::mutex mutex;
+    std::condition_variable flushRequested;
+    std::condition_variable flushCompleted;
+    std::mutex fileMutex;
+    std::vector<char> pending;
+    uint64_t nextLsn = 1;
+    uint64_t durableLsn = 0;
+    bool syncRequested = false;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    void flusherLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            flushRequested.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (!stopping && !syncRequested) {
+                flushRequested.wait_for(lock, groupCommitInterval, [this]() { return stopping || syncRequested; });
+            }
+            if (!pending.empty()) {
+                std::vector<char> group;
+                group.swap(pending);
+                uint64_t groupLsn = nextLsn - 1;
+                syncRequested = false;
+                lock.unlock();
+                bool written;
+                {
+                    std::lock_guard<std::mutex> fileLock(fileMutex);
+                    written = file && std::fwrite(group.data(), 1, group.size(), file) == group.size() && syncToDisk(file);
+                }
+                lock.lock();
+                failed = failed || !written;
+                durableLsn = groupLsn;
+                flushCompleted.notify_all();
+            }
+            if (stopping && pending.empty()) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit WriteAheadLog(std::chrono::milliseconds groupCommitInterval = std::chrono::milliseconds(2))
+        : groupCommitInterval(groupCommitInterval) {}
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() {
+        if (flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            flushRequested.notify_all();
+            flusher.join();
+        }
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    // Opens the log for appending. validBytes is what replay() accepted; any
+    // torn record after it is cut off so new records follow the good prefix.
+    bool open(const std::string& logPath, size_t validBytes, uint64_t firstLsn) {
+        path = logPath;
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            std::filesystem::resize_file(path, validBytes, error);
+            if (error) {
+                return false;
+            }
+        }
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            return false;
+        }
+        nextLsn = firstLsn;
+        durableLsn = firstLsn - 1;
+        flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+        return true;
+    }
+
+    uint64_t append(WalRecordType type, const std::vector<char>& payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t lsn = nextLsn++;
+        size_t recordStart = pending.size();
+        BinaryWriter writer(pending);
+        writer.write(static_cast<uint32_t>(payload.size()));
+        writer.write(lsn);
+        writer.write(static_cast<uint8_t>(type));
+        pending.insert(pending.end(), payload.begin(), payload.end());
+        size_t checkedStart = recordStart + sizeof(uint32_t);
+        writer.write(checksum(pending.data() + checkedStart, pending.size() - checkedStart));
+        flushRequested.notify_one();
+        return lsn;
+    }
+
+    // Blocks until every record up to lsn is on disk. Returns false if a
+    // group write has failed since the log was opened.
+    bool waitDurable(uint64_t lsn) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (durableLsn < lsn) {
+            syncRequested = true;
+            flushRequested.notify_one();
+            flushCompleted.wait(lock, [this, lsn]() { return durableLsn >= lsn; });
+        }
+        return !failed;
+    }
+
+    // Makes everything appended so far durable and returns the last lsn.
+    uint64_t sync() {
+        uint64_t lastLsn;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lastLsn = nextLsn - 1;
+        }
+        waitDurable(lastLsn);
+        return lastLsn;
+    }
+
+    // Drops every record up to and including lsn; used once a snapshot
+    // covers them. Records appended meanwhile are kept: the surviving tail is
+    // copied to a temp file that is renamed over the log, so a crash leaves
+    // either the old log or the new one. Safe to call from another thread
+    // while appends continue. LSNs keep counting.
+    bool truncateThrough(uint64_t lsn) {
+        waitDurable(lsn);
+        std::lock_guard<std::mutex> fileLock(fileMutex);
+        if (!file || std::fflush(file) != 0) {
+            return false;
+        }
+        std::vector<char> tail;
+        {
+            MappedFile mapped;
+            if (!mapped.open(path)) {
+                return false;
+            }
+            const char* data = mapped.getData();
+            size_t size = mapped.getSize();
+            size_t offset = 0;
+            uint64_t recordLsn = 0;
+            for (size_t recordSize; (recordSize = recordSizeAt(data, size, offset, recordLsn)) > 0 && recordLsn <= lsn;) {
+                offset += recordSize;
+            }
+            tail.assign(data + offset, data + size);
+        }
+
+        std::string tempPath = path + ".tmp";
+        std::FILE* tempFile = std::fopen(tempPath.c_str(), "wb");
+        if (!tempFile) {
+            return false;
+        }
+        bool written = std::fwrite(tail.data(), 1, tail.size(), tempFile) == tail.size() && syncToDisk(tempFile);
+        std::fclose(tempFile);
+        if (!written) {
+            return false;
+        }
+        // Closed first, since some platforms cannot rename over an open file.
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        file = std::fopen(path.c_str(), "ab");
+        return file && !error;
+    }
+
+    // Feeds every intact record to apply(lsn, type, payloadReader) and returns
+    // the length of the valid prefix. Stops at the first torn or corrupt record.
+    template <typename Apply>
+    static size_t replay(const std::string& logPath, Apply apply) {
+        MappedFile mapped;
+        if (!mapped.open(logPath)) {
+            return 0;
+        }
+        const char* data = mapped.getData();
+        size_t size = mapped.getSize();
+        size_t offset = 0;
+        uint64_t lsn = 0;
+        for (size_t recordSize; (recordSize = recordSizeAt(data, size, offset, lsn)) > 0; offset += recordSize) {
+            BinaryReader header(data + offset + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint8_t));
+            WalRecordType type = static_cast<WalRecordType>(header.read<uint8_t>());
+            BinaryReader payload(data + offset + HEADER_SIZE, recordSize - HEADER_SIZE - sizeof(uint32_t));
+            apply(lsn, type, payload);
+        }
+        return offset;
+    }
+
+private:
+    static constexpr size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint8_t);
+
+    // Size of the intact record at offset (and its lsn), or 0 if the record
+    // there is torn or corrupt or the data ends.
+    static size_t recordSizeAt(const char* data, size_t size, size_t offset, uint64_t& lsn) {
+        if (size - offset < HEADER_SIZE + sizeof(uint32_t)) {
+            return 0;
+        }
+        BinaryReader header(data + offset, HEADER_SIZE);
+        uint32_t payloadSize = header.read<uint32_t>();
+        lsn = header.read<uint64_t>();
+        if (size - offset - HEADER_SIZE - sizeof(uint32_t) < payloadSize) {
+            return 0;
+        }
+        const char* checked = data + offset + sizeof(uint32_t);
+        size_t checkedSize = sizeof(uint64_t) + sizeof(uint8_t) + payloadSize;
+        BinaryReader trailer(checked + checkedSize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(checked, checkedSize)) {
+            return 0;
+        }
+        return HEADER_SIZE + payloadSize + sizeof(uint32_t);
+    }
+};
+
+#endif // WRITEAHEADLOG_H
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <chrono>
 #include <random>
@@ -8,23 +9,180 @@
 #include <memory>
 #include <iomanip>
 #include <sstream>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <optional>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <iterator>
+#include <utility>
+#include <tuple>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // PaymentProcessor.h
 class PaymentProcessor {
 public:
     virtual ~PaymentProcessor() = default;
     virtual bool processPayment(double amount) = 0;
+
+    virtual std::vector<bool> processPayments(const std::vector<double>& amounts) {
+        std::vector<bool> results;
+        results.reserve(amounts.size());
+        for (double amount : amounts) {
+            results.push_back(processPayment(amount));
+        }
+        return results;
+    }
 };
 
 // CreditCardPaymentProcessor.h
 class CreditCardPaymentProcessor : public PaymentProcessor {
 public:
     bool processPayment(double amount) override {
-        std::cout << "Processing credit card payment of amount: " << amount << std::endl;
+        std::cout << "Processing credit card payment of amount: " << amount << '\n';
         return true;
     }
 };
 
+// AsyncPaymentPipeline.h
+// Decouples booking threads from gateway round trips. Charges are queued and
+// picked up by a pool of workers, each of which waits up to maxBatchDelay for
+// up to maxBatchSize charges and sends them in one processPayments() call.
+// Results come back through a future or a completion callback, which runs on
+// a worker thread.
+class AsyncPaymentPipeline {
+private:
+    struct PaymentRequest {
+        double amount;
+        std::promise<bool> result;
+        std::function<void(bool)> callback;
+    };
+
+    PaymentProcessor& processor;
+    size_t maxBatchSize;
+    std::chrono::microseconds maxBatchDelay;
+
+    mutable std::mutex mutex;
+    std::condition_variable queueNotEmpty;
+    std::deque<PaymentRequest> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void enqueue(PaymentRequest request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(request));
+        }
+        queueNotEmpty.notify_one();
+    }
+
+    void workerLoop() {
+        std::vector<PaymentRequest> batch;
+        std::vector<double> amounts;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queueNotEmpty.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                auto deadline = std::chrono::steady_clock::now() + maxBatchDelay;
+                while (!stopping && queue.size() < maxBatchSize &&
+                       queueNotEmpty.wait_until(lock, deadline) == std::cv_status::no_timeout) {
+                }
+                size_t count = std::min(queue.size(), maxBatchSize);
+                for (size_t i = 0; i < count; ++i) {
+                    batch.push_back(std::move(queue.front()));
+                    queue.pop_front();
+                }
+            }
+            if (batch.empty()) {
+                continue;
+            }
+
+            for (const PaymentRequest& request : batch) {
+                amounts.push_back(request.amount);
+            }
+            std::vector<bool> results;
+            try {
+                results = processor.processPayments(amounts);
+            } catch (...) {
+                results.clear();
+            }
+            results.resize(batch.size(), false);
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (batch[i].callback) {
+                    batch[i].callback(results[i]);
+                } else {
+                    batch[i].result.set_value(results[i]);
+                }
+            }
+            batch.clear();
+            amounts.clear();
+        }
+    }
+
+public:
+    AsyncPaymentPipeline(PaymentProcessor& processor, size_t workerCount = 4, size_t maxBatchSize = 32,
+                         std::chrono::microseconds maxBatchDelay = std::chrono::microseconds(500))
+        : processor(processor), maxBatchSize(std::max<size_t>(1, maxBatchSize)), maxBatchDelay(maxBatchDelay) {
+        for (size_t i = 0; i < std::max<size_t>(1, workerCount); ++i) {
+            workers.emplace_back(&AsyncPaymentPipeline::workerLoop, this);
+        }
+    }
+
+    AsyncPaymentPipeline(const AsyncPaymentPipeline&) = delete;
+    AsyncPaymentPipeline& operator=(const AsyncPaymentPipeline&) = delete;
+
+    // Charges still queued at shutdown are processed before the workers exit.
+    ~AsyncPaymentPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queueNotEmpty.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    std::future<bool> submit(double amount) {
+        PaymentRequest request{amount, std::promise<bool>(), nullptr};
+        std::future<bool> result = request.result.get_future();
+        enqueue(std::move(request));
+        return result;
+    }
+
+    void submit(double amount, std::function<void(bool)> callback) {
+        enqueue(PaymentRequest{amount, std::promise<bool>(), std::move(callback)});
+    }
+
+    size_t pendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+};
+
 // Car.h
 class Car {
 private:
@@ -45,6 +203,7 @@ public:
     std::string getLicensePlate() const { return licensePlate; }
     std::string getMake() const { return make; }
     std::string getModel() const { return model; }
+    int getYear() const { return year; }
     bool isAvailable() const { return available; }
     void setAvailable(bool available) { this->available = available; }
 };
@@ -77,115 +236,1963 @@ private:
     std::chrono::system_clock::time_point endDate;
     double totalPrice;
 
-    double calculateTotalPrice() const {
+public:
+    static double calculateTotalPrice(const Car& car, const std::chrono::system_clock::time_point& startDate,
+                                      const std::chrono::system_clock::time_point& endDate) {
         auto duration = std::chrono::duration_cast<std::chrono::hours>(endDate - startDate).count() / 24 + 1;
         return car.getRentalPricePerDay() * duration;
     }
 
-public:
     Reservation() : reservationId(""), customer(), car(), startDate(), endDate(), totalPrice(0.0) {}
 
     Reservation(std::string reservationId, Customer customer, Car car,
                 std::chrono::system_clock::time_point startDate, std::chrono::system_clock::time_point endDate)
         : reservationId(reservationId), customer(customer), car(car),
-          startDate(startDate), endDate(endDate), totalPrice(calculateTotalPrice()) {}
+          startDate(startDate), endDate(endDate), totalPrice(calculateTotalPrice(car, startDate, endDate)) {}
+
+    Reservation(std::string reservationId, Customer customer, Car car,
+                std::chrono::system_clock::time_point startDate, std::chrono::system_clock::time_point endDate,
+                double totalPrice)
+        : reservationId(reservationId), customer(customer), car(car),
+          startDate(startDate), endDate(endDate), totalPrice(totalPrice) {}
 
     std::chrono::system_clock::time_point getStartDate() const { return startDate; }
     std::chrono::system_clock::time_point getEndDate() const { return endDate; }
-    Car getCar() const { return car; }
+    const Car& getCar() const { return car; }
+    const Customer& getCustomer() const { return customer; }
     double getTotalPrice() const { return totalPrice; }
     std::string getReservationId() const { return reservationId; }
 };
 
-// RentalSystem.h
-class RentalSystem {
+// ReservationStore.h
+using CarHandle = uint32_t;
+using CustomerHandle = uint32_t;
+using ReservationHandle = uint32_t;
+
+constexpr uint32_t INVALID_HANDLE = UINT32_MAX;
+
+// One booking in 40 bytes: dense handles instead of embedded Car/Customer
+// copies, and dates as raw system_clock ticks. The reservation id is
+// "RES" + reservationNumber. A free slot has car == INVALID_HANDLE.
+struct ReservationRecord {
+    int64_t startEpoch;
+    int64_t endEpoch;
+    double totalPrice;
+    uint64_t reservationNumber;
+    CarHandle car;
+    CustomerHandle customer;
+};
+
+// Contiguous reservation storage plus the registries that hand out car and
+// customer handles. Cancelled slots are recycled, so handles stay dense.
+class ReservationStore {
 private:
-    static RentalSystem* instance;
-    std::unordered_map<std::string, Car> cars;
-    std::unordered_map<std::string, Reservation> reservations;
-    std::unique_ptr<PaymentProcessor> paymentProcessor;
+    std::vector<ReservationRecord> records;
+    std::vector<ReservationHandle> freeSlots;
+    std::unordered_map<uint64_t, ReservationHandle> handleByNumber;
+    std::vector<Car> carsByHandle;
+    std::unordered_map<std::string, CarHandle> carHandles;
+    std::vector<Customer> customersByHandle;
+    std::unordered_map<std::string, CustomerHandle> customerHandles;
 
-    RentalSystem() : paymentProcessor(std::make_unique<CreditCardPaymentProcessor>()) {}
+public:
+    static int64_t toEpoch(const std::chrono::system_clock::time_point& timePoint) {
+        return timePoint.time_since_epoch().count();
+    }
+
+    static std::chrono::system_clock::time_point fromEpoch(int64_t epoch) {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(epoch));
+    }
+
+    static std::string formatReservationId(uint64_t reservationNumber) {
+        return "RES" + std::to_string(reservationNumber);
+    }
+
+    static bool parseReservationId(const std::string& reservationId, uint64_t& reservationNumber) {
+        if (reservationId.size() <= 3 || reservationId.compare(0, 3, "RES") != 0) {
+            return false;
+        }
+        char* end = nullptr;
+        reservationNumber = std::strtoull(reservationId.c_str() + 3, &end, 10);
+        return *end == '\0';
+    }
+
+    CarHandle internCar(const Car& car) {
+        auto [it, inserted] = carHandles.emplace(car.getLicensePlate(), static_cast<CarHandle>(carsByHandle.size()));
+        if (inserted) {
+            carsByHandle.push_back(car);
+        } else {
+            carsByHandle[it->second] = car;
+        }
+        return it->second;
+    }
+
+    CarHandle findCar(const std::string& licensePlate) const {
+        auto it = carHandles.find(licensePlate);
+        return it == carHandles.end() ? INVALID_HANDLE : it->second;
+    }
+
+    CustomerHandle internCustomer(const Customer& customer) {
+        auto [it, inserted] = customerHandles.emplace(customer.getDriversLicenseNumber(),
+                                                      static_cast<CustomerHandle>(customersByHandle.size()));
+        if (inserted) {
+            customersByHandle.push_back(customer);
+        } else {
+            customersByHandle[it->second] = customer;
+        }
+        return it->second;
+    }
+
+    bool contains(uint64_t reservationNumber) const {
+        return handleByNumber.count(reservationNumber) != 0;
+    }
+
+    ReservationHandle add(uint64_t reservationNumber, CarHandle car, CustomerHandle customer,
+                          int64_t startEpoch, int64_t endEpoch, double totalPrice) {
+        ReservationRecord record{startEpoch, endEpoch, totalPrice, reservationNumber, car, customer};
+        ReservationHandle handle;
+        if (!freeSlots.empty()) {
+            handle = freeSlots.back();
+            freeSlots.pop_back();
+            records[handle] = record;
+        } else {
+            handle = static_cast<ReservationHandle>(records.size());
+            records.push_back(record);
+        }
+        handleByNumber[reservationNumber] = handle;
+        return handle;
+    }
+
+    void remove(ReservationHandle handle) {
+        handleByNumber.erase(records[handle].reservationNumber);
+        records[handle].car = INVALID_HANDLE;
+        freeSlots.push_back(handle);
+    }
+
+    ReservationHandle find(uint64_t reservationNumber) const {
+        auto it = handleByNumber.find(reservationNumber);
+        return it == handleByNumber.end() ? INVALID_HANDLE : it->second;
+    }
+
+    ReservationHandle find(const std::string& reservationId) const {
+        uint64_t reservationNumber = 0;
+        if (!parseReservationId(reservationId, reservationNumber)) {
+            return INVALID_HANDLE;
+        }
+        return find(reservationNumber);
+    }
+
+    const ReservationRecord& get(ReservationHandle handle) const { return records[handle]; }
+    const Car& getCar(CarHandle handle) const { return carsByHandle[handle]; }
+    const Customer& getCustomer(CustomerHandle handle) const { return customersByHandle[handle]; }
+
+    // Raw storage, including free slots, for snapshots and bulk scans.
+    const std::vector<ReservationRecord>& getRecords() const { return records; }
+    const std::vector<Car>& getRegisteredCars() const { return carsByHandle; }
+    const std::vector<Customer>& getRegisteredCustomers() const { return customersByHandle; }
+
+    // Builds the full Reservation object for callers outside the hot path.
+    Reservation materialize(ReservationHandle handle) const {
+        const ReservationRecord& record = records[handle];
+        return Reservation(formatReservationId(record.reservationNumber), customersByHandle[record.customer],
+                           carsByHandle[record.car], fromEpoch(record.startEpoch), fromEpoch(record.endEpoch),
+                           record.totalPrice);
+    }
+};
+
+// ReservationIndex.h
+// Per-car sorted interval index. Reservations of one car never overlap, so
+// ordering them by (start, end) also orders their end dates, and an overlap
+// query only has to look at the last interval starting before the query end.
+// A multiset because two empty bookings at the same instant do not overlap.
+class ReservationIndex {
+private:
+    struct Interval {
+        int64_t start;
+        int64_t end;
+        ReservationHandle reservation;
+
+        bool operator<(const Interval& other) const {
+            if (start != other.start) return start < other.start;
+            return end < other.end;
+        }
+    };
+
+    // Free gaps between consecutive bookings, keyed by (length class, start)
+    // where the class is floor(log2(length)). Open-ended gaps before the first
+    // and after the last booking use the int64 limits and the top class.
+    using GapKey = std::pair<int, int64_t>;
+
+    struct CarSchedule {
+        std::multiset<Interval> intervals;
+        std::map<GapKey, int64_t> gaps;
+    };
+
+    std::vector<CarSchedule> schedules;
+
+    static int64_t gapLength(int64_t start, int64_t end) {
+        if (start == std::numeric_limits<int64_t>::min() || end == std::numeric_limits<int64_t>::max()) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        return end - start;
+    }
+
+    static int lengthClass(int64_t length) {
+        int lengthClass = 0;
+        for (uint64_t rest = static_cast<uint64_t>(length); rest > 1; rest >>= 1) {
+            ++lengthClass;
+        }
+        return lengthClass;
+    }
+
+    static void addGap(CarSchedule& schedule, int64_t start, int64_t end) {
+        if (start < end) {
+            schedule.gaps.emplace(GapKey{lengthClass(gapLength(start, end)), start}, end);
+        }
+    }
+
+    static void removeGap(CarSchedule& schedule, int64_t start, int64_t end) {
+        if (start < end) {
+            schedule.gaps.erase(GapKey{lengthClass(gapLength(start, end)), start});
+        }
+    }
+
+    // The gap an interval at `it` sits in: from the end of the booking before
+    // it to the start of the booking after it.
+    static std::pair<int64_t, int64_t> surroundingGap(const std::multiset<Interval>& intervals,
+                                                      std::multiset<Interval>::const_iterator it) {
+        int64_t gapStart = it == intervals.begin() ? std::numeric_limits<int64_t>::min() : std::prev(it)->end;
+        auto next = std::next(it);
+        int64_t gapEnd = next == intervals.end() ? std::numeric_limits<int64_t>::max() : next->start;
+        return {gapStart, gapEnd};
+    }
 
 public:
-    static RentalSystem* getInstance() {
-        if (!instance) {
-            instance = new RentalSystem();
+    bool overlaps(CarHandle car, int64_t startEpoch, int64_t endEpoch) const {
+        if (car >= schedules.size() || schedules[car].intervals.empty()) {
+            return false;
+        }
+        const auto& intervals = schedules[car].intervals;
+        auto it = intervals.lower_bound(Interval{endEpoch, std::numeric_limits<int64_t>::min(), 0});
+        if (it == intervals.begin()) {
+            return false;
         }
-        return instance;
+        --it;
+        return startEpoch < it->end;
     }
 
-    void addCar(const Car& car) {
-        cars[car.getLicensePlate()] = car;
+    void insert(CarHandle car, int64_t startEpoch, int64_t endEpoch, ReservationHandle reservation) {
+        if (car >= schedules.size()) {
+            schedules.resize(car + 1);
+        }
+        CarSchedule& schedule = schedules[car];
+        auto it = schedule.intervals.insert(Interval{startEpoch, endEpoch, reservation});
+        auto [gapStart, gapEnd] = surroundingGap(schedule.intervals, it);
+        removeGap(schedule, gapStart, gapEnd);
+        addGap(schedule, gapStart, startEpoch);
+        addGap(schedule, endEpoch, gapEnd);
     }
 
-    void removeCar(const std::string& licensePlate) {
-        cars.erase(licensePlate);
+    void erase(CarHandle car, int64_t startEpoch, int64_t endEpoch) {
+        if (car >= schedules.size()) {
+            return;
+        }
+        CarSchedule& schedule = schedules[car];
+        auto it = schedule.intervals.find(Interval{startEpoch, endEpoch, 0});
+        if (it != schedule.intervals.end()) {
+            auto [gapStart, gapEnd] = surroundingGap(schedule.intervals, it);
+            removeGap(schedule, gapStart, startEpoch);
+            removeGap(schedule, endEpoch, gapEnd);
+            addGap(schedule, gapStart, gapEnd);
+            schedule.intervals.erase(it);
+        }
     }
 
-    std::vector<Car> searchCars(const std::string& make, const std::string& model,
-                                const std::chrono::system_clock::time_point& startDate,
-                                const std::chrono::system_clock::time_point& endDate) {
-        std::vector<Car> availableCars;
-        for (const auto& [licensePlate, car] : cars) {
-            if (car.getMake() == make && car.getModel() == model && car.isAvailable()) {
-                if (isCarAvailable(car, startDate, endDate)) {
-                    availableCars.push_back(car);
+    // Earliest s >= notBefore such that [s, s + length) overlaps no booking of
+    // the car. Either notBefore itself fits, or the answer is the start of the
+    // first long-enough gap after it: one lookup per length class.
+    int64_t earliestFreeStart(CarHandle car, int64_t notBefore, int64_t length) const {
+        if (!overlaps(car, notBefore, notBefore + length)) {
+            return notBefore;
+        }
+        const auto& gaps = schedules[car].gaps;
+        int64_t best = std::numeric_limits<int64_t>::max();
+        for (int gapClass = lengthClass(length); gapClass < 64; ++gapClass) {
+            for (auto it = gaps.lower_bound(GapKey{gapClass, notBefore});
+                 it != gaps.end() && it->first.first == gapClass && it->first.second < best; ++it) {
+                if (gapLength(it->first.second, it->second) >= length) {
+                    best = it->first.second;
+                    break;
                 }
             }
         }
-        return availableCars;
+        return best;
     }
 
-    bool isCarAvailable(const Car& car, const std::chrono::system_clock::time_point& startDate,
-                        const std::chrono::system_clock::time_point& endDate) {
-        for (const auto& [reservationId, reservation] : reservations) {
-            if (reservation.getCar().getLicensePlate() == car.getLicensePlate()) {
-                auto resStart = reservation.getStartDate();
-                auto resEnd = reservation.getEndDate();
-                if (startDate < resEnd && endDate > resStart) {
-                    return false;
-                }
+    // Calls visit(start, end, reservation) for every interval of the car that
+    // touches [startEpoch, endEpoch], endpoints included.
+    template <typename Visit>
+    void forEachTouching(CarHandle car, int64_t startEpoch, int64_t endEpoch, Visit visit) const {
+        if (car >= schedules.size()) {
+            return;
+        }
+        const auto& intervals = schedules[car].intervals;
+        auto it = intervals.lower_bound(Interval{startEpoch, std::numeric_limits<int64_t>::min(), 0});
+        while (it != intervals.begin() && std::prev(it)->end >= startEpoch) {
+            --it;
+        }
+        for (; it != intervals.end() && it->start <= endEpoch; ++it) {
+            visit(it->start, it->end, it->reservation);
+        }
+    }
+
+    std::vector<ReservationHandle> reservationsOf(CarHandle car) const {
+        std::vector<ReservationHandle> result;
+        if (car < schedules.size()) {
+            for (const Interval& interval : schedules[car].intervals) {
+                result.push_back(interval.reservation);
             }
         }
-        return true;
+        return result;
     }
+};
 
-    Reservation* makeReservation(const Customer& customer, const Car& car,
-                                 const std::chrono::system_clock::time_point& startDate,
-                                 const std::chrono::system_clock::time_point& endDate) {
-        if (isCarAvailable(car, startDate, endDate)) {
-            std::string reservationId = generateReservationId();
-            Reservation reservation(reservationId, customer, car, startDate, endDate);
-            reservations[reservationId] = reservation;
-            const_cast<Car&>(car).setAvailable(false);
-            return &reservations[reservationId];
+// ReservationColumns.h
+// Live reservations as one array per field, for reports that scan every
+// booking. Rows are dense: a cancelled booking's row is filled with the last
+// row, so a scan never has to skip free slots. Makes are interned to small ids
+// when a booking is added.
+class ReservationColumns {
+private:
+    std::vector<CarHandle> cars;
+    std::vector<uint32_t> makes;
+    std::vector<int64_t> startEpochs;
+    std::vector<int64_t> endEpochs;
+    std::vector<double> totalPrices;
+    std::vector<ReservationHandle> handles;
+    std::vector<uint32_t> rowByHandle;
+    std::vector<std::string> makeNames;
+    std::unordered_map<std::string, uint32_t> makeIds;
+
+public:
+    void add(ReservationHandle handle, const ReservationRecord& record, const std::string& make) {
+        auto [it, inserted] = makeIds.emplace(make, static_cast<uint32_t>(makeNames.size()));
+        if (inserted) {
+            makeNames.push_back(make);
+        }
+        if (handle >= rowByHandle.size()) {
+            rowByHandle.resize(handle + 1, INVALID_HANDLE);
         }
-        return nullptr;
+        rowByHandle[handle] = static_cast<uint32_t>(handles.size());
+        cars.push_back(record.car);
+        makes.push_back(it->second);
+        startEpochs.push_back(record.startEpoch);
+        endEpochs.push_back(record.endEpoch);
+        totalPrices.push_back(record.totalPrice);
+        handles.push_back(handle);
     }
 
-    void cancelReservation(const std::string& reservationId) {
-        auto it = reservations.find(reservationId);
-        if (it != reservations.end()) {
-            Reservation& reservation = it->second;
-            reservation.getCar().setAvailable(true);
-            reservations.erase(it);
+    void remove(ReservationHandle handle) {
+        if (handle >= rowByHandle.size() || rowByHandle[handle] == INVALID_HANDLE) {
+            return;
         }
+        uint32_t row = rowByHandle[handle];
+        uint32_t last = static_cast<uint32_t>(handles.size() - 1);
+        cars[row] = cars[last];
+        makes[row] = makes[last];
+        startEpochs[row] = startEpochs[last];
+        endEpochs[row] = endEpochs[last];
+        totalPrices[row] = totalPrices[last];
+        handles[row] = handles[last];
+        rowByHandle[handles[row]] = row;
+        rowByHandle[handle] = INVALID_HANDLE;
+        cars.pop_back();
+        makes.pop_back();
+        startEpochs.pop_back();
+        endEpochs.pop_back();
+        totalPrices.pop_back();
+        handles.pop_back();
     }
 
-    bool processPayment(const Reservation& reservation) {
-        return paymentProcessor->processPayment(reservation.getTotalPrice());
+    size_t size() const { return handles.size(); }
+
+    const std::vector<CarHandle>& getCars() const { return cars; }
+    const std::vector<uint32_t>& getMakes() const { return makes; }
+    const std::vector<int64_t>& getStartEpochs() const { return startEpochs; }
+    const std::vector<int64_t>& getEndEpochs() const { return endEpochs; }
+    const std::vector<double>& getTotalPrices() const { return totalPrices; }
+    const std::vector<std::string>& getMakeNames() const { return makeNames; }
+};
+
+// ReservationAnalytics.h
+struct DailyRevenue {
+    std::string make;
+    std::chrono::system_clock::time_point day;
+    double revenue;
+};
+
+// Reports over ReservationColumns. Each one splits the rows into one chunk
+// per thread, scans its chunk with plain loops over the columns that the
+// compiler can vectorize, and merges the per-thread partials at the end.
+class ReservationAnalytics {
+private:
+    static constexpr size_t MIN_ROWS_PER_THREAD = 1 << 16;
+    static constexpr size_t SUM_LANES = 8;
+    static constexpr size_t MAX_DENSE_REVENUE_CELLS = 1 << 20;
+
+    // Runs scan(begin, end, partial) over contiguous chunks of [0, rows), the
+    // first on the calling thread, and returns the partials in chunk order.
+    template <typename Partial, typename Scan>
+    static std::vector<Partial> parallelScan(size_t rows, unsigned threadCount, const Partial& initial, Scan scan) {
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(threadCount, rows / MIN_ROWS_PER_THREAD));
+        size_t chunkSize = (rows + chunks - 1) / chunks;
+        std::vector<Partial> partials(chunks, initial);
+        std::vector<std::thread> threads;
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            threads.emplace_back([&, chunk]() {
+                scan(std::min(rows, chunk * chunkSize), std::min(rows, (chunk + 1) * chunkSize), partials[chunk]);
+            });
+        }
+        scan(0, std::min(rows, chunkSize), partials[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return partials;
+    }
+
+    static int64_t ticksPerDay() {
+        return std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(24)).count();
+    }
+
+    static int64_t floorDay(int64_t epoch) {
+        int64_t day = epoch / ticksPerDay();
+        return (epoch % ticksPerDay() < 0) ? day - 1 : day;
+    }
+
+    // Last instant a booking occupies, so floorDay() of it is its last day.
+    static int64_t lastTick(int64_t startEpoch, int64_t endEpoch) {
+        return endEpoch > startEpoch ? endEpoch - 1 : startEpoch;
+    }
+
+    // Calls add(day, share) for every day [startEpoch, endEpoch) covers, the
+    // price split in proportion to the time booked on each day. An empty
+    // booking puts all of it on its start day.
+    template <typename Add>
+    static void spreadOverDays(int64_t startEpoch, int64_t endEpoch, double price, Add add) {
+        int64_t day = floorDay(startEpoch);
+        if (endEpoch <= startEpoch) {
+            add(day, price);
+            return;
+        }
+        double perTick = price / static_cast<double>(endEpoch - startEpoch);
+        for (int64_t dayStart = day * ticksPerDay(); dayStart < endEpoch; ++day, dayStart += ticksPerDay()) {
+            int64_t booked = std::min(endEpoch, dayStart + ticksPerDay()) - std::max(startEpoch, dayStart);
+            add(day, perTick * static_cast<double>(booked));
+        }
+    }
+
+public:
+    static unsigned defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Mean booking length in system_clock ticks, or 0 without bookings. Sums
+    // in SUM_LANES independent doubles so the loop needs no reassociation.
+    static double averageRentalLength(const ReservationColumns& columns, unsigned threadCount = defaultThreadCount()) {
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        auto partials = parallelScan(columns.size(), threadCount, 0.0, [&](size_t begin, size_t end, double& total) {
+            double lanes[SUM_LANES] = {};
+            size_t row = begin;
+            for (; row + SUM_LANES <= end; row += SUM_LANES) {
+                for (size_t lane = 0; lane < SUM_LANES; ++lane) {
+                    lanes[lane] += static_cast<double>(ends[row + lane] - starts[row + lane]);
+                }
+            }
+            for (; row < end; ++row) {
+                lanes[0] += static_cast<double>(ends[row] - starts[row]);
+            }
+            for (double lane : lanes) {
+                total += lane;
+            }
+        });
+        double total = 0;
+        for (double partial : partials) {
+            total += partial;
+        }
+        return columns.size() == 0 ? 0 : total / static_cast<double>(columns.size());
+    }
+
+    // Share of [fromEpoch, toEpoch) each car is booked for, indexed by car
+    // handle. Bookings of one car never overlap, so the clipped lengths add up.
+    static std::vector<double> utilizationPerCar(const ReservationColumns& columns, size_t carCount,
+                                                 int64_t fromEpoch, int64_t toEpoch,
+                                                 unsigned threadCount = defaultThreadCount()) {
+        std::vector<double> utilization(carCount, 0);
+        if (toEpoch <= fromEpoch) {
+            return utilization;
+        }
+        const CarHandle* cars = columns.getCars().data();
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        auto partials = parallelScan(columns.size(), threadCount, std::vector<int64_t>(),
+                                     [&](size_t begin, size_t end, std::vector<int64_t>& booked) {
+            booked.assign(carCount, 0);
+            for (size_t row = begin; row < end; ++row) {
+                int64_t clipped = std::min(ends[row], toEpoch) - std::max(starts[row], fromEpoch);
+                booked[cars[row]] += std::max<int64_t>(clipped, 0);
+            }
+        });
+        double window = static_cast<double>(toEpoch - fromEpoch);
+        for (size_t car = 0; car < carCount; ++car) {
+            int64_t booked = 0;
+            for (const std::vector<int64_t>& partial : partials) {
+                booked += partial[car];
+            }
+            utilization[car] = static_cast<double>(booked) / window;
+        }
+        return utilization;
+    }
+
+    // Revenue earned on each day, per make, ordered by make then day; days
+    // without revenue are left out. A booking's price is spread over the days
+    // it covers in proportion to the time booked on each. Uses a dense make x
+    // day grid per thread when the date range is small and a hash map
+    // otherwise.
+    static std::vector<DailyRevenue> revenueByMakePerDay(const ReservationColumns& columns,
+                                                         unsigned threadCount = defaultThreadCount()) {
+        std::vector<DailyRevenue> result;
+        if (columns.size() == 0) {
+            return result;
+        }
+        const uint32_t* makes = columns.getMakes().data();
+        const int64_t* starts = columns.getStartEpochs().data();
+        const int64_t* ends = columns.getEndEpochs().data();
+        const double* prices = columns.getTotalPrices().data();
+        const std::vector<std::string>& makeNames = columns.getMakeNames();
+
+        auto bounds = parallelScan(columns.size(), threadCount,
+                                   std::make_pair(std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()),
+                                   [&](size_t begin, size_t end, std::pair<int64_t, int64_t>& range) {
+            int64_t low = range.first;
+            int64_t high = range.second;
+            for (size_t row = begin; row < end; ++row) {
+                low = std::min(low, starts[row]);
+                high = std::max(high, lastTick(starts[row], ends[row]));
+            }
+            range = {low, high};
+        });
+        int64_t firstStart = std::numeric_limits<int64_t>::max();
+        int64_t lastBooked = std::numeric_limits<int64_t>::min();
+        for (const auto& [low, high] : bounds) {
+            firstStart = std::min(firstStart, low);
+            lastBooked = std::max(lastBooked, high);
+        }
+        int64_t firstDay = floorDay(firstStart);
+        size_t dayCount = static_cast<size_t>(floorDay(lastBooked) - firstDay + 1);
+        size_t makeCount = makeNames.size();
+
+        std::vector<std::unordered_map<uint64_t, double>> revenueByDay(makeCount);
+        if (dayCount <= MAX_DENSE_REVENUE_CELLS / std::max<size_t>(makeCount, 1)) {
+            auto partials = parallelScan(columns.size(), threadCount, std::vector<double>(),
+                                         [&](size_t begin, size_t end, std::vector<double>& grid) {
+                grid.assign(makeCount * dayCount, 0);
+                for (size_t row = begin; row < end; ++row) {
+                    double* makeRow = grid.data() + makes[row] * dayCount;
+                    spreadOverDays(starts[row], ends[row], prices[row], [&](int64_t day, double share) {
+                        makeRow[static_cast<size_t>(day - firstDay)] += share;
+                    });
+                }
+            });
+            for (size_t make = 0; make < makeCount; ++make) {
+                for (size_t day = 0; day < dayCount; ++day) {
+                    double revenue = 0;
+                    for (const std::vector<double>& grid : partials) {
+                        revenue += grid[make * dayCount + day];
+                    }
+                    if (revenue != 0) {
+                        revenueByDay[make][day] = revenue;
+                    }
+                }
+            }
+        } else {
+            auto partials = parallelScan(columns.size(), threadCount, std::unordered_map<uint64_t, double>(),
+                                         [&](size_t begin, size_t end, std::unordered_map<uint64_t, double>& revenue) {
+                for (size_t row = begin; row < end; ++row) {
+                    uint64_t make = static_cast<uint64_t>(makes[row]) << 40;
+                    spreadOverDays(starts[row], ends[row], prices[row], [&](int64_t day, double share) {
+                        revenue[make | static_cast<uint64_t>(day - firstDay)] += share;
+                    });
+                }
+            });
+            for (const auto& partial : partials) {
+                for (const auto& [key, revenue] : partial) {
+                    revenueByDay[key >> 40][key & ((uint64_t(1) << 40) - 1)] += revenue;
+                }
+            }
+        }
+
+        std::vector<size_t> makeOrder(makeCount);
+        for (size_t make = 0; make < makeCount; ++make) {
+            makeOrder[make] = make;
+        }
+        std::sort(makeOrder.begin(), makeOrder.end(), [&](size_t a, size_t b) { return makeNames[a] < makeNames[b]; });
+        for (size_t make : makeOrder) {
+            std::vector<std::pair<uint64_t, double>> days(revenueByDay[make].begin(), revenueByDay[make].end());
+            std::sort(days.begin(), days.end());
+            for (const auto& [day, revenue] : days) {
+                if (revenue == 0) {
+                    continue;
+                }
+                auto dayStart = std::chrono::system_clock::time_point(
+                    std::chrono::system_clock::duration((firstDay + static_cast<int64_t>(day)) * ticksPerDay()));
+                result.push_back(DailyRevenue{makeNames[make], dayStart, revenue});
+            }
+        }
+        return result;
     }
+};
+
+// CarIndex.h
+struct CarSearchQuery {
+    std::string make;
+    std::string model;
+    std::chrono::system_clock::time_point startDate;
+    std::chrono::system_clock::time_point endDate;
+};
 
+// Secondary indexes over the fleet. Entries point at the Car objects owned by
+// RentalSystem::cars, whose nodes stay put until the car is removed.
+class CarIndex {
 private:
-    std::string generateReservationId() {
-        static std::mt19937 rng(std::time(nullptr));
-        static std::uniform_int_distribution<int> dist(0, 99999999);
-        return "RES" + std::to_string(dist(rng));
+    std::map<std::pair<std::string, std::string>, std::vector<const Car*>> byMakeModel;
+    std::multimap<int, const Car*> byYear;
+    std::multimap<double, const Car*> byPrice;
+
+    template <typename Key>
+    static void eraseEntry(std::multimap<Key, const Car*>& index, const Key& key, const Car* car) {
+        auto range = index.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == car) {
+                index.erase(it);
+                return;
+            }
+        }
+    }
+
+public:
+    void add(const Car* car) {
+        byMakeModel[{car->getMake(), car->getModel()}].push_back(car);
+        byYear.emplace(car->getYear(), car);
+        byPrice.emplace(car->getRentalPricePerDay(), car);
+    }
+
+    void remove(const Car* car) {
+        auto it = byMakeModel.find({car->getMake(), car->getModel()});
+        if (it != byMakeModel.end()) {
+            auto& cars = it->second;
+            auto pos = std::find(cars.begin(), cars.end(), car);
+            if (pos != cars.end()) {
+                *pos = cars.back();
+                cars.pop_back();
+            }
+            if (cars.empty()) {
+                byMakeModel.erase(it);
+            }
+        }
+        eraseEntry(byYear, car->getYear(), car);
+        eraseEntry(byPrice, car->getRentalPricePerDay(), car);
+    }
+
+    const std::vector<const Car*>& findByMakeModel(const std::string& make, const std::string& model) const {
+        static const std::vector<const Car*> none;
+        auto it = byMakeModel.find({make, model});
+        return it == byMakeModel.end() ? none : it->second;
+    }
+
+    std::vector<const Car*> findByYear(int minYear, int maxYear) const {
+        std::vector<const Car*> result;
+        for (auto it = byYear.lower_bound(minYear); it != byYear.end() && it->first <= maxYear; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
+    }
+
+    std::vector<const Car*> findByPrice(double minPricePerDay, double maxPricePerDay) const {
+        std::vector<const Car*> result;
+        for (auto it = byPrice.lower_bound(minPricePerDay); it != byPrice.end() && it->first <= maxPricePerDay; ++it) {
+            result.push_back(it->second);
+        }
+        return result;
     }
 };
 
-RentalSystem* RentalSystem::instance = nullptr;
+// FleetAvailabilityBitmap.h
+// One bit per car per day over a fixed horizon, grouped by (make, model). A
+// set bit means some booking covers part of that day. Within a group the bits
+// are stored word-major (all cars' word 0, then all cars' word 1, ...), so a
+// range query is a straight OR over contiguous uint64_t columns that the
+// compiler vectorizes, instead of one interval lookup per car.
+//
+// An empty booking at midnight covers no part of any day, yet the interval
+// search still counts it against windows that strictly contain it, so it
+// blocks a range of days only if the range includes the days on both sides.
+// Bits cannot say that; such bookings are kept per car as a list of boundary
+// days and checked separately for the few cars that have any.
+class FleetAvailabilityBitmap {
+private:
+    struct ModelGroup {
+        std::vector<const Car*> cars;
+        std::vector<uint64_t> busy;
+        size_t capacity = 0;
+        // Day d here means an empty booking at the midnight starting day d.
+        std::unordered_map<const Car*, std::multiset<int64_t>> boundaryDays;
+    };
+
+    int64_t horizonStartDay;
+    size_t wordCount;
+    std::map<std::pair<std::string, std::string>, ModelGroup> groups;
+    std::unordered_map<std::string, std::pair<ModelGroup*, size_t>> slotByPlate;
+
+    void grow(ModelGroup& group) {
+        size_t capacity = std::max<size_t>(16, group.capacity * 2);
+        std::vector<uint64_t> busy(wordCount * capacity, 0);
+        for (size_t word = 0; word < wordCount; ++word) {
+            std::copy_n(group.busy.begin() + word * group.capacity, group.cars.size(), busy.begin() + word * capacity);
+        }
+        group.busy.swap(busy);
+        group.capacity = capacity;
+    }
+
+    // Clips [firstDay, endDay) to the horizon and calls apply(word, mask) for
+    // each 64-day word it touches.
+    template <typename Apply>
+    void forEachWord(int64_t firstDay, int64_t endDay, Apply apply) const {
+        int64_t first = std::max<int64_t>(firstDay - horizonStartDay, 0);
+        int64_t end = std::min<int64_t>(endDay - horizonStartDay, getHorizonDays());
+        for (int64_t day = first; day < end;) {
+            size_t word = static_cast<size_t>(day / 64);
+            int64_t wordEnd = std::min<int64_t>(end, static_cast<int64_t>(word + 1) * 64);
+            unsigned int low = static_cast<unsigned int>(day % 64);
+            unsigned int count = static_cast<unsigned int>(wordEnd - day);
+            uint64_t mask = count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1) << low;
+            apply(word, mask);
+            day = wordEnd;
+        }
+    }
+
+    void setBits(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch, bool busy) {
+        auto it = slotByPlate.find(licensePlate);
+        if (it == slotByPlate.end()) {
+            return;
+        }
+        ModelGroup& group = *it->second.first;
+        size_t slot = it->second.second;
+        int64_t firstDay = floorDay(startEpoch);
+        if (isMidnightInstant(startEpoch, endEpoch)) {
+            std::multiset<int64_t>& days = group.boundaryDays[group.cars[slot]];
+            if (busy) {
+                days.insert(firstDay);
+            } else if (days.count(firstDay)) {
+                days.erase(days.find(firstDay));
+            }
+            if (days.empty()) {
+                group.boundaryDays.erase(group.cars[slot]);
+            }
+            return;
+        }
+        int64_t endDay = std::max(ceilDay(endEpoch), firstDay + 1);
+        forEachWord(firstDay, endDay, [&](size_t word, uint64_t mask) {
+            uint64_t& bits = group.busy[word * group.capacity + slot];
+            bits = busy ? (bits | mask) : (bits & ~mask);
+        });
+    }
+
+    // True if an empty midnight booking of car falls strictly inside
+    // [firstDay, endDay), i.e. between two days of the range.
+    static bool hasBoundaryDayWithin(const ModelGroup& group, const Car* car, int64_t firstDay, int64_t endDay) {
+        if (group.boundaryDays.empty()) {
+            return false;
+        }
+        auto it = group.boundaryDays.find(car);
+        if (it == group.boundaryDays.end()) {
+            return false;
+        }
+        auto day = it->second.upper_bound(firstDay);
+        return day != it->second.end() && *day < endDay;
+    }
+
+public:
+    static int64_t ticksPerDay() {
+        return std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(24)).count();
+    }
+
+    static int64_t floorDay(int64_t epoch) {
+        int64_t day = epoch / ticksPerDay();
+        return (epoch % ticksPerDay() < 0) ? day - 1 : day;
+    }
+
+    static int64_t ceilDay(int64_t epoch) {
+        int64_t day = floorDay(epoch);
+        return day * ticksPerDay() == epoch ? day : day + 1;
+    }
+
+    // An empty booking exactly at midnight; it sets no day bits.
+    static bool isMidnightInstant(int64_t startEpoch, int64_t endEpoch) {
+        return startEpoch == endEpoch && floorDay(startEpoch) * ticksPerDay() == startEpoch;
+    }
+
+    FleetAvailabilityBitmap(int64_t horizonStartDay, size_t horizonDays)
+        : horizonStartDay(horizonStartDay), wordCount((horizonDays + 63) / 64) {}
+
+    int64_t getHorizonStartDay() const { return horizonStartDay; }
+    int64_t getHorizonDays() const { return static_cast<int64_t>(wordCount * 64); }
+
+    bool covers(int64_t firstDay, int64_t endDay) const {
+        return firstDay >= horizonStartDay && endDay <= horizonStartDay + getHorizonDays();
+    }
+
+    void addCar(const Car* car) {
+        ModelGroup& group = groups[{car->getMake(), car->getModel()}];
+        if (group.cars.size() == group.capacity) {
+            grow(group);
+        }
+        size_t slot = group.cars.size();
+        group.cars.push_back(car);
+        for (size_t word = 0; word < wordCount; ++word) {
+            group.busy[word * group.capacity + slot] = 0;
+        }
+        slotByPlate[car->getLicensePlate()] = {&group, slot};
+    }
+
+    void removeCar(const std::string& licensePlate) {
+        auto it = slotByPlate.find(licensePlate);
+        if (it == slotByPlate.end()) {
+            return;
+        }
+        ModelGroup& group = *it->second.first;
+        size_t slot = it->second.second;
+        group.boundaryDays.erase(group.cars[slot]);
+        size_t last = group.cars.size() - 1;
+        if (slot != last) {
+            group.cars[slot] = group.cars[last];
+            for (size_t word = 0; word < wordCount; ++word) {
+                group.busy[word * group.capacity + slot] = group.busy[word * group.capacity + last];
+            }
+            slotByPlate[group.cars[slot]->getLicensePlate()].second = slot;
+        }
+        group.cars.pop_back();
+        slotByPlate.erase(it);
+    }
+
+    // Marks every day that [startEpoch, endEpoch) touches. An empty booking
+    // exactly at midnight is recorded as a boundary day instead, and must
+    // not be marked twice.
+    void markBusy(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch) {
+        setBits(licensePlate, startEpoch, endEpoch, true);
+    }
+
+    // Clears the days of a cancelled booking. Other bookings of the same car
+    // that share its first or last day have to be marked again by the caller.
+    void clearBusy(const std::string& licensePlate, int64_t startEpoch, int64_t endEpoch) {
+        setBits(licensePlate, startEpoch, endEpoch, false);
+    }
+
+    // Cars of the model with no booked day in [firstDay, endDay). The range
+    // must lie inside the horizon (see covers()).
+    std::vector<const Car*> findFree(const std::string& make, const std::string& model,
+                                     int64_t firstDay, int64_t endDay) const {
+        std::vector<const Car*> result;
+        auto groupIt = groups.find({make, model});
+        if (groupIt == groups.end()) {
+            return result;
+        }
+        const ModelGroup& group = groupIt->second;
+        size_t carCount = group.cars.size();
+        std::vector<uint64_t> booked(carCount, 0);
+        forEachWord(firstDay, endDay, [&](size_t word, uint64_t mask) {
+            const uint64_t* column = group.busy.data() + word * group.capacity;
+            uint64_t* accumulator = booked.data();
+            for (size_t slot = 0; slot < carCount; ++slot) {
+                accumulator[slot] |= column[slot] & mask;
+            }
+        });
+        for (size_t slot = 0; slot < carCount; ++slot) {
+            if (booked[slot] == 0 && !hasBoundaryDayWithin(group, group.cars[slot], firstDay, endDay)) {
+                result.push_back(group.cars[slot]);
+            }
+        }
+        return result;
+    }
+};
+
+// BinaryCodec.h
+// Little helpers for the fixed-layout binary files written by the logs,
+// snapshots and indexes. Values are stored in host byte order; the files are
+// meant to be read back by the same build, not exchanged between machines.
+inline uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+class BinaryWriter {
+private:
+    std::vector<char>& buffer;
+
+public:
+    explicit BinaryWriter(std::vector<char>& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    void write(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+};
+
+// Bounds-checked reader over a byte range, typically a memory-mapped file.
+// Once a read runs past the end, ok() turns false and later reads yield zeros.
+class BinaryReader {
+private:
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+    bool valid = true;
+
+public:
+    BinaryReader(const char* data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return valid; }
+    size_t position() const { return offset; }
+    size_t remaining() const { return size - offset; }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!valid || remaining() < sizeof(T)) {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t length = read<uint32_t>();
+        if (!valid || remaining() < length) {
+            valid = false;
+            return std::string();
+        }
+        std::string value(data + offset, length);
+        offset += length;
+        return value;
+    }
+};
+
+// PersistenceCodec.h
+// Layout of cars and customers in the WAL and the snapshots.
+inline void writeCar(BinaryWriter& writer, const Car& car) {
+    writer.writeString(car.getMake());
+    writer.writeString(car.getModel());
+    writer.write(static_cast<int32_t>(car.getYear()));
+    writer.writeString(car.getLicensePlate());
+    writer.write(car.getRentalPricePerDay());
+    writer.write(static_cast<uint8_t>(car.isAvailable()));
+}
+
+inline void writeCustomer(BinaryWriter& writer, const Customer& customer) {
+    writer.writeString(customer.getName());
+    writer.writeString(customer.getContactInfo());
+    writer.writeString(customer.getDriversLicenseNumber());
+}
+
+inline Car readCar(BinaryReader& reader) {
+    std::string make = reader.readString();
+    std::string model = reader.readString();
+    int year = reader.read<int32_t>();
+    std::string licensePlate = reader.readString();
+    double rentalPricePerDay = reader.read<double>();
+    bool available = reader.read<uint8_t>() != 0;
+    Car car(make, model, year, licensePlate, rentalPricePerDay);
+    car.setAvailable(available);
+    return car;
+}
+
+inline Customer readCustomer(BinaryReader& reader) {
+    std::string name = reader.readString();
+    std::string contactInfo = reader.readString();
+    std::string driversLicenseNumber = reader.readString();
+    return Customer(name, contactInfo, driversLicenseNumber);
+}
+
+// MappedFile.h
+// Read-only view of a whole file. Uses mmap where available so snapshots and
+// catalog dumps are parsed straight from the page cache; on Windows the file
+// is read into memory.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#else
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping) {
+            munmap(mapping, size);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        buffer.resize(length > 0 ? static_cast<size_t>(length) : 0);
+        size_t read = std::fread(buffer.data(), 1, buffer.size(), file);
+        std::fclose(file);
+        data = buffer.data();
+        size = read;
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                size = 0;
+                ::close(fd);
+                return false;
+            }
+            data = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+// Pushes a stdio stream's buffered bytes all the way to stable storage.
+inline bool syncToDisk(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// WriteAheadLog.h
+enum class WalRecordType : uint8_t {
+    ADD_CAR = 1,
+    REMOVE_CAR = 2,
+    MAKE_RESERVATION = 3,
+    CANCEL_RESERVATION = 4,
+    GROUP_RESERVATION = 5
+};
+
+// Append-only binary log. Each record is
+//   [u32 payload length][u64 lsn][u8 type][payload][u32 checksum]
+// Appends only copy into an in-memory group; a background thread writes and
+// fsyncs the whole group at once (group commit), every groupCommitInterval or
+// sooner when someone waits for durability.
+class WriteAheadLog {
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    std::chrono::milliseconds groupCommitInterval;
+
+    std::mutex mutex;
+    std::condition_variable flushRequested;
+    std::condition_variable flushCompleted;
+    std::mutex fileMutex;
+    std::vector<char> pending;
+    uint64_t nextLsn = 1;
+    uint64_t durableLsn = 0;
+    bool syncRequested = false;
+    bool stopping = false;
+    bool failed = false;
+    std::thread flusher;
+
+    void flusherLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            flushRequested.wait(lock, [this]() { return stopping || !pending.empty(); });
+            if (!stopping && !syncRequested) {
+                flushRequested.wait_for(lock, groupCommitInterval, [this]() { return stopping || syncRequested; });
+            }
+            if (!pending.empty()) {
+                std::vector<char> group;
+                group.swap(pending);
+                uint64_t groupLsn = nextLsn - 1;
+                syncRequested = false;
+                lock.unlock();
+                bool written;
+                {
+                    std::lock_guard<std::mutex> fileLock(fileMutex);
+                    written = file && std::fwrite(group.data(), 1, group.size(), file) == group.size() && syncToDisk(file);
+                }
+                lock.lock();
+                failed = failed || !written;
+                durableLsn = groupLsn;
+                flushCompleted.notify_all();
+            }
+            if (stopping && pending.empty()) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit WriteAheadLog(std::chrono::milliseconds groupCommitInterval = std::chrono::milliseconds(2))
+        : groupCommitInterval(groupCommitInterval) {}
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    ~WriteAheadLog() {
+        if (flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            flushRequested.notify_all();
+            flusher.join();
+        }
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    // Opens the log for appending. validBytes is what replay() accepted; any
+    // torn record after it is cut off so new records follow the good prefix.
+    bool open(const std::string& logPath, size_t validBytes, uint64_t firstLsn) {
+        path = logPath;
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            std::filesystem::resize_file(path, validBytes, error);
+            if (error) {
+                return false;
+            }
+        }
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            return false;
+        }
+        nextLsn = firstLsn;
+        durableLsn = firstLsn - 1;
+        flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+        return true;
+    }
+
+    uint64_t append(WalRecordType type, const std::vector<char>& payload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t lsn = nextLsn++;
+        size_t recordStart = pending.size();
+        BinaryWriter writer(pending);
+        writer.write(static_cast<uint32_t>(payload.size()));
+        writer.write(lsn);
+        writer.write(static_cast<uint8_t>(type));
+        pending.insert(pending.end(), payload.begin(), payload.end());
+        size_t checkedStart = recordStart + sizeof(uint32_t);
+        writer.write(checksum(pending.data() + checkedStart, pending.size() - checkedStart));
+        flushRequested.notify_one();
+        return lsn;
+    }
+
+    // Blocks until every record up to lsn is on disk. Returns false if a
+    // group write has failed since the log was opened.
+    bool waitDurable(uint64_t lsn) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (durableLsn < lsn) {
+            syncRequested = true;
+            flushRequested.notify_one();
+            flushCompleted.wait(lock, [this, lsn]() { return durableLsn >= lsn; });
+        }
+        return !failed;
+    }
+
+    // Makes everything appended so far durable and returns the last lsn.
+    uint64_t sync() {
+        uint64_t lastLsn;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lastLsn = nextLsn - 1;
+        }
+        waitDurable(lastLsn);
+        return lastLsn;
+    }
+
+    // Drops every record up to and including lsn; used once a snapshot
+    // covers them. Records appended meanwhile are kept: the surviving tail is
+    // copied to a temp file that is renamed over the log, so a crash leaves
+    // either the old log or the new one. Safe to call from another thread
+    // while appends continue. LSNs keep counting.
+    bool truncateThrough(uint64_t lsn) {
+        waitDurable(lsn);
+        std::lock_guard<std::mutex> fileLock(fileMutex);
+        if (!file || std::fflush(file) != 0) {
+            return false;
+        }
+        std::vector<char> tail;
+        {
+            MappedFile mapped;
+            if (!mapped.open(path)) {
+                return false;
+            }
+            const char* data = mapped.getData();
+            size_t size = mapped.getSize();
+            size_t offset = 0;
+            uint64_t recordLsn = 0;
+            for (size_t recordSize; (recordSize = recordSizeAt(data, size, offset, recordLsn)) > 0 && recordLsn <= lsn;) {
+                offset += recordSize;
+            }
+            tail.assign(data + offset, data + size);
+        }
+
+        std::string tempPath = path + ".tmp";
+        std::FILE* tempFile = std::fopen(tempPath.c_str(), "wb");
+        if (!tempFile) {
+            return false;
+        }
+        bool written = std::fwrite(tail.data(), 1, tail.size(), tempFile) == tail.size() && syncToDisk(tempFile);
+        std::fclose(tempFile);
+        if (!written) {
+            return false;
+        }
+        // Closed first, since some platforms cannot rename over an open file.
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        file = std::fopen(path.c_str(), "ab");
+        return file && !error;
+    }
+
+    // Feeds every intact record to apply(lsn, type, payloadReader) and returns
+    // the length of the valid prefix. Stops at the first torn or corrupt record.
+    template <typename Apply>
+    static size_t replay(const std::string& logPath, Apply apply) {
+        MappedFile mapped;
+        if (!mapped.open(logPath)) {
+            return 0;
+        }
+        const char* data = mapped.getData();
+        size_t size = mapped.getSize();
+        size_t offset = 0;
+        uint64_t lsn = 0;
+        for (size_t recordSize; (recordSize = recordSizeAt(data, size, offset, lsn)) > 0; offset += recordSize) {
+            BinaryReader header(data + offset + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint8_t));
+            WalRecordType type = static_cast<WalRecordType>(header.read<uint8_t>());
+            BinaryReader payload(data + offset + HEADER_SIZE, recordSize - HEADER_SIZE - sizeof(uint32_t));
+            apply(lsn, type, payload);
+        }
+        return offset;
+    }
+
+private:
+    static constexpr size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint8_t);
+
+    // Size of the intact record at offset (and its lsn), or 0 if the record
+    // there is torn or corrupt or the data ends.
+    static size_t recordSizeAt(const char* data, size_t size, size_t offset, uint64_t& lsn) {
+        if (size - offset < HEADER_SIZE + sizeof(uint32_t)) {
+            return 0;
+        }
+        BinaryReader header(data + offset, HEADER_SIZE);
+        uint32_t payloadSize = header.read<uint32_t>();
+        lsn = header.read<uint64_t>();
+        if (size - offset - HEADER_SIZE - sizeof(uint32_t) < payloadSize) {
+            return 0;
+        }
+        const char* checked = data + offset + sizeof(uint32_t);
+        size_t checkedSize = sizeof(uint64_t) + sizeof(uint8_t) + payloadSize;
+        BinaryReader trailer(checked + checkedSize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(checked, checkedSize)) {
+            return 0;
+        }
+        return HEADER_SIZE + payloadSize + sizeof(uint32_t);
+    }
+};
+
+// RentalSystem.h
+// A car of the requested model and the earliest window it is free for.
+struct AvailableSlot {
+    Car car;
+    std::chrono::system_clock::time_point startDate;
+    std::chrono::system_clock::time_point endDate;
+};
+
+class RentalSystem {
+private:
+    std::unordered_map<std::string, Car> cars;
+    ReservationStore reservations;
+    ReservationIndex reservationIndex;
+    ReservationColumns reservationColumns;
+    CarIndex carIndex;
+    std::unique_ptr<FleetAvailabilityBitmap> availabilityBitmap;
+    std::unique_ptr<PaymentProcessor> paymentProcessor;
+    std::unique_ptr<AsyncPaymentPipeline> paymentPipeline;
+    std::unique_ptr<WriteAheadLog> wal;
+    std::string snapshotPath;
+    size_t snapshotEveryRecords = 0;
+    size_t recordsSinceSnapshot = 0;
+    // Declared after wal so it is destroyed, and so waited for, first.
+    std::future<bool> backgroundCheckpoint;
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x31534352; // "RCS1"
+
+    RentalSystem() : paymentProcessor(std::make_unique<CreditCardPaymentProcessor>()) {}
+
+public:
+    static RentalSystem* getInstance() {
+        static RentalSystem instance;
+        return &instance;
+    }
+
+    void addCar(const Car& car) {
+        storeCar(car);
+        if (wal) {
+            std::vector<char> payload;
+            BinaryWriter writer(payload);
+            writeCar(writer, car);
+            logMutation(WalRecordType::ADD_CAR, payload);
+        }
+    }
+
+    void removeCar(const std::string& licensePlate) {
+        if (eraseCar(licensePlate) && wal) {
+            std::vector<char> payload;
+            BinaryWriter(payload).writeString(licensePlate);
+            logMutation(WalRecordType::REMOVE_CAR, payload);
+        }
+    }
+
+    std::vector<Car> searchCars(const std::string& make, const std::string& model,
+                                const std::chrono::system_clock::time_point& startDate,
+                                const std::chrono::system_clock::time_point& endDate) {
+        return filterAvailable(carIndex.findByMakeModel(make, model), startDate, endDate);
+    }
+
+    std::vector<Car> searchCarsByYear(int minYear, int maxYear,
+                                      const std::chrono::system_clock::time_point& startDate,
+                                      const std::chrono::system_clock::time_point& endDate) {
+        return filterAvailable(carIndex.findByYear(minYear, maxYear), startDate, endDate);
+    }
+
+    std::vector<Car> searchCarsByPrice(double minPricePerDay, double maxPricePerDay,
+                                       const std::chrono::system_clock::time_point& startDate,
+                                       const std::chrono::system_clock::time_point& endDate) {
+        return filterAvailable(carIndex.findByPrice(minPricePerDay, maxPricePerDay), startDate, endDate);
+    }
+
+    // Answers many searches at once. Queries for the same make and model share
+    // a single walk over that model's cars; results are returned in query order.
+    std::vector<std::vector<Car>> searchCarsBatch(const std::vector<CarSearchQuery>& queries) {
+        std::vector<std::vector<Car>> results(queries.size());
+        std::map<std::pair<std::string, std::string>, std::vector<size_t>> queriesByMakeModel;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            queriesByMakeModel[{queries[i].make, queries[i].model}].push_back(i);
+        }
+        for (const auto& [makeModel, queryIds] : queriesByMakeModel) {
+            for (const Car* car : carIndex.findByMakeModel(makeModel.first, makeModel.second)) {
+                if (!car->isAvailable()) {
+                    continue;
+                }
+                for (size_t i : queryIds) {
+                    if (isCarAvailable(*car, queries[i].startDate, queries[i].endDate)) {
+                        results[i].push_back(*car);
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+    // Builds per-model day bitmaps for horizonDays starting at startDate's day.
+    // Call it again (e.g. nightly) to roll the horizon forward.
+    void enableAvailabilityBitmaps(const std::chrono::system_clock::time_point& startDate, size_t horizonDays = 365) {
+        int64_t startDay = FleetAvailabilityBitmap::floorDay(ReservationStore::toEpoch(startDate));
+        availabilityBitmap = std::make_unique<FleetAvailabilityBitmap>(startDay, horizonDays);
+        for (const auto& [licensePlate, car] : cars) {
+            availabilityBitmap->addCar(&car);
+        }
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            if (record.car != INVALID_HANDLE) {
+                availabilityBitmap->markBusy(reservations.getCar(record.car).getLicensePlate(),
+                                             record.startEpoch, record.endEpoch);
+            }
+        }
+    }
+
+    // Whole-day variant of searchCars: [startDate, endDate) is widened to the
+    // days it touches and answered from the bitmaps, so a car is returned only
+    // if it has no booking on any of those days. Falls back to searchCars when
+    // bitmaps are off or the days leave the horizon.
+    std::vector<Car> searchCarsForDays(const std::string& make, const std::string& model,
+                                       const std::chrono::system_clock::time_point& startDate,
+                                       const std::chrono::system_clock::time_point& endDate) {
+        int64_t firstDay = FleetAvailabilityBitmap::floorDay(ReservationStore::toEpoch(startDate));
+        int64_t endDay = std::max(FleetAvailabilityBitmap::ceilDay(ReservationStore::toEpoch(endDate)), firstDay + 1);
+        if (!availabilityBitmap || !availabilityBitmap->covers(firstDay, endDay)) {
+            int64_t ticksPerDay = FleetAvailabilityBitmap::ticksPerDay();
+            return searchCars(make, model, ReservationStore::fromEpoch(firstDay * ticksPerDay),
+                              ReservationStore::fromEpoch(endDay * ticksPerDay));
+        }
+        std::vector<Car> availableCars;
+        for (const Car* car : availabilityBitmap->findFree(make, model, firstDay, endDay)) {
+            if (car->isAvailable()) {
+                availableCars.push_back(*car);
+            }
+        }
+        return availableCars;
+    }
+
+    // The k earliest windows of the given length, starting no sooner than
+    // notBefore, on distinct cars of the model. Each car's earliest window
+    // comes from the free-gap index of its bookings rather than from repeated
+    // searches with shifted dates. Ordered by start date, then license plate.
+    std::vector<AvailableSlot> findEarliestAvailableSlots(const std::string& make, const std::string& model,
+                                                          const std::chrono::system_clock::time_point& notBefore,
+                                                          std::chrono::system_clock::duration length, size_t k) {
+        int64_t notBeforeEpoch = ReservationStore::toEpoch(notBefore);
+        std::vector<std::pair<int64_t, const Car*>> candidates;
+        for (const Car* car : carIndex.findByMakeModel(make, model)) {
+            if (!car->isAvailable()) {
+                continue;
+            }
+            CarHandle handle = reservations.findCar(car->getLicensePlate());
+            int64_t startEpoch = handle == INVALID_HANDLE
+                ? notBeforeEpoch
+                : reservationIndex.earliestFreeStart(handle, notBeforeEpoch, length.count());
+            candidates.emplace_back(startEpoch, car);
+        }
+        auto earlier = [](const std::pair<int64_t, const Car*>& a, const std::pair<int64_t, const Car*>& b) {
+            if (a.first != b.first) return a.first < b.first;
+            return a.second->getLicensePlate() < b.second->getLicensePlate();
+        };
+        size_t count = std::min(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), earlier);
+
+        std::vector<AvailableSlot> slots;
+        for (size_t i = 0; i < count; ++i) {
+            auto startDate = ReservationStore::fromEpoch(candidates[i].first);
+            slots.push_back(AvailableSlot{*candidates[i].second, startDate, startDate + length});
+        }
+        return slots;
+    }
+
+    bool isCarAvailable(const Car& car, const std::chrono::system_clock::time_point& startDate,
+                        const std::chrono::system_clock::time_point& endDate) {
+        CarHandle handle = reservations.findCar(car.getLicensePlate());
+        return handle == INVALID_HANDLE ||
+               !reservationIndex.overlaps(handle, ReservationStore::toEpoch(startDate), ReservationStore::toEpoch(endDate));
+    }
+
+    // With persistence on, the booking is logged but not yet durable when
+    // this returns: the WAL group-commits it within a few milliseconds, and a
+    // crash before that loses it. Call syncPersistence() before confirming
+    // bookings to anyone who must not lose them.
+    std::optional<Reservation> makeReservation(const Customer& customer, const Car& car,
+                                               const std::chrono::system_clock::time_point& startDate,
+                                               const std::chrono::system_clock::time_point& endDate) {
+        if (endDate < startDate) {
+            return std::nullopt;
+        }
+        if (isCarAvailable(car, startDate, endDate)) {
+            uint64_t reservationNumber = generateReservationNumber();
+            while (reservations.contains(reservationNumber)) {
+                reservationNumber = generateReservationNumber();
+            }
+            int64_t startEpoch = ReservationStore::toEpoch(startDate);
+            int64_t endEpoch = ReservationStore::toEpoch(endDate);
+            double totalPrice = Reservation::calculateTotalPrice(car, startDate, endDate);
+            ReservationHandle handle = insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+            if (wal) {
+                std::vector<char> payload;
+                BinaryWriter writer(payload);
+                writer.write(reservationNumber);
+                writeCar(writer, car);
+                writeCustomer(writer, customer);
+                writer.write(startEpoch);
+                writer.write(endEpoch);
+                writer.write(totalPrice);
+                logMutation(WalRecordType::MAKE_RESERVATION, payload);
+            }
+            const_cast<Car&>(car).setAvailable(false);
+            return reservations.materialize(handle);
+        }
+        return std::nullopt;
+    }
+
+    // Books every car for the same dates, or none if any of them is taken or
+    // listed twice. The group is logged as one record, so recovery also
+    // restores all of it or none of it; like makeReservation it returns
+    // before that record is durable. RentalSystem is single-threaded, so
+    // checking and booking in one call is already atomic; concurrent callers
+    // should use ConcurrentRentalSystem's group reservations.
+    std::optional<std::vector<Reservation>> makeGroupReservation(const Customer& customer, const std::vector<Car>& cars,
+                                                                 const std::chrono::system_clock::time_point& startDate,
+                                                                 const std::chrono::system_clock::time_point& endDate) {
+        if (endDate < startDate || cars.empty()) {
+            return std::nullopt;
+        }
+        std::unordered_set<std::string> licensePlates;
+        for (const Car& car : cars) {
+            if (!licensePlates.insert(car.getLicensePlate()).second || !isCarAvailable(car, startDate, endDate)) {
+                return std::nullopt;
+            }
+        }
+
+        int64_t startEpoch = ReservationStore::toEpoch(startDate);
+        int64_t endEpoch = ReservationStore::toEpoch(endDate);
+        std::vector<char> payload;
+        BinaryWriter writer(payload);
+        if (wal) {
+            writer.write(startEpoch);
+            writer.write(endEpoch);
+            writeCustomer(writer, customer);
+            writer.write(static_cast<uint32_t>(cars.size()));
+        }
+        std::vector<ReservationHandle> handles;
+        handles.reserve(cars.size());
+        for (const Car& car : cars) {
+            uint64_t reservationNumber = generateReservationNumber();
+            while (reservations.contains(reservationNumber)) {
+                reservationNumber = generateReservationNumber();
+            }
+            double totalPrice = Reservation::calculateTotalPrice(car, startDate, endDate);
+            handles.push_back(insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice));
+            if (wal) {
+                writer.write(reservationNumber);
+                writeCar(writer, car);
+                writer.write(totalPrice);
+            }
+        }
+        if (wal) {
+            logMutation(WalRecordType::GROUP_RESERVATION, payload);
+        }
+
+        std::vector<Reservation> booked;
+        booked.reserve(handles.size());
+        for (ReservationHandle handle : handles) {
+            booked.push_back(reservations.materialize(handle));
+        }
+        return booked;
+    }
+
+    void cancelReservation(const std::string& reservationId) {
+        ReservationHandle handle = reservations.find(reservationId);
+        if (handle != INVALID_HANDLE) {
+            uint64_t reservationNumber = reservations.get(handle).reservationNumber;
+            eraseReservation(handle);
+            if (wal) {
+                std::vector<char> payload;
+                BinaryWriter(payload).write(reservationNumber);
+                logMutation(WalRecordType::CANCEL_RESERVATION, payload);
+            }
+        }
+    }
+
+    // Copy of the columnar reservation data. Run ReservationAnalytics on it
+    // from another thread and bookings here carry on while the report runs.
+    std::shared_ptr<const ReservationColumns> snapshotReservationColumns() const {
+        return std::make_shared<const ReservationColumns>(reservationColumns);
+    }
+
+    std::vector<DailyRevenue> getRevenueByMakePerDay() const {
+        return ReservationAnalytics::revenueByMakePerDay(reservationColumns);
+    }
+
+    // Share of [startDate, endDate) each fleet car is booked for.
+    std::unordered_map<std::string, double> getUtilizationPerCar(const std::chrono::system_clock::time_point& startDate,
+                                                                 const std::chrono::system_clock::time_point& endDate) const {
+        std::vector<double> utilizationByHandle = ReservationAnalytics::utilizationPerCar(
+            reservationColumns, reservations.getRegisteredCars().size(),
+            ReservationStore::toEpoch(startDate), ReservationStore::toEpoch(endDate));
+        std::unordered_map<std::string, double> utilization;
+        for (const auto& [licensePlate, car] : cars) {
+            CarHandle handle = reservations.findCar(licensePlate);
+            utilization[licensePlate] = handle == INVALID_HANDLE ? 0 : utilizationByHandle[handle];
+        }
+        return utilization;
+    }
+
+    std::chrono::system_clock::duration getAverageRentalLength() const {
+        return std::chrono::system_clock::duration(
+            static_cast<std::chrono::system_clock::rep>(ReservationAnalytics::averageRentalLength(reservationColumns)));
+    }
+
+    bool processPayment(const Reservation& reservation) {
+        return paymentProcessor->processPayment(reservation.getTotalPrice());
+    }
+
+    // Queues the charge and returns at once; the caller only waits on the
+    // gateway if it calls get() on the returned future.
+    std::future<bool> processPaymentAsync(const Reservation& reservation) {
+        if (!paymentPipeline) {
+            paymentPipeline = std::make_unique<AsyncPaymentPipeline>(*paymentProcessor);
+        }
+        return paymentPipeline->submit(reservation.getTotalPrice());
+    }
+
+    // Restores the fleet and bookings from the latest snapshot in `directory`
+    // plus the WAL records written after it, then logs every later mutation.
+    // Call once, before the system is used. A new snapshot is taken after
+    // every snapshotEveryRecords logged mutations (0 disables that); only its
+    // serialization runs on the mutating thread, the write in the background.
+    // Mutations become durable shortly after they return, not before; see
+    // syncPersistence().
+    bool enablePersistence(const std::string& directory, size_t snapshotEveryRecords = 1000000) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        snapshotPath = directory + "/rental.snapshot";
+        std::string walPath = directory + "/rental.wal";
+
+        uint64_t lastLsn = 0;
+        if (!loadSnapshot(lastLsn)) {
+            return false;
+        }
+        size_t validBytes = WriteAheadLog::replay(walPath, [&](uint64_t lsn, WalRecordType type, BinaryReader& payload) {
+            if (lsn > lastLsn) {
+                applyLogRecord(type, payload);
+                lastLsn = lsn;
+            }
+        });
+
+        this->snapshotEveryRecords = snapshotEveryRecords;
+        wal = std::make_unique<WriteAheadLog>();
+        return wal->open(walPath, validBytes, lastLsn + 1);
+    }
+
+    // Blocks until every mutation logged so far is on disk.
+    bool syncPersistence() {
+        return wal && wal->waitDurable(wal->sync());
+    }
+
+    // Writes a snapshot covering everything logged so far and empties the WAL,
+    // so the next recovery only replays what is written after this point.
+    // Blocks until done, including any automatic checkpoint still running.
+    bool checkpoint() {
+        if (!wal) {
+            return false;
+        }
+        if (backgroundCheckpoint.valid()) {
+            backgroundCheckpoint.get();
+        }
+        recordsSinceSnapshot = 0;
+        uint64_t lastLsn = wal->sync();
+        return writeSnapshot(serializeSnapshot(lastLsn)) && wal->truncateThrough(lastLsn);
+    }
+
+private:
+    void storeCar(const Car& car) {
+        auto it = cars.find(car.getLicensePlate());
+        if (it != cars.end()) {
+            carIndex.remove(&it->second);
+            it->second = car;
+        } else {
+            it = cars.emplace(car.getLicensePlate(), car).first;
+        }
+        carIndex.add(&it->second);
+        if (availabilityBitmap) {
+            availabilityBitmap->removeCar(car.getLicensePlate());
+            availabilityBitmap->addCar(&it->second);
+            CarHandle carHandle = reservations.findCar(car.getLicensePlate());
+            if (carHandle != INVALID_HANDLE) {
+                for (ReservationHandle handle : reservationIndex.reservationsOf(carHandle)) {
+                    const ReservationRecord& record = reservations.get(handle);
+                    availabilityBitmap->markBusy(car.getLicensePlate(), record.startEpoch, record.endEpoch);
+                }
+            }
+        }
+    }
+
+    bool eraseCar(const std::string& licensePlate) {
+        auto it = cars.find(licensePlate);
+        if (it == cars.end()) {
+            return false;
+        }
+        carIndex.remove(&it->second);
+        if (availabilityBitmap) {
+            availabilityBitmap->removeCar(licensePlate);
+        }
+        cars.erase(it);
+        return true;
+    }
+
+    ReservationHandle insertReservation(uint64_t reservationNumber, const Car& car, const Customer& customer,
+                                        int64_t startEpoch, int64_t endEpoch, double totalPrice) {
+        CarHandle carHandle = reservations.internCar(car);
+        ReservationHandle handle = reservations.add(reservationNumber, carHandle, reservations.internCustomer(customer),
+                                                    startEpoch, endEpoch, totalPrice);
+        reservationIndex.insert(carHandle, startEpoch, endEpoch, handle);
+        reservationColumns.add(handle, reservations.get(handle), car.getMake());
+        if (availabilityBitmap) {
+            availabilityBitmap->markBusy(car.getLicensePlate(), startEpoch, endEpoch);
+        }
+        return handle;
+    }
+
+    void eraseReservation(ReservationHandle handle) {
+        const ReservationRecord& record = reservations.get(handle);
+        reservationIndex.erase(record.car, record.startEpoch, record.endEpoch);
+        reservationColumns.remove(handle);
+        if (availabilityBitmap) {
+            // Clearing the booking's days may also clear days it shared with
+            // neighbouring bookings of the same car, so re-mark those.
+            const std::string& licensePlate = reservations.getCar(record.car).getLicensePlate();
+            int64_t ticksPerDay = FleetAvailabilityBitmap::ticksPerDay();
+            availabilityBitmap->clearBusy(licensePlate, record.startEpoch, record.endEpoch);
+            reservationIndex.forEachTouching(record.car,
+                                             (FleetAvailabilityBitmap::floorDay(record.startEpoch) - 1) * ticksPerDay,
+                                             (FleetAvailabilityBitmap::ceilDay(record.endEpoch) + 1) * ticksPerDay,
+                                             [&](int64_t startEpoch, int64_t endEpoch, ReservationHandle) {
+                // Midnight instants own no day bits, so clearing cannot lose them.
+                if (!FleetAvailabilityBitmap::isMidnightInstant(startEpoch, endEpoch)) {
+                    availabilityBitmap->markBusy(licensePlate, startEpoch, endEpoch);
+                }
+            });
+        }
+        reservations.remove(handle);
+    }
+
+    void logMutation(WalRecordType type, const std::vector<char>& payload) {
+        uint64_t lsn = wal->append(type, payload);
+        if (snapshotEveryRecords && ++recordsSinceSnapshot >= snapshotEveryRecords) {
+            startBackgroundCheckpoint(lsn);
+        }
+    }
+
+    // Serializes the state here, where nothing can change it underneath, and
+    // leaves the file write, fsync and WAL truncation to a background task,
+    // so bookings only pay for an in-memory copy. If the previous checkpoint
+    // is still being written, this one waits for a later mutation.
+    void startBackgroundCheckpoint(uint64_t lastLsn) {
+        if (backgroundCheckpoint.valid()) {
+            if (backgroundCheckpoint.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            backgroundCheckpoint.get();
+        }
+        recordsSinceSnapshot = 0;
+        backgroundCheckpoint = std::async(std::launch::async, [this, snapshot = serializeSnapshot(lastLsn), lastLsn]() {
+            return writeSnapshot(snapshot) && wal->truncateThrough(lastLsn);
+        });
+    }
+
+    void applyLogRecord(WalRecordType type, BinaryReader& payload) {
+        switch (type) {
+        case WalRecordType::ADD_CAR: {
+            Car car = readCar(payload);
+            if (payload.ok()) {
+                storeCar(car);
+            }
+            break;
+        }
+        case WalRecordType::REMOVE_CAR: {
+            std::string licensePlate = payload.readString();
+            if (payload.ok()) {
+                eraseCar(licensePlate);
+            }
+            break;
+        }
+        case WalRecordType::MAKE_RESERVATION: {
+            uint64_t reservationNumber = payload.read<uint64_t>();
+            Car car = readCar(payload);
+            Customer customer = readCustomer(payload);
+            int64_t startEpoch = payload.read<int64_t>();
+            int64_t endEpoch = payload.read<int64_t>();
+            double totalPrice = payload.read<double>();
+            if (payload.ok() && !reservations.contains(reservationNumber)) {
+                insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+            }
+            break;
+        }
+        case WalRecordType::GROUP_RESERVATION: {
+            int64_t startEpoch = payload.read<int64_t>();
+            int64_t endEpoch = payload.read<int64_t>();
+            Customer customer = readCustomer(payload);
+            std::vector<std::tuple<uint64_t, Car, double>> bookings;
+            for (uint32_t i = payload.read<uint32_t>(); i > 0 && payload.ok(); --i) {
+                uint64_t reservationNumber = payload.read<uint64_t>();
+                Car car = readCar(payload);
+                bookings.emplace_back(reservationNumber, car, payload.read<double>());
+            }
+            if (payload.ok()) {
+                for (const auto& [reservationNumber, car, totalPrice] : bookings) {
+                    if (!reservations.contains(reservationNumber)) {
+                        insertReservation(reservationNumber, car, customer, startEpoch, endEpoch, totalPrice);
+                    }
+                }
+            }
+            break;
+        }
+        case WalRecordType::CANCEL_RESERVATION: {
+            ReservationHandle handle = reservations.find(payload.read<uint64_t>());
+            if (payload.ok() && handle != INVALID_HANDLE) {
+                eraseReservation(handle);
+            }
+            break;
+        }
+        }
+    }
+
+    // Snapshot layout: magic, last covered lsn, fleet cars, the reservation
+    // store's car and customer registries in handle order, live reservation
+    // records, and a trailing checksum.
+    std::vector<char> serializeSnapshot(uint64_t lastLsn) const {
+        std::vector<char> buffer;
+        BinaryWriter writer(buffer);
+        writer.write(SNAPSHOT_MAGIC);
+        writer.write(lastLsn);
+        writer.write(static_cast<uint64_t>(cars.size()));
+        for (const auto& [licensePlate, car] : cars) {
+            writeCar(writer, car);
+        }
+        writer.write(static_cast<uint64_t>(reservations.getRegisteredCars().size()));
+        for (const Car& car : reservations.getRegisteredCars()) {
+            writeCar(writer, car);
+        }
+        writer.write(static_cast<uint64_t>(reservations.getRegisteredCustomers().size()));
+        for (const Customer& customer : reservations.getRegisteredCustomers()) {
+            writeCustomer(writer, customer);
+        }
+        uint64_t liveRecords = 0;
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            liveRecords += record.car != INVALID_HANDLE;
+        }
+        writer.write(liveRecords);
+        for (const ReservationRecord& record : reservations.getRecords()) {
+            if (record.car != INVALID_HANDLE) {
+                writer.write(record.reservationNumber);
+                writer.write(record.car);
+                writer.write(record.customer);
+                writer.write(record.startEpoch);
+                writer.write(record.endEpoch);
+                writer.write(record.totalPrice);
+            }
+        }
+        writer.write(checksum(buffer.data(), buffer.size()));
+        return buffer;
+    }
+
+    // Written to a temp file and renamed, so a crash keeps the old snapshot.
+    bool writeSnapshot(const std::vector<char>& buffer) const {
+        std::string tempPath = snapshotPath + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && syncToDisk(file);
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(tempPath, snapshotPath, error);
+        return written && !error;
+    }
+
+    // Parses the snapshot straight out of the mapped file. A missing snapshot
+    // is an empty system; a damaged one fails recovery.
+    bool loadSnapshot(uint64_t& lastLsn) {
+        std::error_code error;
+        if (!std::filesystem::exists(snapshotPath, error)) {
+            return true;
+        }
+        MappedFile mapped;
+        if (!mapped.open(snapshotPath) || mapped.getSize() < sizeof(uint32_t)) {
+            return false;
+        }
+        size_t bodySize = mapped.getSize() - sizeof(uint32_t);
+        BinaryReader trailer(mapped.getData() + bodySize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(mapped.getData(), bodySize)) {
+            return false;
+        }
+        BinaryReader reader(mapped.getData(), bodySize);
+        if (reader.read<uint32_t>() != SNAPSHOT_MAGIC) {
+            return false;
+        }
+        lastLsn = reader.read<uint64_t>();
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            storeCar(readCar(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            reservations.internCar(readCar(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            reservations.internCustomer(readCustomer(reader));
+        }
+        for (uint64_t i = reader.read<uint64_t>(); i > 0 && reader.ok(); --i) {
+            uint64_t reservationNumber = reader.read<uint64_t>();
+            CarHandle carHandle = reader.read<CarHandle>();
+            CustomerHandle customerHandle = reader.read<CustomerHandle>();
+            int64_t startEpoch = reader.read<int64_t>();
+            int64_t endEpoch = reader.read<int64_t>();
+            double totalPrice = reader.read<double>();
+            if (!reader.ok() || carHandle >= reservations.getRegisteredCars().size() ||
+                customerHandle >= reservations.getRegisteredCustomers().size() ||
+                reservations.contains(reservationNumber)) {
+                return false;
+            }
+            ReservationHandle handle = reservations.add(reservationNumber, carHandle, customerHandle,
+                                                        startEpoch, endEpoch, totalPrice);
+            reservationIndex.insert(carHandle, startEpoch, endEpoch, handle);
+            reservationColumns.add(handle, reservations.get(handle), reservations.getCar(carHandle).getMake());
+        }
+        return reader.ok();
+    }
+
+    std::vector<Car> filterAvailable(const std::vector<const Car*>& candidates,
+                                     const std::chrono::system_clock::time_point& startDate,
+                                     const std::chrono::system_clock::time_point& endDate) {
+        std::vector<Car> availableCars;
+        for (const Car* car : candidates) {
+            if (car->isAvailable() && isCarAvailable(*car, startDate, endDate)) {
+                availableCars.push_back(*car);
+            }
+        }
+        return availableCars;
+    }
+
+    uint64_t generateReservationNumber() {
+        static std::mt19937 rng(std::time(nullptr));
+        static std::uniform_int_distribution<int> dist(0, 99999999);
+        return dist(rng);
+    }
+};
 
 // Main program
 int main() {
@@ -207,7 +2214,7 @@ int main() {
     auto availableCars = rentalSystem->searchCars("Toyota", "Camry", startDate, endDate);
     if (!availableCars.empty()) {
         Car selectedCar = availableCars.front();
-        Reservation* reservation = rentalSystem->makeReservation(customer1, selectedCar, startDate, endDate);
+        std::optional<Reservation> reservation = rentalSystem->makeReservation(customer1, selectedCar, startDate, endDate);
         if (reservation) {
             bool paymentSuccess = rentalSystem->processPayment(*reservation);
             if (paymentSuccess) {
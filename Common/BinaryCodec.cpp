@@ -0,0 +1,79 @@
+#ifndef BINARYCODEC_H
+#define BINARYCODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Little helpers for the fixed-layout binary files written by the logs,
+// snapshots and indexes. Values are stored in host byte order; the files are
+// meant to be read back by the same build, not exchanged between machines.
+inline uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+class BinaryWriter {
+private:
+    std::vector<char>& buffer;
+
+public:
+    explicit BinaryWriter(std::vector<char>& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    void write(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+};
+
+// Bounds-checked reader over a byte range, typically a memory-mapped file.
+// Once a read runs past the end, ok() turns false and later reads yield zeros.
+class BinaryReader {
+private:
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+    bool valid = true;
+
+public:
+    BinaryReader(const char* data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return valid; }
+    size_t position() const { return offset; }
+    size_t remaining() const { return size - offset; }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!valid || remaining() < sizeof(T)) {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        uint32_t length = read<uint32_t>();
+        if (!valid || remaining() < length) {
+            valid = false;
+            return std::string();
+        }
+        std::string value(data + offset, length);
+        offset += length;
+        return value;
+    }
+};
+
+#endif // BINARYCODEC_H
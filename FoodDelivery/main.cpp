@@ -2,9 +2,25 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <algorithm>
-#include <random>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <chrono>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <deque>
+#include <cstdio>
+#include <cstring>
+#include <optional>
 
 using namespace std;
 
@@ -25,22 +41,90 @@ enum class OrderStatus {
     CANCELLED
 };
 
-// MenuItem class
+// Location struct: position on a city-local plane, in kilometres
+struct Location {
+    double x = 0;
+    double y = 0;
+
+    double distanceTo(const Location& other) const { return hypot(x - other.x, y - other.y); }
+};
+
+// Dense per-kind handle for a customer, restaurant, agent or menu item,
+// handed out by an IdInterner when the entity is registered
+using EntityId = uint32_t;
+
+constexpr EntityId NO_ENTITY = UINT32_MAX;
+
+// IdInterner class: maps external string ids to dense handles once, at the
+// service edge, so everything behind it can index flat arrays. find() never
+// inserts, so lookups of unknown ids leave the table as it was.
+class IdInterner {
+public:
+    EntityId intern(const string& id) {
+        auto [it, inserted] = handles.emplace(id, static_cast<EntityId>(ids.size()));
+        if (inserted) {
+            ids.push_back(id);
+        }
+        return it->second;
+    }
+
+    // The handle of a known id, or NO_ENTITY.
+    EntityId find(const string& id) const {
+        auto it = handles.find(id);
+        return it == handles.end() ? NO_ENTITY : it->second;
+    }
+
+    const string& idOf(EntityId handle) const { return ids[handle]; }
+    size_t size() const { return ids.size(); }
+
+private:
+    unordered_map<string, EntityId> handles;
+    vector<string> ids;
+};
+
+// MenuItem class: price and availability are atomics, so menu readers see
+// updates without locking and without a new menu snapshot
 class MenuItem {
 public:
     MenuItem(string id, string name, string description, double price)
         : id(id), name(name), description(description), price(price), available(true) {}
 
-    void setAvailable(bool available) { this->available = available; }
+    void setAvailable(bool available) { this->available.store(available, memory_order_relaxed); }
+    bool isAvailable() const { return available.load(memory_order_relaxed); }
 
-    string getId() const { return id; }
+    void setPrice(double price) { this->price.store(price, memory_order_relaxed); }
+    double getPrice() const { return price.load(memory_order_relaxed); }
+
+    const string& getId() const { return id; }
+    const string& getName() const { return name; }
+    EntityId getHandle() const { return handle; }
+    void setHandle(EntityId handle) { this->handle = handle; }
 
 private:
     string id;
+    EntityId handle = NO_ENTITY;
     string name;
     string description;
-    double price;
-    bool available;
+    atomic<double> price;
+    atomic<bool> available;
+};
+
+// MenuSnapshot struct: immutable list of a restaurant's menu items. Edits
+// publish a new snapshot with the next version; readers keep whichever one
+// they loaded for as long as they hold it.
+struct MenuSnapshot {
+    uint64_t version = 0;
+    vector<shared_ptr<MenuItem>> items;
+
+    // Menus are short, so a scan is cheaper than an index per snapshot.
+    shared_ptr<MenuItem> find(const string& menuItemId) const {
+        for (const shared_ptr<MenuItem>& item : items) {
+            if (item->getId() == menuItemId) {
+                return item;
+            }
+        }
+        return nullptr;
+    }
 };
 
 // Customer class
@@ -49,10 +133,13 @@ public:
     Customer(string id, string name, string email, string phone)
         : id(id), name(name), email(email), phone(phone) {}
 
-    string getId() const { return id; }
+    const string& getId() const { return id; }
+    EntityId getHandle() const { return handle; }
+    void setHandle(EntityId handle) { this->handle = handle; }
 
 private:
     string id;
+    EntityId handle = NO_ENTITY;
     string name;
     string email;
     string phone;
@@ -61,19 +148,162 @@ private:
 // DeliveryAgent class
 class DeliveryAgent {
 public:
-    DeliveryAgent(string id, string name, string phone)
-        : id(id), name(name), phone(phone), available(true) {}
+    DeliveryAgent(string id, string name, string phone, Location location = {})
+        : id(id), name(name), phone(phone), available(true), location(location) {}
 
-    void setAvailable(bool available) { this->available = available; }
-    bool isAvailable() const { return available; }
+    // Atomic so the agent app can read it while the dispatch timer books
+    // the agent.
+    void setAvailable(bool available) { this->available.store(available, memory_order_relaxed); }
+    bool isAvailable() const { return available.load(memory_order_relaxed); }
 
-    string getId() const { return id; }
+    void setLocation(const Location& location) { this->location = location; }
+    const Location& getLocation() const { return location; }
+
+    const string& getId() const { return id; }
+    EntityId getHandle() const { return handle; }
+    void setHandle(EntityId handle) { this->handle = handle; }
 
 private:
     string id;
+    EntityId handle = NO_ENTITY;
     string name;
     string phone;
-    bool available;
+    atomic<bool> available;
+    Location location;
+};
+
+// AgentGrid class: uniform grid of square cells over agent locations. Each
+// agent sits in the cell vector for its location and its handle records the
+// index there, so inserts, removals and moves are O(1); agents must be
+// registered (have a handle) first. nearest() searches rings of cells
+// outward from the query point and stops once no unvisited cell can hold an
+// agent closer than the k-th best found, so its cost depends on the local
+// agent density rather than the fleet size.
+class AgentGrid {
+public:
+    explicit AgentGrid(double cellSizeKm = 1.0) : cellSize(cellSizeKm) {}
+
+    void insert(const shared_ptr<DeliveryAgent>& agent) {
+        if (contains(agent->getHandle())) {
+            return;
+        }
+        if (agent->getHandle() >= positions.size()) {
+            positions.resize(agent->getHandle() + 1, {0, NOT_INDEXED});
+        }
+        int64_t cellX = cellOf(agent->getLocation().x);
+        int64_t cellY = cellOf(agent->getLocation().y);
+        vector<shared_ptr<DeliveryAgent>>& cell = cells[cellKey(cellX, cellY)];
+        positions[agent->getHandle()] = {cellKey(cellX, cellY), cell.size()};
+        cell.push_back(agent);
+        ++indexedCount;
+        minCellX = min(minCellX, cellX);
+        maxCellX = max(maxCellX, cellX);
+        minCellY = min(minCellY, cellY);
+        maxCellY = max(maxCellY, cellY);
+    }
+
+    void remove(EntityId agent) {
+        if (!contains(agent)) {
+            return;
+        }
+        auto [key, index] = positions[agent];
+        positions[agent].second = NOT_INDEXED;
+        --indexedCount;
+        vector<shared_ptr<DeliveryAgent>>& cell = cells[key];
+        if (index + 1 != cell.size()) {
+            cell[index] = move(cell.back());
+            positions[cell[index]->getHandle()].second = index;
+        }
+        cell.pop_back();
+        if (cell.empty()) {
+            cells.erase(key);
+        }
+    }
+
+    // Updates the agent's location and, if the agent is indexed, its cell.
+    void moveAgent(const shared_ptr<DeliveryAgent>& agent, const Location& location) {
+        bool indexed = contains(agent->getHandle());
+        if (indexed && cellKey(cellOf(location.x), cellOf(location.y)) == positions[agent->getHandle()].first) {
+            agent->setLocation(location);
+            return;
+        }
+        if (indexed) {
+            remove(agent->getHandle());
+        }
+        agent->setLocation(location);
+        if (indexed) {
+            insert(agent);
+        }
+    }
+
+    // Up to k indexed agents closest to from, nearest first.
+    vector<shared_ptr<DeliveryAgent>> nearest(const Location& from, size_t k) const {
+        vector<shared_ptr<DeliveryAgent>> result;
+        if (k == 0 || indexedCount == 0) {
+            return result;
+        }
+        // Max-heap on distance holding the k best so far; the pointers refer
+        // into cells, which this call does not change.
+        using Candidate = pair<double, const shared_ptr<DeliveryAgent>*>;
+        priority_queue<Candidate> best;
+        int64_t originX = cellOf(from.x);
+        int64_t originY = cellOf(from.y);
+        int64_t lastRing = max(max(originX - minCellX, maxCellX - originX), max(originY - minCellY, maxCellY - originY));
+        for (int64_t ring = 0; ring <= lastRing; ++ring) {
+            for (int64_t cellX = originX - ring; cellX <= originX + ring; ++cellX) {
+                // Inner columns of the ring only contribute their top and bottom cells.
+                int64_t step = (cellX == originX - ring || cellX == originX + ring) ? 1 : 2 * ring;
+                for (int64_t cellY = originY - ring; cellY <= originY + ring; cellY += step) {
+                    auto cell = cells.find(cellKey(cellX, cellY));
+                    if (cell == cells.end()) {
+                        continue;
+                    }
+                    for (const shared_ptr<DeliveryAgent>& agent : cell->second) {
+                        double distance = from.distanceTo(agent->getLocation());
+                        if (best.size() < k) {
+                            best.push({distance, &agent});
+                        } else if (distance < best.top().first) {
+                            best.pop();
+                            best.push({distance, &agent});
+                        }
+                    }
+                }
+            }
+            // Every cell outside this ring is at least ring cells away.
+            if (best.size() == k && best.top().first <= ring * cellSize) {
+                break;
+            }
+        }
+        result.resize(best.size());
+        for (size_t i = best.size(); i-- > 0; best.pop()) {
+            result[i] = *best.top().second;
+        }
+        return result;
+    }
+
+    bool contains(EntityId agent) const { return agent < positions.size() && positions[agent].second != NOT_INDEXED; }
+    size_t size() const { return indexedCount; }
+
+private:
+    static constexpr size_t NOT_INDEXED = SIZE_MAX;
+
+    double cellSize;
+    unordered_map<uint64_t, vector<shared_ptr<DeliveryAgent>>> cells;
+    // Agent handle -> (cell key, index within the cell); the index is
+    // NOT_INDEXED for agents not in the grid.
+    vector<pair<uint64_t, size_t>> positions;
+    size_t indexedCount = 0;
+    // Bounding box of every cell ever used; limits how far nearest() searches.
+    int64_t minCellX = numeric_limits<int64_t>::max();
+    int64_t maxCellX = numeric_limits<int64_t>::min();
+    int64_t minCellY = numeric_limits<int64_t>::max();
+    int64_t maxCellY = numeric_limits<int64_t>::min();
+
+    int64_t cellOf(double coordinate) const { return static_cast<int64_t>(floor(coordinate / cellSize)); }
+
+    static uint64_t cellKey(int64_t cellX, int64_t cellY) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32 | static_cast<uint32_t>(cellY);
+    }
 };
 
 // OrderItem class
@@ -82,6 +312,9 @@ public:
     OrderItem(const shared_ptr<MenuItem>& menuItem, int quantity)
         : menuItem(menuItem), quantity(quantity) {}
 
+    const shared_ptr<MenuItem>& getMenuItem() const { return menuItem; }
+    int getQuantity() const { return quantity; }
+
 private:
     shared_ptr<MenuItem> menuItem;
     int quantity;
@@ -90,23 +323,44 @@ private:
 // Order class
 class Order {
 public:
+    Order() : status(OrderStatus::PENDING) {}
     Order(string id, shared_ptr<Customer> customer, shared_ptr<Restaurant> restaurant)
         : id(id), customer(customer), restaurant(restaurant), status(OrderStatus::PENDING) {}
 
-    void addItem(const shared_ptr<OrderItem>& item) { items.push_back(item); }
-    void removeItem(const shared_ptr<OrderItem>& item) { items.erase(remove(items.begin(), items.end(), item), items.end()); }
+    // Reinitializes a recycled order in place; the item buffer keeps its
+    // capacity, so a reused slot does not allocate for its items again.
+    void reset(string id, shared_ptr<Customer> customer, shared_ptr<Restaurant> restaurant) {
+        this->id = move(id);
+        this->customer = move(customer);
+        this->restaurant = move(restaurant);
+        items.clear();
+        status = OrderStatus::PENDING;
+        deliveryAgent.reset();
+    }
+
+    void addItem(const OrderItem& item) { items.push_back(item); }
+    void removeItem(const string& menuItemId) {
+        items.erase(remove_if(items.begin(), items.end(),
+                              [&](const OrderItem& item) { return item.getMenuItem()->getId() == menuItemId; }),
+                    items.end());
+    }
 
     void setStatus(OrderStatus status) { this->status = status; }
     void assignDeliveryAgent(const shared_ptr<DeliveryAgent>& agent) { this->deliveryAgent = agent; }
 
     string getId() const { return id; }
     OrderStatus getStatus() const { return status; }
+    shared_ptr<Customer> getCustomer() const { return customer; }
+    shared_ptr<Restaurant> getRestaurant() const { return restaurant; }
+    shared_ptr<DeliveryAgent> getDeliveryAgent() const { return deliveryAgent; }
+    const vector<OrderItem>& getItems() const { return items; }
+    bool isFinished() const { return status == OrderStatus::DELIVERED || status == OrderStatus::CANCELLED; }
 
 private:
     string id;
     shared_ptr<Customer> customer;
     shared_ptr<Restaurant> restaurant;
-    vector<shared_ptr<OrderItem>> items;
+    vector<OrderItem> items;
     OrderStatus status;
     shared_ptr<DeliveryAgent> deliveryAgent;
 };
@@ -114,23 +368,813 @@ private:
 // Restaurant class
 class Restaurant {
 public:
-    Restaurant(string id, string name, string address, vector<shared_ptr<MenuItem>> menu)
-        : id(id), name(name), address(address), menu(menu) {}
+    Restaurant(string id, string name, string address, vector<shared_ptr<MenuItem>> menu, Location location = {})
+        : id(id), name(name), address(address),
+          menu(make_shared<const MenuSnapshot>(MenuSnapshot{1, move(menu)})), location(location) {}
+
+    // Edits copy the current snapshot and swap the edited copy in
+    // (read-copy-update); writers are serialized, readers never wait on them.
+    // Once the restaurant is registered, edit through
+    // FoodDeliveryService::addMenuItem/removeMenuItem so its item index
+    // follows.
+    void addMenuItem(const shared_ptr<MenuItem>& item) {
+        editMenu([&item](vector<shared_ptr<MenuItem>>& items) { items.push_back(item); });
+    }
 
-    void addMenuItem(const shared_ptr<MenuItem>& item) { menu.push_back(item); }
-    void removeMenuItem(const shared_ptr<MenuItem>& item) { menu.erase(remove(menu.begin(), menu.end(), item), menu.end()); }
+    void removeMenuItem(const shared_ptr<MenuItem>& item) {
+        editMenu([&item](vector<shared_ptr<MenuItem>>& items) { items.erase(remove(items.begin(), items.end(), item), items.end()); });
+    }
 
-    string getId() const { return id; }
-    vector<shared_ptr<MenuItem>> getMenu() const { return menu; }
+    const string& getId() const { return id; }
+    EntityId getHandle() const { return handle; }
+    void setHandle(EntityId handle) { this->handle = handle; }
+    // The current menu: one reference count bump, however long the menu.
+    shared_ptr<const MenuSnapshot> getMenu() const { return atomic_load(&menu); }
+    uint64_t getMenuVersion() const { return getMenu()->version; }
+    const Location& getLocation() const { return location; }
 
 private:
     string id;
+    EntityId handle = NO_ENTITY;
     string name;
     string address;
-    vector<shared_ptr<MenuItem>> menu;
+    // Only accessed through atomic_load/atomic_store.
+    shared_ptr<const MenuSnapshot> menu;
+    mutex menuEditMutex;
+    Location location;
+
+    template <typename Edit>
+    void editMenu(Edit edit) {
+        lock_guard<mutex> lock(menuEditMutex);
+        shared_ptr<const MenuSnapshot> current = atomic_load(&menu);
+        auto next = make_shared<MenuSnapshot>(MenuSnapshot{current->version + 1, current->items});
+        edit(next->items);
+        atomic_store(&menu, shared_ptr<const MenuSnapshot>(move(next)));
+    }
+};
+
+// OrderHandle struct: slot in the OrderStore plus the slot's generation, so a
+// handle to an order that has since been archived is detected instead of
+// silently referring to the slot's next occupant
+struct OrderHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return slot != UINT32_MAX; }
+};
+
+// OrderStore class: slab pool of Order objects. Slots are allocated SLAB_SIZE
+// at a time and recycled through a free list, so placing an order reuses a
+// slot (and its item buffer) instead of allocating, and orders never move.
+class OrderStore {
+public:
+    static constexpr size_t SLAB_SIZE = 1024;
+
+    OrderHandle create() {
+        if (freeSlots.empty()) {
+            uint32_t first = static_cast<uint32_t>(generations.size());
+            slabs.push_back(make_unique<Order[]>(SLAB_SIZE));
+            generations.resize(generations.size() + SLAB_SIZE, 0);
+            for (uint32_t slot = first + SLAB_SIZE; slot-- > first;) {
+                freeSlots.push_back(slot);
+            }
+        }
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        ++liveCount;
+        return {slot, generations[slot]};
+    }
+
+    // nullptr once the order has been released.
+    Order* get(OrderHandle handle) {
+        return isLive(handle) ? &slabs[handle.slot / SLAB_SIZE][handle.slot % SLAB_SIZE] : nullptr;
+    }
+
+    const Order* get(OrderHandle handle) const {
+        return isLive(handle) ? &slabs[handle.slot / SLAB_SIZE][handle.slot % SLAB_SIZE] : nullptr;
+    }
+
+    // Drops the order's references and returns its slot to the pool.
+    void release(OrderHandle handle) {
+        Order* order = get(handle);
+        if (!order) {
+            return;
+        }
+        order->reset(string(), nullptr, nullptr);
+        ++generations[handle.slot];
+        freeSlots.push_back(handle.slot);
+        --liveCount;
+    }
+
+    size_t size() const { return liveCount; }
+    size_t capacity() const { return generations.size(); }
+
+private:
+    vector<unique_ptr<Order[]>> slabs;
+    vector<uint32_t> generations;
+    vector<uint32_t> freeSlots;
+    size_t liveCount = 0;
+
+    bool isLive(OrderHandle handle) const {
+        return handle.slot < generations.size() && generations[handle.slot] == handle.generation;
+    }
+};
+
+// ArchivedOrder struct: an order as read back from the cold tier
+struct ArchivedOrder {
+    string orderId;
+    string customerId;
+    string restaurantId;
+    string deliveryAgentId;
+    OrderStatus status = OrderStatus::PENDING;
+    vector<pair<string, int>> items;
+};
+
+// OrderArchive class: cold tier for finished orders. Each order becomes one
+// compact record (length-prefixed ids, status, item ids and quantities; host
+// byte order) appended to a byte log, of which at most FLUSH_BYTES stay in
+// memory. The rest goes to an append-only file when a path is set, or to an
+// anonymous temporary file that disappears with the archive otherwise. The
+// file stays open for the archive's lifetime.
+class OrderArchive {
+public:
+    static constexpr size_t FLUSH_BYTES = 1 << 16;
+
+    OrderArchive() = default;
+    OrderArchive(const OrderArchive&) = delete;
+    OrderArchive& operator=(const OrderArchive&) = delete;
+
+    ~OrderArchive() {
+        flush();
+        if (file) {
+            fclose(file);
+        }
+    }
+
+    // Switches to an append-only file; records archived so far go to the
+    // file first. Returns false if the file cannot be opened or written.
+    bool open(const string& path) {
+        FILE* opened = fopen(path.c_str(), "a+b");
+        if (!opened) {
+            return false;
+        }
+        if (file) {
+            fflush(file);
+            rewind(file);
+            vector<char> chunk(FLUSH_BYTES);
+            size_t read = 0;
+            while ((read = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+                if (fwrite(chunk.data(), 1, read, opened) != read) {
+                    fclose(opened);
+                    return false;
+                }
+            }
+            fclose(file);
+        }
+        file = opened;
+        return flush();
+    }
+
+    void append(const Order& order) {
+        appendString(order.getId());
+        appendString(order.getCustomer() ? order.getCustomer()->getId() : string());
+        appendString(order.getRestaurant() ? order.getRestaurant()->getId() : string());
+        appendString(order.getDeliveryAgent() ? order.getDeliveryAgent()->getId() : string());
+        appendValue(static_cast<uint8_t>(order.getStatus()));
+        appendValue(static_cast<uint32_t>(order.getItems().size()));
+        for (const OrderItem& item : order.getItems()) {
+            appendString(item.getMenuItem()->getId());
+            appendValue(static_cast<int32_t>(item.getQuantity()));
+        }
+        ++archivedCount;
+        if (buffer.size() >= FLUSH_BYTES) {
+            flush();
+        }
+    }
+
+    // Writes buffered records to the file, opening the temporary file on
+    // first use. On failure the records stay buffered.
+    bool flush() {
+        if (buffer.empty()) {
+            return true;
+        }
+        if (!file && !(file = tmpfile())) {
+            return false;
+        }
+        // forEach may have left the position mid-file; tmpfile() is not
+        // opened for appending.
+        fseek(file, 0, SEEK_END);
+        if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || fflush(file) != 0) {
+            return false;
+        }
+        buffer.clear();
+        return true;
+    }
+
+    uint64_t getArchivedCount() const { return archivedCount; }
+
+    // Calls visit(const ArchivedOrder&) for every archived order, oldest
+    // first. Streams the file FLUSH_BYTES at a time; meant for reporting,
+    // not the hot path.
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        vector<char> bytes;
+        size_t offset = 0;
+        bool fileLeft = file != nullptr;
+        bool bufferLeft = true;
+        if (file) {
+            fflush(file);
+            rewind(file);
+        }
+        ArchivedOrder order;
+        while (true) {
+            size_t recordStart = offset;
+            if (readRecord(bytes, offset, order)) {
+                visit(static_cast<const ArchivedOrder&>(order));
+                continue;
+            }
+            bytes.erase(bytes.begin(), bytes.begin() + recordStart);
+            offset = 0;
+            if (fileLeft) {
+                size_t size = bytes.size();
+                bytes.resize(size + FLUSH_BYTES);
+                size_t read = fread(bytes.data() + size, 1, FLUSH_BYTES, file);
+                bytes.resize(size + read);
+                fileLeft = read == FLUSH_BYTES;
+            } else if (bufferLeft) {
+                bytes.insert(bytes.end(), buffer.begin(), buffer.end());
+                bufferLeft = false;
+            } else {
+                return;
+            }
+        }
+    }
+
+private:
+    FILE* file = nullptr;
+    vector<char> buffer;
+    uint64_t archivedCount = 0;
+
+    template <typename T>
+    void appendValue(T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    void appendString(const string& value) {
+        appendValue(static_cast<uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    template <typename T>
+    static bool readValue(const vector<char>& bytes, size_t& offset, T& value) {
+        if (bytes.size() - offset < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, bytes.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    static bool readString(const vector<char>& bytes, size_t& offset, string& value) {
+        uint32_t length = 0;
+        if (!readValue(bytes, offset, length) || bytes.size() - offset < length) {
+            return false;
+        }
+        value.assign(bytes.data() + offset, length);
+        offset += length;
+        return true;
+    }
+
+    // False if bytes ends before the record at offset does.
+    static bool readRecord(const vector<char>& bytes, size_t& offset, ArchivedOrder& order) {
+        uint8_t status = 0;
+        uint32_t itemCount = 0;
+        if (!readString(bytes, offset, order.orderId) || !readString(bytes, offset, order.customerId) ||
+            !readString(bytes, offset, order.restaurantId) || !readString(bytes, offset, order.deliveryAgentId) ||
+            !readValue(bytes, offset, status) || !readValue(bytes, offset, itemCount)) {
+            return false;
+        }
+        order.status = static_cast<OrderStatus>(status);
+        order.items.clear();
+        for (uint32_t i = 0; i < itemCount; ++i) {
+            string menuItemId;
+            int32_t quantity = 0;
+            if (!readString(bytes, offset, menuItemId) || !readValue(bytes, offset, quantity)) {
+                return false;
+            }
+            order.items.emplace_back(move(menuItemId), quantity);
+        }
+        return true;
+    }
+};
+
+// AuctionSolver class: min-cost assignment of orders to agents by the
+// auction algorithm. Each order lists its candidate agents with costs and may
+// also stay unassigned at unassignedCost, which must exceed every candidate
+// cost; that option has no price, so the auction always terminates even when
+// agents are scarce. Unassigned orders bid for their best agent at a price
+// raised by the gap to their second-best option plus epsilon, and the highest
+// bid on each agent wins. Bids within a round are independent, so they are
+// computed on several threads (Jacobi auction). The total cost is within
+// orders * epsilon of the optimum.
+class AuctionSolver {
+public:
+    struct Candidate {
+        size_t agent;
+        double cost;
+    };
+
+    static constexpr int UNASSIGNED = -1;
+
+    // Agent index per order, or UNASSIGNED.
+    static vector<int> solve(const vector<vector<Candidate>>& candidates, size_t agentCount, double unassignedCost,
+                             double epsilon = 0.01, unsigned threadCount = max(1u, thread::hardware_concurrency())) {
+        size_t orderCount = candidates.size();
+        vector<int> agentOf(orderCount, UNASSIGNED);
+        vector<int> ownerOf(agentCount, UNASSIGNED);
+        vector<double> prices(agentCount, 0.0);
+        vector<size_t> bidders(orderCount);
+        for (size_t order = 0; order < orderCount; ++order) {
+            bidders[order] = order;
+        }
+        struct Bid {
+            int agent;
+            double price;
+        };
+        vector<Bid> bids(orderCount);
+        // Best bidder per agent in the current round.
+        vector<int> winnerOf(agentCount, UNASSIGNED);
+
+        while (!bidders.empty()) {
+            auto computeBids = [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    size_t order = bidders[i];
+                    double best = -unassignedCost;
+                    double secondBest = -unassignedCost;
+                    int bestAgent = UNASSIGNED;
+                    for (const Candidate& candidate : candidates[order]) {
+                        double value = -candidate.cost - prices[candidate.agent];
+                        if (value > best) {
+                            secondBest = best;
+                            best = value;
+                            bestAgent = static_cast<int>(candidate.agent);
+                        } else if (value > secondBest) {
+                            secondBest = value;
+                        }
+                    }
+                    bids[order] = {bestAgent, bestAgent == UNASSIGNED ? 0.0 : prices[bestAgent] + best - secondBest + epsilon};
+                }
+            };
+            size_t workers = min<size_t>(threadCount, bidders.size() / MIN_BIDDERS_PER_THREAD + 1);
+            vector<thread> threads;
+            for (size_t worker = 1; worker < workers; ++worker) {
+                threads.emplace_back(computeBids, bidders.size() * worker / workers, bidders.size() * (worker + 1) / workers);
+            }
+            computeBids(0, bidders.size() / workers);
+            for (thread& worker : threads) {
+                worker.join();
+            }
+
+            // Highest bid per agent wins; ties go to the earlier bidder. An
+            // order that prefers no agent is done, since nobody can outbid it.
+            vector<size_t> outbid;
+            vector<size_t> contested;
+            for (size_t order : bidders) {
+                const Bid& bid = bids[order];
+                if (bid.agent == UNASSIGNED) {
+                    continue;
+                }
+                int& winner = winnerOf[bid.agent];
+                if (winner == UNASSIGNED) {
+                    contested.push_back(bid.agent);
+                    winner = static_cast<int>(order);
+                } else if (bid.price > bids[winner].price) {
+                    outbid.push_back(static_cast<size_t>(winner));
+                    winner = static_cast<int>(order);
+                } else {
+                    outbid.push_back(order);
+                }
+            }
+            for (size_t agent : contested) {
+                size_t winner = static_cast<size_t>(winnerOf[agent]);
+                if (ownerOf[agent] != UNASSIGNED) {
+                    agentOf[ownerOf[agent]] = UNASSIGNED;
+                    outbid.push_back(static_cast<size_t>(ownerOf[agent]));
+                }
+                ownerOf[agent] = static_cast<int>(winner);
+                agentOf[winner] = static_cast<int>(agent);
+                prices[agent] = bids[winner].price;
+                winnerOf[agent] = UNASSIGNED;
+            }
+            bidders.swap(outbid);
+        }
+        return agentOf;
+    }
+
+private:
+    static constexpr size_t MIN_BIDDERS_PER_THREAD = 1024;
 };
 
-// FoodDeliveryService class (Singleton)
+// DispatchEngine class: collects confirmed orders for up to one window and
+// matches the batch against nearby available agents with AuctionSolver, so
+// a burst of orders gets a jointly cheap assignment instead of first come,
+// first served. Orders nobody can take stay queued for the next batch.
+// Not thread-safe; FoodDeliveryService calls it under its own lock.
+class DispatchEngine {
+public:
+    using Match = pair<OrderHandle, shared_ptr<DeliveryAgent>>;
+
+    // Windows shorter than this are not worth batching for; orders are then
+    // assigned greedily as they are confirmed.
+    static constexpr chrono::milliseconds MIN_BATCH_WINDOW{5};
+    static constexpr size_t CANDIDATES_PER_ORDER = 8;
+    static constexpr size_t MAX_BATCH_ORDERS = 4096;
+
+    explicit DispatchEngine(chrono::milliseconds window = chrono::milliseconds(0)) : window(window) {}
+
+    void setWindow(chrono::milliseconds window) { this->window = window; }
+    chrono::milliseconds getWindow() const { return window; }
+    bool isBatching() const { return window >= MIN_BATCH_WINDOW; }
+
+    // Queuing an order that is already queued does nothing.
+    void enqueue(OrderHandle order) {
+        if (!queued.insert(queueKey(order)).second) {
+            return;
+        }
+        if (pending.empty()) {
+            oldestPending = chrono::steady_clock::now();
+        }
+        pending.push_back(order);
+    }
+
+    // True once the oldest queued order has waited a full window or the
+    // batch is full.
+    bool isDue() const {
+        return !pending.empty() &&
+               (pending.size() >= MAX_BATCH_ORDERS || chrono::steady_clock::now() - oldestPending >= window);
+    }
+
+    // When the queued batch falls due on time alone; meaningless while
+    // nothing is queued.
+    chrono::steady_clock::time_point getDueTime() const { return oldestPending + window; }
+
+    size_t getPendingCount() const { return pending.size(); }
+
+    // Solves the queued batch against agents and returns the matches; the
+    // caller commits them. Unmatched orders stay queued; orders that have
+    // left the store, moved past CONFIRMED or got an agent meanwhile are
+    // dropped.
+    vector<Match> matchPending(const AgentGrid& agents, const OrderStore& orders) {
+        vector<Match> matches;
+        pending.erase(remove_if(pending.begin(), pending.end(),
+                                [this, &orders](OrderHandle handle) {
+                                    const Order* order = orders.get(handle);
+                                    if (order && order->getStatus() == OrderStatus::CONFIRMED && !order->getDeliveryAgent()) {
+                                        return false;
+                                    }
+                                    queued.erase(queueKey(handle));
+                                    return true;
+                                }),
+                      pending.end());
+        if (pending.empty()) {
+            return matches;
+        }
+        vector<shared_ptr<DeliveryAgent>> agentList;
+        unordered_map<DeliveryAgent*, size_t> agentIndex;
+        vector<vector<AuctionSolver::Candidate>> candidates(pending.size());
+        double maxCost = 0;
+        for (size_t order = 0; order < pending.size(); ++order) {
+            const Location& pickup = orders.get(pending[order])->getRestaurant()->getLocation();
+            for (const shared_ptr<DeliveryAgent>& agent : agents.nearest(pickup, CANDIDATES_PER_ORDER)) {
+                auto [it, inserted] = agentIndex.emplace(agent.get(), agentList.size());
+                if (inserted) {
+                    agentList.push_back(agent);
+                }
+                double cost = pickup.distanceTo(agent->getLocation());
+                candidates[order].push_back({it->second, cost});
+                maxCost = max(maxCost, cost);
+            }
+        }
+
+        vector<int> agentOf = AuctionSolver::solve(candidates, agentList.size(), 2 * maxCost + 1);
+        vector<OrderHandle> unmatched;
+        for (size_t order = 0; order < pending.size(); ++order) {
+            if (agentOf[order] == AuctionSolver::UNASSIGNED) {
+                unmatched.push_back(pending[order]);
+            } else {
+                queued.erase(queueKey(pending[order]));
+                matches.emplace_back(pending[order], agentList[agentOf[order]]);
+            }
+        }
+        pending.swap(unmatched);
+        oldestPending = chrono::steady_clock::now();
+        return matches;
+    }
+
+private:
+    static uint64_t queueKey(OrderHandle order) { return static_cast<uint64_t>(order.generation) << 32 | order.slot; }
+
+    chrono::milliseconds window;
+    vector<OrderHandle> pending;
+    // queueKey of every order in pending.
+    unordered_set<uint64_t> queued;
+    chrono::steady_clock::time_point oldestPending;
+};
+
+// RecipientType enum
+enum class RecipientType {
+    CUSTOMER,
+    RESTAURANT,
+    DELIVERY_AGENT
+};
+
+// NotificationEvent struct: one order lifecycle change for one recipient
+struct NotificationEvent {
+    RecipientType recipientType = RecipientType::CUSTOMER;
+    string recipientId;
+    string orderId;
+    OrderStatus status = OrderStatus::PENDING;
+    // Stamped by NotificationPipeline::publish.
+    chrono::steady_clock::time_point publishedAt{};
+};
+
+// Notification struct: what a recipient is sent for one batch, holding the
+// latest status of each of their orders that changed
+struct Notification {
+    RecipientType recipientType;
+    string recipientId;
+    vector<pair<string, OrderStatus>> orderUpdates;
+};
+
+// NotificationSink class: delivery channel (SMS, push, ...). deliver() runs on
+// a pipeline worker thread and may block on I/O.
+class NotificationSink {
+public:
+    virtual ~NotificationSink() = default;
+    virtual void deliver(const vector<Notification>& batch) = 0;
+};
+
+// LocalNotificationSink class: keeps delivered notifications in memory, in
+// place of a real SMS or push gateway
+class LocalNotificationSink : public NotificationSink {
+public:
+    void deliver(const vector<Notification>& batch) override {
+        lock_guard<mutex> lock(deliveredMutex);
+        delivered.insert(delivered.end(), batch.begin(), batch.end());
+    }
+
+    vector<Notification> takeDelivered() {
+        lock_guard<mutex> lock(deliveredMutex);
+        vector<Notification> result;
+        result.swap(delivered);
+        return result;
+    }
+
+private:
+    mutex deliveredMutex;
+    vector<Notification> delivered;
+};
+
+// MpscQueue class: unbounded lock-free multi-producer, single-consumer queue
+// (Vyukov). push() is one atomic exchange and never blocks; pop() may report
+// empty while a push is halfway done, and that item is seen on a later pop().
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(new Node()), tail(head.load()) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        T discarded;
+        while (pop(discarded)) {
+        }
+        delete tail;
+    }
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = move(value);
+        Node* previous = head.exchange(node, memory_order_acq_rel);
+        previous->next.store(node, memory_order_release);
+    }
+
+    // Consumer thread only.
+    bool pop(T& value) {
+        Node* next = tail->next.load(memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    atomic<Node*> head;
+    Node* tail;
+};
+
+// NotificationMetrics struct
+struct NotificationMetrics {
+    uint64_t published = 0;
+    uint64_t delivered = 0;
+    // Events folded into a newer update for the same recipient and order
+    uint64_t coalesced = 0;
+    uint64_t batches = 0;
+    uint64_t queueDepth = 0;
+    double meanLatencyMicros = 0;
+    // Upper bound of the latency bucket holding the 99th percentile
+    double p99LatencyMicros = 0;
+    double maxLatencyMicros = 0;
+};
+
+// NotificationPipeline class: publish() puts an event on the lock-free queue
+// of one worker, picked by recipient so each recipient's events stay in order
+// on one thread, and returns at once. Every flushInterval each worker drains
+// its queue in batches of up to MAX_BATCH_EVENTS, coalesces each batch per
+// recipient (one Notification per recipient, latest status per order) and
+// hands it to the sink.
+// Publishers never take a lock or wait on the sink.
+class NotificationPipeline {
+public:
+    NotificationPipeline(shared_ptr<NotificationSink> sink, size_t workerCount = 2,
+                         chrono::milliseconds flushInterval = chrono::milliseconds(5))
+        : sink(move(sink)), flushInterval(flushInterval), shards(max<size_t>(1, workerCount)) {
+        for (auto& shard : shards) {
+            shard = make_unique<Shard>();
+        }
+        for (auto& shard : shards) {
+            shard->worker = thread(&NotificationPipeline::workerLoop, this, shard.get());
+        }
+    }
+
+    NotificationPipeline(const NotificationPipeline&) = delete;
+    NotificationPipeline& operator=(const NotificationPipeline&) = delete;
+
+    // Events still queued at shutdown are delivered before the workers exit.
+    ~NotificationPipeline() {
+        {
+            lock_guard<mutex> lock(stopMutex);
+            stopping = true;
+        }
+        stopRequested.notify_all();
+        for (auto& shard : shards) {
+            shard->worker.join();
+        }
+    }
+
+    void publish(NotificationEvent event) {
+        event.publishedAt = chrono::steady_clock::now();
+        size_t shard = hash<string>()(event.recipientId) % shards.size();
+        published.fetch_add(1, memory_order_relaxed);
+        shards[shard]->queue.push(move(event));
+    }
+
+    // Blocks until every event published before the call has been handed to
+    // the sink.
+    void flush() {
+        uint64_t target = published.load();
+        while (processed.load() < target) {
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+    }
+
+    NotificationMetrics getMetrics() const {
+        NotificationMetrics metrics;
+        metrics.published = published.load();
+        uint64_t done = processed.load();
+        metrics.queueDepth = metrics.published > done ? metrics.published - done : 0;
+        metrics.delivered = delivered.load();
+        metrics.coalesced = done - metrics.delivered;
+        metrics.batches = batches.load();
+        metrics.maxLatencyMicros = static_cast<double>(maxLatencyMicros.load());
+        if (done > 0) {
+            metrics.meanLatencyMicros = static_cast<double>(totalLatencyMicros.load()) / done;
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+                seen += latencyHistogram[bucket].load();
+                if (seen * 100 >= done * 99) {
+                    metrics.p99LatencyMicros = static_cast<double>(uint64_t(1) << bucket);
+                    break;
+                }
+            }
+        }
+        return metrics;
+    }
+
+private:
+    // Bucket b counts latencies below 2^b microseconds.
+    static constexpr size_t LATENCY_BUCKETS = 40;
+    static constexpr size_t MAX_BATCH_EVENTS = 4096;
+
+    struct Shard {
+        MpscQueue<NotificationEvent> queue;
+        thread worker;
+    };
+
+    shared_ptr<NotificationSink> sink;
+    chrono::milliseconds flushInterval;
+    vector<unique_ptr<Shard>> shards;
+    mutex stopMutex;
+    condition_variable stopRequested;
+    bool stopping = false;
+
+    atomic<uint64_t> published{0};
+    atomic<uint64_t> processed{0};
+    atomic<uint64_t> delivered{0};
+    atomic<uint64_t> batches{0};
+    atomic<uint64_t> totalLatencyMicros{0};
+    atomic<uint64_t> maxLatencyMicros{0};
+    array<atomic<uint64_t>, LATENCY_BUCKETS> latencyHistogram{};
+
+    void recordLatency(uint64_t micros) {
+        totalLatencyMicros.fetch_add(micros, memory_order_relaxed);
+        uint64_t seenMax = maxLatencyMicros.load(memory_order_relaxed);
+        while (micros > seenMax && !maxLatencyMicros.compare_exchange_weak(seenMax, micros, memory_order_relaxed)) {
+        }
+        size_t bucket = 0;
+        while (bucket + 1 < LATENCY_BUCKETS && (uint64_t(1) << bucket) <= micros) {
+            ++bucket;
+        }
+        latencyHistogram[bucket].fetch_add(1, memory_order_relaxed);
+    }
+
+    void workerLoop(Shard* shard) {
+        while (true) {
+            bool stop;
+            {
+                unique_lock<mutex> lock(stopMutex);
+                stop = stopRequested.wait_for(lock, flushInterval, [this]() { return stopping; });
+            }
+            while (drainBatch(*shard)) {
+            }
+            if (stop) {
+                return;
+            }
+        }
+    }
+
+    // Sends up to MAX_BATCH_EVENTS queued events; false if there were none.
+    bool drainBatch(Shard& shard) {
+        vector<Notification> batch;
+        // Recipient -> index in batch; (recipient, order) -> index in its updates
+        unordered_map<string, size_t> byRecipient;
+        unordered_map<string, size_t> byOrder;
+        vector<chrono::steady_clock::time_point> publishTimes;
+        NotificationEvent event;
+        while (publishTimes.size() < MAX_BATCH_EVENTS && shard.queue.pop(event)) {
+            string recipientKey = to_string(static_cast<int>(event.recipientType)) + ':' + event.recipientId;
+            auto [recipient, newRecipient] = byRecipient.emplace(recipientKey, batch.size());
+            if (newRecipient) {
+                batch.push_back(Notification{event.recipientType, event.recipientId, {}});
+            }
+            vector<pair<string, OrderStatus>>& updates = batch[recipient->second].orderUpdates;
+            auto [order, newOrder] = byOrder.emplace(recipientKey + '/' + event.orderId, updates.size());
+            if (newOrder) {
+                updates.emplace_back(event.orderId, event.status);
+            } else {
+                updates[order->second].second = event.status;
+            }
+            publishTimes.push_back(event.publishedAt);
+        }
+        if (publishTimes.empty()) {
+            return false;
+        }
+
+        size_t updateCount = 0;
+        for (const Notification& notification : batch) {
+            updateCount += notification.orderUpdates.size();
+        }
+        try {
+            sink->deliver(batch);
+        } catch (...) {
+            // A failing channel must not take the worker down; the batch is dropped.
+        }
+        auto now = chrono::steady_clock::now();
+        for (auto publishedAt : publishTimes) {
+            recordLatency(static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(now - publishedAt).count()));
+        }
+        delivered.fetch_add(updateCount, memory_order_relaxed);
+        batches.fetch_add(1, memory_order_relaxed);
+        processed.fetch_add(publishTimes.size(), memory_order_release);
+        return true;
+    }
+};
+
+// FoodDeliveryService class (Singleton). The dispatch timer shares the
+// dispatch queue, the available-agent grid and the order store with the
+// public calls, so those sit behind dispatchMutex; registration and id
+// lookups do not take it and are expected to happen before orders flow.
+// Orders leave the service only as copies.
 class FoodDeliveryService {
 public:
     static FoodDeliveryService& getInstance() {
@@ -138,91 +1182,464 @@ public:
         return instance;
     }
 
-    void registerCustomer(const shared_ptr<Customer>& customer) { customers[customer->getId()] = customer; }
-    void registerRestaurant(const shared_ptr<Restaurant>& restaurant) { restaurants[restaurant->getId()] = restaurant; }
-    void registerDeliveryAgent(const shared_ptr<DeliveryAgent>& agent) { deliveryAgents[agent->getId()] = agent; }
+    // Registering an id again replaces the earlier entity under the same
+    // handle.
+    EntityId registerCustomer(const shared_ptr<Customer>& customer) {
+        return store(customerIds, customers, customer);
+    }
+
+    // Also records which restaurant serves each of its current menu items.
+    EntityId registerRestaurant(const shared_ptr<Restaurant>& restaurant) {
+        EntityId handle = store(restaurantIds, restaurants, restaurant);
+        unique_lock<shared_mutex> lock(menuIndexMutex);
+        for (const shared_ptr<MenuItem>& item : restaurant->getMenu()->items) {
+            recordMenuItem(item, handle);
+        }
+        return handle;
+    }
 
-    vector<shared_ptr<Restaurant>> getAvailableRestaurants() {
-        vector<shared_ptr<Restaurant>> result;
-        for (auto& [id, restaurant] : restaurants) {
-            result.push_back(restaurant);
+    EntityId registerDeliveryAgent(const shared_ptr<DeliveryAgent>& agent) {
+        lock_guard<mutex> lock(dispatchMutex);
+        availableAgents.remove(deliveryAgentIds.find(agent->getId()));
+        EntityId handle = store(deliveryAgentIds, deliveryAgents, agent);
+        if (agent->isAvailable()) {
+            availableAgents.insert(agent);
         }
-        return result;
+        return handle;
     }
 
-    shared_ptr<Order> placeOrder(const string& customerId, const string& restaurantId, const vector<shared_ptr<OrderItem>>& items) {
-        auto customer = customers[customerId];
-        auto restaurant = restaurants[restaurantId];
-        if (customer && restaurant) {
-            auto order = make_shared<Order>(generateOrderId(), customer, restaurant);
+    // String ids are resolved here, at the edge; NO_ENTITY if unknown.
+    EntityId findCustomer(const string& customerId) const {
+        return customerIds.find(customerId);
+    }
+
+    EntityId findRestaurant(const string& restaurantId) const {
+        return restaurantIds.find(restaurantId);
+    }
+
+    EntityId findDeliveryAgent(const string& agentId) const {
+        return deliveryAgentIds.find(agentId);
+    }
+
+    // Menu edits on registered restaurants go through the service, so the
+    // item index below follows them. Returns false if the restaurant is
+    // unknown.
+    bool addMenuItem(const string& restaurantId, const shared_ptr<MenuItem>& item) {
+        return addMenuItem(restaurantIds.find(restaurantId), item);
+    }
+
+    bool addMenuItem(EntityId restaurant, const shared_ptr<MenuItem>& item) {
+        if (restaurant >= restaurants.size()) {
+            return false;
+        }
+        unique_lock<shared_mutex> lock(menuIndexMutex);
+        recordMenuItem(item, restaurant);
+        restaurants[restaurant]->addMenuItem(item);
+        return true;
+    }
+
+    bool removeMenuItem(const string& restaurantId, const shared_ptr<MenuItem>& item) {
+        return removeMenuItem(restaurantIds.find(restaurantId), item);
+    }
+
+    // The index keeps pointing at the restaurant, whose menu no longer
+    // has the item, so lookups miss until it is added somewhere again.
+    bool removeMenuItem(EntityId restaurant, const shared_ptr<MenuItem>& item) {
+        if (restaurant >= restaurants.size()) {
+            return false;
+        }
+        unique_lock<shared_mutex> lock(menuIndexMutex);
+        restaurants[restaurant]->removeMenuItem(item);
+        return true;
+    }
+
+    // Resolved through the serving restaurant's current menu; nullptr if no
+    // registered restaurant serves the item.
+    shared_ptr<MenuItem> getMenuItem(const string& menuItemId) const {
+        shared_lock<shared_mutex> lock(menuIndexMutex);
+        EntityId handle = menuItemIds.find(menuItemId);
+        if (handle == NO_ENTITY) {
+            return nullptr;
+        }
+        return restaurants[menuItemRestaurants[handle]]->getMenu()->find(menuItemId);
+    }
+
+    // Location pings from the agent app; available agents move in the grid.
+    void updateDeliveryAgentLocation(const string& agentId, const Location& location) {
+        updateDeliveryAgentLocation(deliveryAgentIds.find(agentId), location);
+    }
+
+    void updateDeliveryAgentLocation(EntityId agent, const Location& location) {
+        if (agent < deliveryAgents.size()) {
+            lock_guard<mutex> lock(dispatchMutex);
+            availableAgents.moveAgent(deliveryAgents[agent], location);
+        }
+    }
+
+    void setDeliveryAgentAvailable(const string& agentId, bool available) {
+        setDeliveryAgentAvailable(deliveryAgentIds.find(agentId), available);
+    }
+
+    void setDeliveryAgentAvailable(EntityId agent, bool available) {
+        if (agent < deliveryAgents.size()) {
+            lock_guard<mutex> lock(dispatchMutex);
+            setAgentAvailable(deliveryAgents[agent], available);
+        }
+    }
+
+    // Confirmed orders are batched for this long before being matched to
+    // agents; below DispatchEngine::MIN_BATCH_WINDOW they are assigned
+    // greedily on confirmation. While batching, a background timer
+    // dispatches each batch once its window has elapsed.
+    void setDispatchWindow(chrono::milliseconds window) {
+        lock_guard<mutex> lock(dispatchMutex);
+        dispatchEngine.setWindow(window);
+        if (!dispatchEngine.isBatching()) {
+            dispatchQueuedOrders();
+        } else if (!dispatchTimer.joinable()) {
+            dispatchTimer = thread(&FoodDeliveryService::runDispatchTimer, this);
+        }
+        dispatchWake.notify_one();
+    }
+
+    // Dispatches the queued batch if its window has elapsed or the batch is
+    // full. Runs on every confirmation and from the dispatch timer.
+    void pollDispatch() {
+        lock_guard<mutex> lock(dispatchMutex);
+        pollQueuedOrders();
+    }
+
+    // Matches the queued batch now and commits every match before
+    // notifying anyone.
+    void dispatchPendingOrders() {
+        lock_guard<mutex> lock(dispatchMutex);
+        dispatchQueuedOrders();
+    }
+
+    NotificationMetrics getNotificationMetrics() const { return notifications.getMetrics(); }
+
+    // Waits for queued notifications and returns what the local sink has
+    // delivered since the last call.
+    vector<Notification> takeDeliveredNotifications() {
+        notifications.flush();
+        return notificationSink->takeDelivered();
+    }
+
+    vector<shared_ptr<DeliveryAgent>> findNearestAvailableAgents(const Location& location, size_t k) const {
+        lock_guard<mutex> lock(dispatchMutex);
+        return availableAgents.nearest(location, k);
+    }
+
+    vector<shared_ptr<Restaurant>> getAvailableRestaurants() {
+        return restaurants;
+    }
+
+    // Returns an invalid handle if the customer or restaurant is unknown.
+    OrderHandle placeOrder(const string& customerId, const string& restaurantId, const vector<OrderItem>& items) {
+        return placeOrder(customerIds.find(customerId), restaurantIds.find(restaurantId), items);
+    }
+
+    OrderHandle placeOrder(EntityId customerHandle, EntityId restaurantHandle, const vector<OrderItem>& items) {
+        if (customerHandle < customers.size() && restaurantHandle < restaurants.size()) {
+            const shared_ptr<Customer>& customer = customers[customerHandle];
+            const shared_ptr<Restaurant>& restaurant = restaurants[restaurantHandle];
+            lock_guard<mutex> lock(dispatchMutex);
+            maybeArchiveFinishedOrders();
+            OrderHandle handle = orderStore.create();
+            Order& order = *orderStore.get(handle);
+            order.reset(generateOrderId(), customer, restaurant);
             for (auto& item : items) {
-                order->addItem(item);
+                order.addItem(item);
             }
-            orders[order->getId()] = order;
+            orderIndex[order.getId()] = handle;
             notifyRestaurant(order);
-            cout << "Order placed: " << order->getId() << endl;
-            return order;
+            cout << "Order placed: " << order.getId() << endl;
+            return handle;
         }
-        return nullptr;
+        return OrderHandle{};
+    }
+
+    // A copy taken under the lock, since the dispatch timer may assign an
+    // agent to the stored order at any time; empty once the order has been
+    // archived.
+    optional<Order> getOrder(OrderHandle handle) const {
+        lock_guard<mutex> lock(dispatchMutex);
+        return copyOrder(handle);
+    }
+
+    optional<Order> getOrder(const string& orderId) const {
+        lock_guard<mutex> lock(dispatchMutex);
+        auto it = orderIndex.find(orderId);
+        return it == orderIndex.end() ? nullopt : copyOrder(it->second);
     }
 
     void updateOrderStatus(const string& orderId, OrderStatus status) {
-        auto order = orders[orderId];
+        lock_guard<mutex> lock(dispatchMutex);
+        auto it = orderIndex.find(orderId);
+        if (it != orderIndex.end()) {
+            setOrderStatus(it->second, status);
+        }
+    }
+
+    void updateOrderStatus(OrderHandle handle, OrderStatus status) {
+        lock_guard<mutex> lock(dispatchMutex);
+        setOrderStatus(handle, status);
+    }
+
+    void cancelOrder(const string& orderId) {
+        lock_guard<mutex> lock(dispatchMutex);
+        auto it = orderIndex.find(orderId);
+        if (it != orderIndex.end()) {
+            cancelStoredOrder(it->second);
+        }
+    }
+
+    void cancelOrder(OrderHandle handle) {
+        lock_guard<mutex> lock(dispatchMutex);
+        cancelStoredOrder(handle);
+    }
+
+    // Delivered and cancelled orders stay in the hot store for coldAfter,
+    // then move to the archive: an append-only file when archivePath is
+    // set, an anonymous temporary file otherwise. Returns false if the file
+    // cannot be opened.
+    bool setOrderArchival(chrono::milliseconds coldAfter, const string& archivePath = "") {
+        lock_guard<mutex> lock(dispatchMutex);
+        this->coldAfter = coldAfter;
+        return archivePath.empty() || orderArchive.open(archivePath);
+    }
+
+    // Moves every order that has been finished for coldAfter to the archive
+    // and frees its slot; returns how many moved. Runs on its own at most
+    // every ARCHIVE_INTERVAL as orders are placed, and can be called from a
+    // scheduler as well.
+    size_t archiveFinishedOrders() {
+        lock_guard<mutex> lock(dispatchMutex);
+        return archiveColdOrders();
+    }
+
+    size_t getHotOrderCount() const {
+        lock_guard<mutex> lock(dispatchMutex);
+        return orderStore.size();
+    }
+
+    OrderArchive& getOrderArchive() {
+        return orderArchive;
+    }
+
+private:
+    static constexpr chrono::seconds ARCHIVE_INTERVAL{1};
+
+    // Entities indexed by handle; registration is the only way in, so every
+    // slot below an interner's size() is filled.
+    IdInterner customerIds;
+    IdInterner restaurantIds;
+    IdInterner deliveryAgentIds;
+    vector<shared_ptr<Customer>> customers;
+    vector<shared_ptr<Restaurant>> restaurants;
+    vector<shared_ptr<DeliveryAgent>> deliveryAgents;
+    // Menu items are owned by their restaurant's menu; only the restaurant
+    // last given each one is kept here. Written by registerRestaurant and
+    // the menu edits under menuIndexMutex.
+    IdInterner menuItemIds;
+    vector<EntityId> menuItemRestaurants;
+    mutable shared_mutex menuIndexMutex;
+    // Orders keep a map rather than an interner: they are archived within
+    // minutes, and their ids must leave memory with them.
+    OrderStore orderStore;
+    unordered_map<string, OrderHandle> orderIndex;
+    // Finished orders in the order they finished, awaiting archival.
+    deque<pair<OrderHandle, chrono::steady_clock::time_point>> finishedOrders;
+    OrderArchive orderArchive;
+    chrono::milliseconds coldAfter = chrono::minutes(5);
+    chrono::steady_clock::time_point lastArchiveRun = chrono::steady_clock::now();
+    uint64_t nextOrderNumber = 1000;
+    AgentGrid availableAgents;
+    DispatchEngine dispatchEngine;
+    shared_ptr<LocalNotificationSink> notificationSink = make_shared<LocalNotificationSink>();
+    NotificationPipeline notifications{notificationSink};
+    // Guards dispatchEngine, availableAgents, the order store and its index,
+    // finishedOrders and the archive.
+    mutable mutex dispatchMutex;
+    condition_variable dispatchWake;
+    bool stopping = false;
+    // Started by the first setDispatchWindow that turns batching on.
+    thread dispatchTimer;
+
+    FoodDeliveryService() = default;
+
+    ~FoodDeliveryService() {
+        {
+            lock_guard<mutex> lock(dispatchMutex);
+            stopping = true;
+        }
+        dispatchWake.notify_one();
+        if (dispatchTimer.joinable()) {
+            dispatchTimer.join();
+        }
+    }
+
+    // Sleeps until the queued batch falls due and dispatches it, so the last
+    // orders of a burst do not wait for the next confirmation. Dispatching
+    // resets the batch clock, so orders no agent can take are retried once
+    // per window rather than in a spin.
+    void runDispatchTimer() {
+        unique_lock<mutex> lock(dispatchMutex);
+        while (!stopping) {
+            if (!dispatchEngine.isBatching() || dispatchEngine.getPendingCount() == 0) {
+                dispatchWake.wait(lock);
+            } else if (chrono::steady_clock::now() >= dispatchEngine.getDueTime()) {
+                dispatchQueuedOrders();
+            } else {
+                dispatchWake.wait_until(lock, dispatchEngine.getDueTime());
+            }
+        }
+    }
+
+    void notifyCustomer(const Order& order) {
+        notifications.publish({RecipientType::CUSTOMER, order.getCustomer()->getId(), order.getId(), order.getStatus()});
+    }
+
+    void notifyRestaurant(const Order& order) {
+        notifications.publish({RecipientType::RESTAURANT, order.getRestaurant()->getId(), order.getId(), order.getStatus()});
+    }
+
+    // The helpers below expect dispatchMutex to be held.
+
+    optional<Order> copyOrder(OrderHandle handle) const {
+        const Order* order = orderStore.get(handle);
+        return order ? optional<Order>(*order) : nullopt;
+    }
+
+    void setOrderStatus(OrderHandle handle, OrderStatus status) {
+        Order* order = orderStore.get(handle);
         if (order) {
             order->setStatus(status);
-            notifyCustomer(order);
+            notifyCustomer(*order);
             if (status == OrderStatus::CONFIRMED) {
-                assignDeliveryAgent(order);
+                if (dispatchEngine.isBatching()) {
+                    dispatchEngine.enqueue(handle);
+                    pollQueuedOrders();
+                    dispatchWake.notify_one();
+                } else {
+                    assignDeliveryAgent(*order);
+                }
+            } else if (status == OrderStatus::DELIVERED && order->getDeliveryAgent()) {
+                setAgentAvailable(order->getDeliveryAgent(), true);
+            }
+            if (order->isFinished()) {
+                finishedOrders.emplace_back(handle, chrono::steady_clock::now());
             }
         }
     }
 
-    void cancelOrder(const string& orderId) {
-        auto order = orders[orderId];
+    void cancelStoredOrder(OrderHandle handle) {
+        Order* order = orderStore.get(handle);
         if (order && order->getStatus() == OrderStatus::PENDING) {
             order->setStatus(OrderStatus::CANCELLED);
-            notifyCustomer(order);
-            notifyRestaurant(order);
+            finishedOrders.emplace_back(handle, chrono::steady_clock::now());
+            notifyCustomer(*order);
+            notifyRestaurant(*order);
             cout << "Order cancelled: " << order->getId() << endl;
         }
     }
 
-private:
-    unordered_map<string, shared_ptr<Customer>> customers;
-    unordered_map<string, shared_ptr<Restaurant>> restaurants;
-    unordered_map<string, shared_ptr<Order>> orders;
-    unordered_map<string, shared_ptr<DeliveryAgent>> deliveryAgents;
+    void pollQueuedOrders() {
+        if (dispatchEngine.isDue()) {
+            dispatchQueuedOrders();
+        }
+    }
 
-    FoodDeliveryService() = default;
+    void dispatchQueuedOrders() {
+        vector<DispatchEngine::Match> matches = dispatchEngine.matchPending(availableAgents, orderStore);
+        for (auto& [order, agent] : matches) {
+            setAgentAvailable(agent, false);
+            orderStore.get(order)->assignDeliveryAgent(agent);
+        }
+        for (auto& [order, agent] : matches) {
+            notifyDeliveryAgent(*orderStore.get(order));
+        }
+    }
 
-    void notifyCustomer(const shared_ptr<Order>& order) {
-        // Notify customer about order status
+    // Goes through the agent itself rather than the deliveryAgents table,
+    // which registration may be growing on another thread.
+    void setAgentAvailable(const shared_ptr<DeliveryAgent>& agent, bool available) {
+        agent->setAvailable(available);
+        if (available) {
+            availableAgents.insert(agent);
+        } else {
+            availableAgents.remove(agent->getHandle());
+        }
     }
 
-    void notifyRestaurant(const shared_ptr<Order>& order) {
-        // Notify restaurant about new order
+    // Picks the available agent nearest to the restaurant.
+    void assignDeliveryAgent(Order& order) {
+        auto nearest = availableAgents.nearest(order.getRestaurant()->getLocation(), 1);
+        if (!nearest.empty()) {
+            setAgentAvailable(nearest.front(), false);
+            order.assignDeliveryAgent(nearest.front());
+            notifyDeliveryAgent(order);
+        }
     }
 
-    void assignDeliveryAgent(const shared_ptr<Order>& order) {
-        for (auto& [id, agent] : deliveryAgents) {
-            if (agent->isAvailable()) {
-                agent->setAvailable(false);
-                order->assignDeliveryAgent(agent);
-                notifyDeliveryAgent(order);
-                break;
-            }
+    void notifyDeliveryAgent(const Order& order) {
+        notifications.publish({RecipientType::DELIVERY_AGENT, order.getDeliveryAgent()->getId(), order.getId(), order.getStatus()});
+    }
+
+    template <typename Entity>
+    static EntityId store(IdInterner& ids, vector<shared_ptr<Entity>>& entities, const shared_ptr<Entity>& entity) {
+        EntityId handle = ids.intern(entity->getId());
+        if (handle == entities.size()) {
+            entities.push_back(entity);
+        } else {
+            entities[handle] = entity;
+        }
+        entity->setHandle(handle);
+        return handle;
+    }
+
+    // Called before the item is published in the restaurant's menu, so
+    // its handle is set while nobody else can read it.
+    void recordMenuItem(const shared_ptr<MenuItem>& item, EntityId restaurant) {
+        EntityId handle = menuItemIds.intern(item->getId());
+        if (handle == menuItemRestaurants.size()) {
+            menuItemRestaurants.push_back(restaurant);
+        } else {
+            menuItemRestaurants[handle] = restaurant;
+        }
+        if (item->getHandle() != handle) {
+            item->setHandle(handle);
         }
     }
 
-    void notifyDeliveryAgent(const shared_ptr<Order>& order) {
-        // Notify delivery agent about assigned order
+    void maybeArchiveFinishedOrders() {
+        if (chrono::steady_clock::now() - lastArchiveRun >= ARCHIVE_INTERVAL) {
+            archiveColdOrders();
+        }
+    }
+
+    size_t archiveColdOrders() {
+        auto cutoff = chrono::steady_clock::now() - coldAfter;
+        size_t archived = 0;
+        while (!finishedOrders.empty() && finishedOrders.front().second <= cutoff) {
+            OrderHandle handle = finishedOrders.front().first;
+            finishedOrders.pop_front();
+            const Order* order = orderStore.get(handle);
+            if (!order) {
+                continue;
+            }
+            orderArchive.append(*order);
+            orderIndex.erase(order->getId());
+            orderStore.release(handle);
+            ++archived;
+        }
+        lastArchiveRun = chrono::steady_clock::now();
+        return archived;
     }
 
+    // Sequential, so ids stay unique however many orders a day brings.
     string generateOrderId() {
-        static random_device rd;
-        static mt19937 gen(rd());
-        static uniform_int_distribution<> dis(1000, 9999);
-        return "ORD" + to_string(dis(gen));
+        return "ORD" + to_string(nextOrderNumber++);
     }
 };
 
@@ -241,38 +1658,74 @@ void runDemo() {
         make_shared<MenuItem>("M001", "Burger", "Delicious burger", 9.99),
         make_shared<MenuItem>("M002", "Pizza", "Cheesy pizza", 12.99)
     };
-    auto restaurant1 = make_shared<Restaurant>("R001", "Restaurant 1", "Address 1", restaurant1Menu);
+    auto restaurant1 = make_shared<Restaurant>("R001", "Restaurant 1", "Address 1", restaurant1Menu, Location{2.0, 3.0});
     deliveryService.registerRestaurant(restaurant1);
 
     vector<shared_ptr<MenuItem>> restaurant2Menu = {
         make_shared<MenuItem>("M003", "Sushi", "Fresh sushi", 15.99),
         make_shared<MenuItem>("M004", "Ramen", "Delicious ramen", 10.99)
     };
-    auto restaurant2 = make_shared<Restaurant>("R002", "Restaurant 2", "Address 2", restaurant2Menu);
+    auto restaurant2 = make_shared<Restaurant>("R002", "Restaurant 2", "Address 2", restaurant2Menu, Location{8.0, 1.5});
     deliveryService.registerRestaurant(restaurant2);
 
     // Register delivery agents
-    auto agent1 = make_shared<DeliveryAgent>("D001", "Agent 1", "9999999999");
-    auto agent2 = make_shared<DeliveryAgent>("D002", "Agent 2", "8888888888");
+    auto agent1 = make_shared<DeliveryAgent>("D001", "Agent 1", "9999999999", Location{7.5, 2.0});
+    auto agent2 = make_shared<DeliveryAgent>("D002", "Agent 2", "8888888888", Location{2.5, 2.5});
     deliveryService.registerDeliveryAgent(agent1);
     deliveryService.registerDeliveryAgent(agent2);
 
+    // Browse a menu; price changes show up in place, structural edits as a
+    // new snapshot version
+    restaurant1Menu[1]->setPrice(11.99);
+    deliveryService.addMenuItem(restaurant1->getId(), make_shared<MenuItem>("M005", "Fries", "Crispy fries", 3.49));
+    shared_ptr<const MenuSnapshot> menu = restaurant1->getMenu();
+    cout << "Menu of " << restaurant1->getId() << " (version " << menu->version << "):";
+    for (const shared_ptr<MenuItem>& item : menu->items) {
+        cout << " " << item->getName() << "=" << item->getPrice();
+    }
+    cout << endl;
+
     // Place an order
-    vector<shared_ptr<OrderItem>> orderItems = {
-        make_shared<OrderItem>(restaurant1Menu[0], 2),
-        make_shared<OrderItem>(restaurant1Menu[1], 1)
+    vector<OrderItem> orderItems = {
+        OrderItem(restaurant1Menu[0], 2),
+        OrderItem(restaurant1Menu[1], 1)
     };
-    auto order = deliveryService.placeOrder(customer1->getId(), restaurant1->getId(), orderItems);
+    OrderHandle order = deliveryService.placeOrder(customer1->getId(), restaurant1->getId(), orderItems);
 
-    // Update order status
-    deliveryService.updateOrderStatus(order->getId(), OrderStatus::CONFIRMED);
-    cout << "Order status updated: " << static_cast<int>(order->getStatus()) << endl;
+    // Update order status; confirmed orders are matched to agents in batches
+    deliveryService.setDispatchWindow(chrono::milliseconds(200));
+    deliveryService.updateOrderStatus(order, OrderStatus::CONFIRMED);
+    deliveryService.dispatchPendingOrders();
+    optional<Order> placed = deliveryService.getOrder(order);
+    cout << "Order status updated: " << static_cast<int>(placed->getStatus()) << endl;
+    cout << "Assigned delivery agent: " << placed->getDeliveryAgent()->getId() << endl;
 
     // Cancel an order
-    auto order2 = deliveryService.placeOrder(customer2->getId(), restaurant2->getId(), {
-        make_shared<OrderItem>(restaurant2Menu[0], 1)
+    OrderHandle order2 = deliveryService.placeOrder(customer2->getId(), restaurant2->getId(), {
+        OrderItem(restaurant2Menu[0], 1)
+    });
+    deliveryService.cancelOrder(order2);
+
+    // Notifications are sent in the background; wait for them and report
+    for (const Notification& notification : deliveryService.takeDeliveredNotifications()) {
+        cout << "Notified " << notification.recipientId << ":";
+        for (auto& [orderId, status] : notification.orderUpdates) {
+            cout << " " << orderId << "=" << static_cast<int>(status);
+        }
+        cout << endl;
+    }
+    NotificationMetrics metrics = deliveryService.getNotificationMetrics();
+    cout << "Notifications published: " << metrics.published << ", delivered: " << metrics.delivered
+         << ", coalesced: " << metrics.coalesced << ", queue depth: " << metrics.queueDepth << endl;
+
+    // Finished orders move from the hot store to the cold archive
+    deliveryService.setOrderArchival(chrono::milliseconds(0));
+    cout << "Orders archived: " << deliveryService.archiveFinishedOrders()
+         << ", still hot: " << deliveryService.getHotOrderCount() << endl;
+    deliveryService.getOrderArchive().forEach([](const ArchivedOrder& archived) {
+        cout << "Archived " << archived.orderId << " for " << archived.customerId << " with "
+             << archived.items.size() << " item(s)" << endl;
     });
-    deliveryService.cancelOrder(order2->getId());
 }
 
 int main() {
@@ -1,6 +1,7 @@
+#ifndef BOOK_H
+#define BOOK_H
+
 #include <string>
-#include "LibraryManager.cpp"
-#include "Member.cpp"
 
 class Book {
 private:
@@ -11,12 +12,20 @@ private:
     bool available;
 
 public:
+    Book() : isbn(""), title(""), author(""), publicationYear(0), available(true) {}
     Book(std::string isbn, std::string title, std::string author, int publicationYear)
         : isbn(isbn), title(title), author(author), publicationYear(publicationYear), available(true) {}
 
-    std::string getIsbn() const { return isbn; }
-    std::string getTitle() const { return title; }
-    std::string getAuthor() const { return author; }
+    const std::string& getIsbn() const { return isbn; }
+    const std::string& getTitle() const { return title; }
+    const std::string& getAuthor() const { return author; }
+    int getPublicationYear() const { return publicationYear; }
     bool isAvailable() const { return available; }
     void setAvailable(bool available) { this->available = available; }
+
+    bool operator==(const Book& other) const {
+        return isbn == other.isbn;
+    }
 };
+
+#endif // BOOK_H
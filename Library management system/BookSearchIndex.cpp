@@ -0,0 +1,375 @@
+#ifndef BOOKSEARCHINDEX_H
+#define BOOKSEARCHINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Book.cpp"
+
+using BookId = uint32_t;
+
+constexpr BookId NO_BOOK_ID = UINT32_MAX;
+
+// Where a match sits in ranked results: title matches before author-only
+// matches, then newer publication years first, then ascending ISBN so the
+// order is total. The rank of the last result on a page is the cursor for the
+// next one.
+struct SearchRank {
+    bool titleMatch = false;
+    int publicationYear = 0;
+    std::string isbn;
+};
+
+struct RankedMatches {
+    std::vector<BookId> ids;
+    bool hasMore = false;
+};
+
+// Trigram inverted index over book titles and authors. Every distinct
+// three-byte sequence of either field maps to a sorted posting list of book
+// ids. A keyword's trigrams narrow the catalog to a few candidates, which are
+// then checked with std::string::find, so results match a substring scan.
+// Ids are handed out in increasing order, which keeps the posting lists
+// sorted on append. A removed book only loses its live flag. Once more books
+// have died since the last purge than are live, dead ids are purged from the
+// lists and the live books renumbered densely in their old order, so each
+// purge is paid for by the removals before it and the id space stays within
+// twice the live catalog. Renumbering changes getIdGeneration().
+class BookSearchIndex {
+public:
+    static constexpr size_t GRAM_LENGTH = 3;
+
+    static uint32_t gramAt(const std::string& text, size_t offset) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(text[offset])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[offset + 1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[offset + 2]));
+    }
+
+    static void collectGrams(const std::string& text, std::vector<uint32_t>& grams) {
+        for (size_t offset = 0; offset + GRAM_LENGTH <= text.size(); ++offset) {
+            grams.push_back(gramAt(text, offset));
+        }
+    }
+
+    static bool matches(const Book& book, const std::string& keyword) {
+        return book.getTitle().find(keyword) != std::string::npos ||
+               book.getAuthor().find(keyword) != std::string::npos;
+    }
+
+private:
+    static constexpr uint32_t GRAM_SPACE = 1 << 24;
+    static constexpr size_t MIN_BULK_BOOKS = 1 << 16;
+
+    std::unordered_map<uint32_t, std::vector<BookId>> postings;
+    std::vector<const Book*> booksById;
+    std::unordered_map<std::string, BookId> idByIsbn;
+    size_t liveCount = 0;
+    // Removed ids still sitting in posting lists.
+    size_t deadCount = 0;
+    uint64_t idGeneration = 0;
+
+    void purgeDeadIds() {
+        std::vector<BookId> renumbered(booksById.size(), NO_BOOK_ID);
+        std::vector<const Book*> live;
+        live.reserve(liveCount);
+        for (BookId id = 0; id < booksById.size(); ++id) {
+            if (booksById[id]) {
+                renumbered[id] = static_cast<BookId>(live.size());
+                live.push_back(booksById[id]);
+            }
+        }
+        // The mapping is increasing, so the lists stay sorted.
+        for (auto it = postings.begin(); it != postings.end();) {
+            std::vector<BookId>& ids = it->second;
+            size_t kept = 0;
+            for (BookId id : ids) {
+                if (renumbered[id] != NO_BOOK_ID) {
+                    ids[kept++] = renumbered[id];
+                }
+            }
+            ids.resize(kept);
+            it = ids.empty() ? postings.erase(it) : std::next(it);
+        }
+        for (auto& [isbn, id] : idByIsbn) {
+            id = renumbered[id];
+        }
+        booksById.swap(live);
+        deadCount = 0;
+        ++idGeneration;
+    }
+
+    // Drops the ISBN's entry but leaves its id in the posting lists.
+    void markRemoved(const std::string& isbn) {
+        auto it = idByIsbn.find(isbn);
+        if (it == idByIsbn.end()) {
+            return;
+        }
+        booksById[it->second] = nullptr;
+        idByIsbn.erase(it);
+        --liveCount;
+        ++deadCount;
+    }
+
+public:
+    // Indexes a book stored elsewhere; the pointer must stay valid until the
+    // book is removed. Adding an ISBN again replaces the earlier entry.
+    BookId add(const Book* book) {
+        remove(book->getIsbn());
+        BookId id = static_cast<BookId>(booksById.size());
+        booksById.push_back(book);
+        idByIsbn[book->getIsbn()] = id;
+        ++liveCount;
+
+        std::vector<uint32_t> grams;
+        collectGrams(book->getTitle(), grams);
+        collectGrams(book->getAuthor(), grams);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        for (uint32_t gram : grams) {
+            postings[gram].push_back(id);
+        }
+        return id;
+    }
+
+    // Indexes many books at once. Each thread extracts the distinct trigrams
+    // of a contiguous slice of the batch; the pairs are then bucketed by gram
+    // with a counting sort over the 24-bit gram space, so every posting list
+    // is appended to once instead of once per book. Books already indexed
+    // are dropped up front and the lists purged at most once, so reloading a
+    // catalog costs the same as loading it. The books must have distinct
+    // ISBNs.
+    void addBulk(const std::vector<const Book*>& books,
+                 unsigned threadCount = std::max(1u, std::thread::hardware_concurrency())) {
+        if (books.size() < MIN_BULK_BOOKS) {
+            for (const Book* book : books) {
+                add(book);
+            }
+            return;
+        }
+        for (const Book* book : books) {
+            markRemoved(book->getIsbn());
+        }
+        if (deadCount > liveCount) {
+            purgeDeadIds();
+        }
+
+        // Per slice: the distinct grams of each book back to back, and where
+        // each book's grams end.
+        struct GramSlice {
+            std::vector<uint32_t> grams;
+            std::vector<size_t> ends;
+        };
+        size_t sliceCount = std::min<size_t>(threadCount, books.size() / MIN_BULK_BOOKS + 1);
+        size_t sliceSize = (books.size() + sliceCount - 1) / sliceCount;
+        std::vector<GramSlice> slices(sliceCount);
+        auto extract = [&](size_t slice) {
+            GramSlice& out = slices[slice];
+            size_t end = std::min(books.size(), (slice + 1) * sliceSize);
+            for (size_t i = slice * sliceSize; i < end; ++i) {
+                size_t begin = out.grams.size();
+                collectGrams(books[i]->getTitle(), out.grams);
+                collectGrams(books[i]->getAuthor(), out.grams);
+                std::sort(out.grams.begin() + begin, out.grams.end());
+                out.grams.erase(std::unique(out.grams.begin() + begin, out.grams.end()), out.grams.end());
+                out.ends.push_back(out.grams.size());
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t slice = 1; slice < sliceCount; ++slice) {
+            threads.emplace_back(extract, slice);
+        }
+        extract(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // offsets[gram] ends up as the end of that gram's bucket in ids.
+        std::vector<uint32_t> offsets(GRAM_SPACE + 1, 0);
+        for (const GramSlice& slice : slices) {
+            for (uint32_t gram : slice.grams) {
+                ++offsets[gram + 1];
+            }
+        }
+        for (size_t gram = 1; gram <= GRAM_SPACE; ++gram) {
+            offsets[gram] += offsets[gram - 1];
+        }
+        std::vector<BookId> ids(offsets[GRAM_SPACE]);
+        booksById.reserve(booksById.size() + books.size());
+        idByIsbn.reserve(idByIsbn.size() + books.size());
+        size_t bookIndex = 0;
+        for (const GramSlice& slice : slices) {
+            size_t begin = 0;
+            for (size_t end : slice.ends) {
+                const Book* book = books[bookIndex++];
+                BookId id = static_cast<BookId>(booksById.size());
+                booksById.push_back(book);
+                idByIsbn[book->getIsbn()] = id;
+                for (size_t i = begin; i < end; ++i) {
+                    ids[offsets[slice.grams[i]]++] = id;
+                }
+                begin = end;
+            }
+        }
+        liveCount += books.size();
+
+        for (uint32_t gram = 0; gram < GRAM_SPACE; ++gram) {
+            uint32_t begin = gram == 0 ? 0 : offsets[gram - 1];
+            if (offsets[gram] > begin) {
+                std::vector<BookId>& list = postings[gram];
+                list.insert(list.end(), ids.begin() + begin, ids.begin() + offsets[gram]);
+            }
+        }
+    }
+
+    void remove(const std::string& isbn) {
+        markRemoved(isbn);
+        if (deadCount > liveCount) {
+            purgeDeadIds();
+        }
+    }
+
+    // Changes whenever add, addBulk or remove renumbers the ids; ids obtained
+    // before that no longer name the same books.
+    uint64_t getIdGeneration() const { return idGeneration; }
+
+    // Ids in use, live or awaiting a purge.
+    size_t getIdSpace() const { return booksById.size(); }
+
+    // The id the ISBN is indexed under, or NO_BOOK_ID.
+    BookId idOf(const std::string& isbn) const {
+        auto it = idByIsbn.find(isbn);
+        return it == idByIsbn.end() ? NO_BOOK_ID : it->second;
+    }
+
+    const Book* get(BookId id) const {
+        return id < booksById.size() ? booksById[id] : nullptr;
+    }
+
+    // Ids of the books whose title or author contains keyword, in ascending
+    // id order.
+    std::vector<BookId> find(const std::string& keyword) const {
+        std::vector<BookId> result;
+        forEachMatch(keyword, [&result](BookId id, const Book&) { result.push_back(id); });
+        return result;
+    }
+
+    // The best `limit` matches ranked after `after` (from the top if null),
+    // best first, skipping the first `offset` of them. Matches are streamed
+    // through a bounded max-heap, so memory and sorting cost depend on
+    // offset + limit rather than on the number of matches; prefer a cursor
+    // over a large offset. hasMore says whether further matches exist.
+    RankedMatches findRanked(const std::string& keyword, size_t offset, size_t limit,
+                             const SearchRank* after = nullptr) const {
+        RankedMatches result;
+        if (limit == 0) {
+            return result;
+        }
+        struct Entry {
+            bool titleMatch;
+            int publicationYear;
+            const std::string* isbn;
+            BookId id;
+        };
+        auto ranksBefore = [](const Entry& a, const Entry& b) {
+            if (a.titleMatch != b.titleMatch) {
+                return a.titleMatch;
+            }
+            if (a.publicationYear != b.publicationYear) {
+                return a.publicationYear > b.publicationYear;
+            }
+            return *a.isbn < *b.isbn;
+        };
+        // One extra entry tells whether anything follows the page.
+        size_t keep = offset + limit + 1;
+        std::priority_queue<Entry, std::vector<Entry>, decltype(ranksBefore)> worstOnTop(ranksBefore);
+        Entry cursor{};
+        if (after) {
+            cursor = Entry{after->titleMatch, after->publicationYear, &after->isbn, 0};
+        }
+
+        forEachMatch(keyword, [&](BookId id, const Book& book) {
+            Entry entry{book.getTitle().find(keyword) != std::string::npos, book.getPublicationYear(),
+                        &book.getIsbn(), id};
+            if (after && !ranksBefore(cursor, entry)) {
+                return;
+            }
+            if (worstOnTop.size() < keep) {
+                worstOnTop.push(entry);
+            } else if (ranksBefore(entry, worstOnTop.top())) {
+                worstOnTop.pop();
+                worstOnTop.push(entry);
+            }
+        });
+
+        result.hasMore = worstOnTop.size() == keep;
+        if (result.hasMore) {
+            worstOnTop.pop();
+        }
+        std::vector<BookId> ranked(worstOnTop.size());
+        for (size_t i = ranked.size(); i-- > 0; worstOnTop.pop()) {
+            ranked[i] = worstOnTop.top().id;
+        }
+        if (offset < ranked.size()) {
+            result.ids.assign(ranked.begin() + offset, ranked.end());
+        }
+        return result;
+    }
+
+    SearchRank rankOf(BookId id, const std::string& keyword) const {
+        const Book& book = *booksById[id];
+        return SearchRank{book.getTitle().find(keyword) != std::string::npos, book.getPublicationYear(),
+                          book.getIsbn()};
+    }
+
+    // Calls visit(id, book) for every live book whose title or author
+    // contains keyword, in ascending id order. Keywords shorter than a
+    // trigram match most of the catalog anyway and are answered by checking
+    // every live book.
+    template <typename Visit>
+    void forEachMatch(const std::string& keyword, Visit visit) const {
+        if (keyword.size() < GRAM_LENGTH) {
+            for (BookId id = 0; id < booksById.size(); ++id) {
+                if (booksById[id] && matches(*booksById[id], keyword)) {
+                    visit(id, *booksById[id]);
+                }
+            }
+            return;
+        }
+
+        std::vector<uint32_t> grams;
+        collectGrams(keyword, grams);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        std::vector<const std::vector<BookId>*> lists;
+        for (uint32_t gram : grams) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) {
+                return;
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const std::vector<BookId>* a, const std::vector<BookId>* b) { return a->size() < b->size(); });
+
+        // Walk the shortest list and binary-search the rest for each id.
+        for (BookId id : *lists.front()) {
+            const Book* book = booksById[id];
+            if (!book) {
+                continue;
+            }
+            bool inAll = std::all_of(lists.begin() + 1, lists.end(), [id](const std::vector<BookId>* ids) {
+                return std::binary_search(ids->begin(), ids->end(), id);
+            });
+            if (inAll && matches(*book, keyword)) {
+                visit(id, *book);
+            }
+        }
+    }
+};
+
+#endif // BOOKSEARCHINDEX_H
@@ -0,0 +1,189 @@
+#ifndef CATALOGLOADER_H
+#define CATALOGLOADER_H
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "Book.cpp"
+#include "../Common/MappedFile.cpp"
+
+struct CatalogLoadStats {
+    size_t rowsLoaded = 0;
+    size_t rowsRejected = 0;
+    std::vector<size_t> rejectedLines;
+    double seconds = 0;
+
+    double getRowsPerSecond() const {
+        return seconds > 0 ? static_cast<double>(rowsLoaded + rowsRejected) / seconds : 0;
+    }
+};
+
+// Parses catalog dumps with one book per line: isbn,title,author,year. Fields
+// may be double-quoted, with "" standing for a quote inside them; a quoted
+// field cannot span lines. An optional header line starting with "isbn" is
+// skipped, as are blank lines. The file is memory-mapped and split at line
+// boundaries into one chunk per thread; malformed rows are counted and
+// skipped without stopping the run.
+class CatalogLoader {
+private:
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr size_t MAX_REPORTED_REJECTS = 100;
+
+    struct ChunkResult {
+        std::vector<Book> books;
+        size_t lineCount = 0;
+        size_t rejectedCount = 0;
+        std::vector<size_t> rejectedLines;
+    };
+
+    // Splits one line into fields; false if a quote is left open, text
+    // follows a closing quote, or the field count is wrong.
+    static bool splitFields(std::string_view line, std::string fields[FIELD_COUNT]) {
+        size_t fieldCount = 0;
+        size_t position = 0;
+        while (true) {
+            if (fieldCount == FIELD_COUNT) {
+                return false;
+            }
+            std::string& field = fields[fieldCount++];
+            field.clear();
+            if (position < line.size() && line[position] == '"') {
+                ++position;
+                while (true) {
+                    size_t quote = line.find('"', position);
+                    if (quote == std::string_view::npos) {
+                        return false;
+                    }
+                    field.append(line.substr(position, quote - position));
+                    position = quote + 1;
+                    if (position < line.size() && line[position] == '"') {
+                        field.push_back('"');
+                        ++position;
+                    } else {
+                        break;
+                    }
+                }
+                if (position < line.size() && line[position] != ',') {
+                    return false;
+                }
+            } else {
+                size_t comma = std::min(line.find(',', position), line.size());
+                field.assign(line.substr(position, comma - position));
+                position = comma;
+            }
+            if (position == line.size()) {
+                return fieldCount == FIELD_COUNT;
+            }
+            ++position;
+        }
+    }
+
+    static void parseChunk(const char* begin, const char* end, bool skipHeader, ChunkResult& result) {
+        std::string fields[FIELD_COUNT];
+        for (const char* lineStart = begin; lineStart < end;) {
+            const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+            const char* lineEnd = newline ? newline : end;
+            std::string_view line(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            size_t lineIndex = result.lineCount++;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.empty() || (skipHeader && lineIndex == 0 && isHeader(line))) {
+                continue;
+            }
+            int year = 0;
+            if (splitFields(line, fields) && !fields[0].empty() && parseYear(fields[3], year)) {
+                result.books.emplace_back(fields[0], fields[1], fields[2], year);
+            } else {
+                ++result.rejectedCount;
+                if (result.rejectedLines.size() < MAX_REPORTED_REJECTS) {
+                    result.rejectedLines.push_back(lineIndex);
+                }
+            }
+        }
+    }
+
+    static bool isHeader(std::string_view line) {
+        if (line.size() < 4) {
+            return false;
+        }
+        std::string prefix(line.substr(0, 4));
+        std::transform(prefix.begin(), prefix.end(), prefix.begin(), [](unsigned char c) { return std::tolower(c); });
+        return prefix == "isbn" && (line.size() == 4 || line[4] == ',');
+    }
+
+    static bool parseYear(const std::string& text, int& year) {
+        const char* end = text.data() + text.size();
+        auto [parsed, error] = std::from_chars(text.data(), end, year);
+        return error == std::errc() && parsed == end;
+    }
+
+public:
+    static unsigned defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Appends every well-formed row of the file to books, in file order.
+    // Returns false only if the file cannot be opened. Rejected line numbers
+    // (1-based) are reported for the first MAX_REPORTED_REJECTS rows.
+    static bool parseFile(const std::string& path, std::vector<Book>& books, CatalogLoadStats& stats,
+                          unsigned threadCount = defaultThreadCount()) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        const char* data = file.getData();
+        size_t size = file.getSize();
+        if (size == 0) {
+            return true;
+        }
+
+        std::vector<const char*> boundaries{data};
+        for (unsigned chunk = 1; chunk < threadCount; ++chunk) {
+            const char* guess = std::max(data + size * chunk / threadCount, boundaries.back());
+            const char* newline = static_cast<const char*>(std::memchr(guess, '\n', data + size - guess));
+            boundaries.push_back(newline ? newline + 1 : data + size);
+        }
+        boundaries.push_back(data + size);
+
+        std::vector<ChunkResult> results(boundaries.size() - 1);
+        std::vector<std::thread> threads;
+        for (size_t chunk = 1; chunk < results.size(); ++chunk) {
+            threads.emplace_back(parseChunk, boundaries[chunk], boundaries[chunk + 1], false, std::ref(results[chunk]));
+        }
+        parseChunk(boundaries[0], boundaries[1], true, results[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        size_t total = books.size();
+        for (const ChunkResult& result : results) {
+            total += result.books.size();
+        }
+        books.reserve(total);
+        size_t firstLine = 1;
+        for (ChunkResult& result : results) {
+            std::move(result.books.begin(), result.books.end(), std::back_inserter(books));
+            stats.rowsLoaded += result.books.size();
+            stats.rowsRejected += result.rejectedCount;
+            for (size_t line : result.rejectedLines) {
+                if (stats.rejectedLines.size() < MAX_REPORTED_REJECTS) {
+                    stats.rejectedLines.push_back(firstLine + line);
+                }
+            }
+            firstLine += result.lineCount;
+        }
+        return true;
+    }
+};
+
+#endif // CATALOGLOADER_H
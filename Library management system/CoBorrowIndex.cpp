@@ -0,0 +1,246 @@
+#ifndef COBORROWINDEX_H
+#define COBORROWINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "LoanTable.cpp"
+#include "../Common/MappedFile.cpp"
+#include "../Common/BinaryCodec.cpp"
+
+struct CoBorrowNeighbour {
+    BookHandle book;
+    uint32_t count;
+};
+
+// Sparse "members who borrowed this also borrowed" matrix, kept up to date
+// on every borrow. Each member remembers the last MAX_HISTORY distinct books
+// they borrowed; a new borrow bumps the pair count between the new book and
+// each of those, in both directions. A book keeps at most MAX_NEIGHBOURS
+// counters, sorted by count, and when a new neighbour arrives at a full list
+// it takes over the smallest counter (the Space-Saving scheme), so frequent
+// co-borrows are kept and counts near the bottom may be overestimates. A
+// borrow costs at most MAX_HISTORY * MAX_NEIGHBOURS steps and a top-k lookup
+// is a copy of the head of one list.
+class CoBorrowIndex {
+public:
+    static constexpr size_t MAX_NEIGHBOURS = 32;
+    static constexpr size_t MAX_HISTORY = 64;
+
+private:
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x31494243; // "CBI1"
+
+    // Oldest first; once full, next is the slot the following borrow
+    // overwrites.
+    struct History {
+        std::vector<BookHandle> books;
+        size_t next = 0;
+    };
+
+    std::vector<std::vector<CoBorrowNeighbour>> neighboursByBook;
+    std::vector<History> historyByMember;
+
+    void bump(BookHandle book, BookHandle neighbour) {
+        if (book >= neighboursByBook.size()) {
+            neighboursByBook.resize(book + 1);
+        }
+        std::vector<CoBorrowNeighbour>& list = neighboursByBook[book];
+        auto it = std::find_if(list.begin(), list.end(),
+                               [neighbour](const CoBorrowNeighbour& entry) { return entry.book == neighbour; });
+        if (it != list.end()) {
+            ++it->count;
+        } else if (list.size() < MAX_NEIGHBOURS) {
+            list.push_back(CoBorrowNeighbour{neighbour, 1});
+            return;
+        } else {
+            it = list.end() - 1;
+            *it = CoBorrowNeighbour{neighbour, it->count + 1};
+        }
+        for (; it != list.begin() && std::prev(it)->count < it->count; --it) {
+            std::iter_swap(it, std::prev(it));
+        }
+    }
+
+public:
+    void recordBorrow(MemberHandle member, BookHandle book) {
+        if (member >= historyByMember.size()) {
+            historyByMember.resize(member + 1);
+        }
+        History& history = historyByMember[member];
+        if (std::find(history.books.begin(), history.books.end(), book) != history.books.end()) {
+            return;
+        }
+        for (BookHandle earlier : history.books) {
+            bump(earlier, book);
+            bump(book, earlier);
+        }
+        if (history.books.size() < MAX_HISTORY) {
+            history.books.push_back(book);
+        } else {
+            history.books[history.next] = book;
+            history.next = (history.next + 1) % MAX_HISTORY;
+        }
+    }
+
+    // The k books most often borrowed by the same members as book, most
+    // frequent first.
+    std::vector<CoBorrowNeighbour> topNeighbours(BookHandle book, size_t k) const {
+        if (book >= neighboursByBook.size()) {
+            return {};
+        }
+        const std::vector<CoBorrowNeighbour>& list = neighboursByBook[book];
+        return std::vector<CoBorrowNeighbour>(list.begin(), list.begin() + std::min(k, list.size()));
+    }
+
+    // Snapshot layout: magic, the ISBNs and member ids of every handle the
+    // loan table knows, each book's neighbour list and each member's history
+    // (oldest first) in handle order, and a trailing checksum. Handles are
+    // only meaningful within one process, so load() maps them back through
+    // the ids. Written to a temp file and renamed.
+    bool save(const std::string& path, const LoanTable& loans) const {
+        std::vector<char> buffer;
+        BinaryWriter writer(buffer);
+        writer.write(SNAPSHOT_MAGIC);
+        writer.write(static_cast<uint64_t>(loans.getBookCount()));
+        for (BookHandle book = 0; book < loans.getBookCount(); ++book) {
+            writer.writeString(loans.getIsbn(book));
+        }
+        writer.write(static_cast<uint64_t>(loans.getMemberCount()));
+        for (MemberHandle member = 0; member < loans.getMemberCount(); ++member) {
+            writer.writeString(loans.getMemberId(member));
+        }
+        for (BookHandle book = 0; book < loans.getBookCount(); ++book) {
+            size_t count = book < neighboursByBook.size() ? neighboursByBook[book].size() : 0;
+            writer.write(static_cast<uint32_t>(count));
+            for (size_t i = 0; i < count; ++i) {
+                writer.write(neighboursByBook[book][i].book);
+                writer.write(neighboursByBook[book][i].count);
+            }
+        }
+        for (MemberHandle member = 0; member < loans.getMemberCount(); ++member) {
+            if (member >= historyByMember.size()) {
+                writer.write(static_cast<uint32_t>(0));
+                continue;
+            }
+            const History& history = historyByMember[member];
+            writer.write(static_cast<uint32_t>(history.books.size()));
+            for (size_t i = 0; i < history.books.size(); ++i) {
+                writer.write(history.books[(history.next + i) % history.books.size()]);
+            }
+        }
+        writer.write(checksum(buffer.data(), buffer.size()));
+
+        std::string tempPath = path + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        // The bytes must be on disk before the rename publishes them, or a
+        // crash could leave a truncated index under the real name.
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && syncToDisk(file);
+        written = std::fclose(file) == 0 && written;
+        std::error_code error;
+        if (!written) {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    // Replaces the index with a snapshot. Books and members loans does not
+    // know are dropped rather than interned, so a stale snapshot cannot add
+    // handles. Leaves the index untouched if the file is missing or damaged.
+    bool load(const std::string& path, const LoanTable& loans) {
+        MappedFile mapped;
+        if (!mapped.open(path) || mapped.getSize() < sizeof(uint32_t)) {
+            return false;
+        }
+        size_t bodySize = mapped.getSize() - sizeof(uint32_t);
+        BinaryReader trailer(mapped.getData() + bodySize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(mapped.getData(), bodySize)) {
+            return false;
+        }
+        BinaryReader reader(mapped.getData(), bodySize);
+        if (reader.read<uint32_t>() != SNAPSHOT_MAGIC) {
+            return false;
+        }
+        // Every string costs at least its length prefix, which bounds the
+        // counts before anything is allocated.
+        auto readStringCount = [&reader]() {
+            uint64_t count = reader.read<uint64_t>();
+            return std::min<uint64_t>(count, reader.remaining() / sizeof(uint32_t));
+        };
+        std::vector<std::string> isbns(readStringCount());
+        for (std::string& isbn : isbns) {
+            isbn = reader.readString();
+        }
+        std::vector<std::string> memberIds(readStringCount());
+        for (std::string& memberId : memberIds) {
+            memberId = reader.readString();
+        }
+
+        std::vector<std::vector<CoBorrowNeighbour>> neighbours(isbns.size());
+        std::vector<std::vector<BookHandle>> histories(memberIds.size());
+        auto readBook = [&reader, &isbns]() {
+            BookHandle book = reader.read<BookHandle>();
+            return book < isbns.size() ? book : NO_HANDLE;
+        };
+        for (std::vector<CoBorrowNeighbour>& list : neighbours) {
+            for (uint32_t i = reader.read<uint32_t>(); i > 0 && reader.ok(); --i) {
+                BookHandle book = readBook();
+                list.push_back(CoBorrowNeighbour{book, reader.read<uint32_t>()});
+            }
+        }
+        for (std::vector<BookHandle>& history : histories) {
+            for (uint32_t i = reader.read<uint32_t>(); i > 0 && reader.ok(); --i) {
+                history.push_back(readBook());
+            }
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+
+        std::vector<BookHandle> bookHandles;
+        for (const std::string& isbn : isbns) {
+            bookHandles.push_back(loans.findBook(isbn));
+        }
+        std::vector<MemberHandle> memberHandles;
+        for (const std::string& memberId : memberIds) {
+            memberHandles.push_back(loans.findMember(memberId));
+        }
+        neighboursByBook.assign(loans.getBookCount(), {});
+        historyByMember.assign(loans.getMemberCount(), {});
+        auto known = [&bookHandles](BookHandle book) { return book != NO_HANDLE && bookHandles[book] != NO_HANDLE; };
+        for (size_t book = 0; book < neighbours.size(); ++book) {
+            if (bookHandles[book] == NO_HANDLE) {
+                continue;
+            }
+            std::vector<CoBorrowNeighbour>& list = neighboursByBook[bookHandles[book]];
+            for (const CoBorrowNeighbour& entry : neighbours[book]) {
+                if (known(entry.book) && list.size() < MAX_NEIGHBOURS) {
+                    list.push_back(CoBorrowNeighbour{bookHandles[entry.book], entry.count});
+                }
+            }
+        }
+        for (size_t member = 0; member < histories.size(); ++member) {
+            if (memberHandles[member] == NO_HANDLE) {
+                continue;
+            }
+            History& history = historyByMember[memberHandles[member]];
+            for (BookHandle book : histories[member]) {
+                if (known(book) && history.books.size() < MAX_HISTORY) {
+                    history.books.push_back(bookHandles[book]);
+                }
+            }
+        }
+        return true;
+    }
+};
+
+#endif // COBORROWINDEX_H
@@ -0,0 +1,235 @@
+#ifndef COLUMNARCATALOG_H
+#define COLUMNARCATALOG_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Book.cpp"
+
+using BookRow = uint32_t;
+
+// ISBN packed into a fixed-width, NUL-padded key, wide enough for a
+// hyphenated ISBN-13.
+struct IsbnKey {
+    static constexpr size_t SIZE = 20;
+    std::array<char, SIZE> bytes{};
+
+    bool operator==(const IsbnKey& other) const { return bytes == other.bytes; }
+};
+
+// Catalog layout with one column per Book field instead of one heap node per
+// book. Titles and authors are appended to a single character arena and
+// referenced by offset and length; ISBNs are stored as fixed-width keys and
+// looked up through an open-addressing table of row numbers. A substring
+// scan therefore walks contiguous memory, and a book costs a few dozen bytes
+// plus its text. Rows are dense: removing a book moves the last row into its
+// place, so row numbers are only stable until the next removal.
+//
+// It mirrors LibraryManager's add, remove, get and search operations but is
+// not LibraryManager's store: the search index, search pages and
+// recommendations hand out pointers to stored Book objects that stay put and
+// are updated in place on borrow, and rows here neither hold Book objects
+// nor stay put. columnarDemo checks the two against each other.
+class ColumnarCatalog {
+private:
+    std::vector<IsbnKey> isbns;
+    std::vector<uint32_t> titleOffsets;
+    std::vector<uint32_t> titleLengths;
+    std::vector<uint32_t> authorOffsets;
+    std::vector<uint32_t> authorLengths;
+    std::vector<int32_t> publicationYears;
+    std::vector<uint8_t> availability;
+    std::string arena;
+    size_t deadArenaBytes = 0;
+
+    // Slot holds row + 1; 0 marks an empty slot. Kept at most half full.
+    std::vector<BookRow> slots;
+
+    static uint64_t hash(const IsbnKey& key) {
+        uint64_t value = 14695981039346656037ULL;
+        for (char byte : key.bytes) {
+            value = (value ^ static_cast<unsigned char>(byte)) * 1099511628211ULL;
+        }
+        return value;
+    }
+
+    size_t slotOf(const IsbnKey& key) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = hash(key) & mask;
+        while (slots[slot] != 0 && !(isbns[slots[slot] - 1] == key)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rehash(size_t slotCount) {
+        slots.assign(slotCount, 0);
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            slots[slotOf(isbns[row])] = row + 1;
+        }
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    void eraseSlot(size_t slot) {
+        size_t mask = slots.size() - 1;
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; slots[next] != 0; next = (next + 1) & mask) {
+            size_t home = hash(isbns[slots[next] - 1]) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = 0;
+    }
+
+    uint32_t appendText(const std::string& text) {
+        uint32_t offset = static_cast<uint32_t>(arena.size());
+        arena.append(text);
+        return offset;
+    }
+
+    void compactArena() {
+        std::string compacted;
+        compacted.reserve(arena.size() - deadArenaBytes);
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            uint32_t titleOffset = static_cast<uint32_t>(compacted.size());
+            compacted.append(arena, titleOffsets[row], titleLengths[row]);
+            uint32_t authorOffset = static_cast<uint32_t>(compacted.size());
+            compacted.append(arena, authorOffsets[row], authorLengths[row]);
+            titleOffsets[row] = titleOffset;
+            authorOffsets[row] = authorOffset;
+        }
+        arena.swap(compacted);
+        deadArenaBytes = 0;
+    }
+
+public:
+    static bool packIsbn(std::string_view isbn, IsbnKey& key) {
+        if (isbn.size() > IsbnKey::SIZE || isbn.find('\0') != std::string_view::npos) {
+            return false;
+        }
+        key.bytes.fill('\0');
+        std::memcpy(key.bytes.data(), isbn.data(), isbn.size());
+        return true;
+    }
+
+    // Adds or replaces a book. Fails for ISBNs wider than IsbnKey::SIZE.
+    bool addBook(const Book& book) {
+        IsbnKey key;
+        if (!packIsbn(book.getIsbn(), key)) {
+            return false;
+        }
+        removeBook(book.getIsbn());
+        if ((isbns.size() + 1) * 2 > slots.size()) {
+            rehash(std::max<size_t>(16, slots.size() * 2));
+        }
+        isbns.push_back(key);
+        titleOffsets.push_back(appendText(book.getTitle()));
+        titleLengths.push_back(static_cast<uint32_t>(book.getTitle().size()));
+        authorOffsets.push_back(appendText(book.getAuthor()));
+        authorLengths.push_back(static_cast<uint32_t>(book.getAuthor().size()));
+        publicationYears.push_back(book.getPublicationYear());
+        availability.push_back(book.isAvailable());
+        slots[slotOf(key)] = static_cast<BookRow>(isbns.size());
+        return true;
+    }
+
+    void removeBook(std::string_view isbn) {
+        IsbnKey key;
+        if (slots.empty() || !packIsbn(isbn, key)) {
+            return;
+        }
+        size_t slot = slotOf(key);
+        if (slots[slot] == 0) {
+            return;
+        }
+        BookRow row = slots[slot] - 1;
+        BookRow last = static_cast<BookRow>(isbns.size() - 1);
+        deadArenaBytes += titleLengths[row] + authorLengths[row];
+        eraseSlot(slot);
+        if (row != last) {
+            slots[slotOf(isbns[last])] = row + 1;
+            isbns[row] = isbns[last];
+            titleOffsets[row] = titleOffsets[last];
+            titleLengths[row] = titleLengths[last];
+            authorOffsets[row] = authorOffsets[last];
+            authorLengths[row] = authorLengths[last];
+            publicationYears[row] = publicationYears[last];
+            availability[row] = availability[last];
+        }
+        isbns.pop_back();
+        titleOffsets.pop_back();
+        titleLengths.pop_back();
+        authorOffsets.pop_back();
+        authorLengths.pop_back();
+        publicationYears.pop_back();
+        availability.pop_back();
+        if (deadArenaBytes > arena.size() / 2) {
+            compactArena();
+        }
+    }
+
+    // Row of the book, or size() if it is not in the catalog.
+    BookRow findRow(std::string_view isbn) const {
+        IsbnKey key;
+        if (slots.empty() || !packIsbn(isbn, key)) {
+            return static_cast<BookRow>(isbns.size());
+        }
+        BookRow stored = slots[slotOf(key)];
+        return stored == 0 ? static_cast<BookRow>(isbns.size()) : stored - 1;
+    }
+
+    Book getBook(std::string_view isbn) const {
+        BookRow row = findRow(isbn);
+        if (row == isbns.size()) {
+            throw std::runtime_error("Book not found");
+        }
+        Book book{std::string(getIsbn(row)), std::string(getTitle(row)), std::string(getAuthor(row)),
+                  publicationYears[row]};
+        book.setAvailable(availability[row] != 0);
+        return book;
+    }
+
+    // Rows of the books whose title or author contains keyword, scanning the
+    // arena directly.
+    std::vector<BookRow> searchBooks(std::string_view keyword) const {
+        std::vector<BookRow> rows;
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            if (getTitle(row).find(keyword) != std::string_view::npos ||
+                getAuthor(row).find(keyword) != std::string_view::npos) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    size_t size() const { return isbns.size(); }
+
+    std::string_view getIsbn(BookRow row) const {
+        const char* bytes = isbns[row].bytes.data();
+        const void* padding = std::memchr(bytes, '\0', IsbnKey::SIZE);
+        return std::string_view(bytes, padding ? static_cast<const char*>(padding) - bytes : IsbnKey::SIZE);
+    }
+    std::string_view getTitle(BookRow row) const { return std::string_view(arena).substr(titleOffsets[row], titleLengths[row]); }
+    std::string_view getAuthor(BookRow row) const { return std::string_view(arena).substr(authorOffsets[row], authorLengths[row]); }
+    int getPublicationYear(BookRow row) const { return publicationYears[row]; }
+    bool isAvailable(BookRow row) const { return availability[row] != 0; }
+    void setAvailable(BookRow row, bool available) { availability[row] = available; }
+
+    // Bytes held by the columns, the arena and the lookup table.
+    size_t getMemoryUsage() const {
+        return isbns.capacity() * sizeof(IsbnKey) +
+               (titleOffsets.capacity() + titleLengths.capacity() + authorOffsets.capacity() +
+                authorLengths.capacity()) * sizeof(uint32_t) +
+               publicationYears.capacity() * sizeof(int32_t) + availability.capacity() +
+               arena.capacity() + slots.capacity() * sizeof(BookRow);
+    }
+};
+
+#endif // COLUMNARCATALOG_H
@@ -0,0 +1,268 @@
+#ifndef CONCURRENTLIBRARYMANAGER_H
+#define CONCURRENTLIBRARYMANAGER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Book.cpp"
+#include "Member.cpp"
+#include "BookSearchIndex.cpp"
+#include "LoanTable.cpp"
+
+// Read-copy-update cell. Writers build a new immutable T and publish it;
+// readers keep using whatever version they loaded. read() caches the latest
+// version per thread, so a reader only touches the shared pointer (and its
+// reference count) after a publish, and otherwise does one atomic load.
+template <typename T>
+class SnapshotCell {
+private:
+    static std::atomic<uint64_t>& versionCounter() {
+        static std::atomic<uint64_t> counter{0};
+        return counter;
+    }
+
+    std::shared_ptr<const T> current;
+    std::atomic<uint64_t> version;
+
+public:
+    explicit SnapshotCell(std::shared_ptr<const T> initial)
+        : current(std::move(initial)), version(versionCounter().fetch_add(1) + 1) {}
+
+    std::shared_ptr<const T> load() const {
+        return std::atomic_load(&current);
+    }
+
+    void publish(std::shared_ptr<const T> next) {
+        std::atomic_store(&current, std::move(next));
+        version.store(versionCounter().fetch_add(1) + 1, std::memory_order_release);
+    }
+
+    // The reference stays valid until this thread's next read() of any
+    // SnapshotCell<T>. Versions are unique per process, so a cell created at
+    // a reused address never matches a stale cache entry.
+    const T& read() const {
+        thread_local struct {
+            const SnapshotCell* cell = nullptr;
+            uint64_t version = 0;
+            std::shared_ptr<const T> snapshot;
+        } cache;
+        uint64_t latest = version.load(std::memory_order_acquire);
+        if (cache.cell != this || cache.version != latest) {
+            cache.snapshot = load();
+            cache.cell = this;
+            cache.version = latest;
+        }
+        return *cache.snapshot;
+    }
+};
+
+// Thread-safe counterpart of LibraryManager. The catalog and the member list
+// are RCU snapshots: searchBooks, getBook and lookups never lock, while
+// catalog and membership edits copy the snapshot under a writer mutex and
+// publish it, so they suit a read-mostly catalog (use addBooks for batches).
+// A book's availability is an atomic flag shared by all snapshots, claimed
+// with compare-and-swap on borrow. Each member's loans are guarded by that
+// member's own mutex, so borrows and returns for different members never
+// contend.
+class ConcurrentLibraryManager {
+private:
+    struct BookEntry {
+        Book book;
+        std::atomic<bool> available{true};
+
+        explicit BookEntry(const Book& book) : book(book), available(book.isAvailable()) {}
+    };
+
+    struct MemberEntry {
+        Member member;
+        std::mutex mutex;
+        std::array<std::shared_ptr<BookEntry>, LoanTable::MAX_LOANS_PER_MEMBER> loans;
+        size_t loanCount = 0;
+        // Set under mutex once the member is unregistered; a borrow that
+        // found the entry in an older snapshot must not add to its loans.
+        bool retired = false;
+
+        explicit MemberEntry(const Member& member) : member(member) {}
+    };
+
+    struct CatalogSnapshot {
+        std::unordered_map<std::string, std::shared_ptr<BookEntry>> books;
+        BookSearchIndex searchIndex;
+    };
+
+    using MemberSnapshot = std::unordered_map<std::string, std::shared_ptr<MemberEntry>>;
+
+    SnapshotCell<CatalogSnapshot> catalog{std::make_shared<const CatalogSnapshot>()};
+    SnapshotCell<MemberSnapshot> members{std::make_shared<const MemberSnapshot>()};
+    std::mutex writerMutex;
+
+    static Book currentState(const BookEntry& entry) {
+        Book book = entry.book;
+        book.setAvailable(entry.available.load(std::memory_order_relaxed));
+        return book;
+    }
+
+public:
+    static constexpr size_t MAX_BOOKS_PER_MEMBER = LoanTable::MAX_LOANS_PER_MEMBER;
+
+    void addBook(const Book& book) {
+        addBooks(std::vector<Book>{book});
+    }
+
+    // Publishes a single new catalog snapshot for the whole batch.
+    void addBooks(const std::vector<Book>& books) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        auto next = std::make_shared<CatalogSnapshot>(*catalog.load());
+        for (const Book& book : books) {
+            auto entry = std::make_shared<BookEntry>(book);
+            next->books[book.getIsbn()] = entry;
+            next->searchIndex.add(&entry->book);
+        }
+        catalog.publish(std::move(next));
+    }
+
+    // A member still holding the book keeps its entry alive until returning it.
+    void removeBook(const std::string& isbn) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        auto next = std::make_shared<CatalogSnapshot>(*catalog.load());
+        next->searchIndex.remove(isbn);
+        next->books.erase(isbn);
+        catalog.publish(std::move(next));
+    }
+
+    void registerMember(const Member& member) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        auto next = std::make_shared<MemberSnapshot>(*members.load());
+        (*next)[member.getMemberId()] = std::make_shared<MemberEntry>(member);
+        members.publish(std::move(next));
+    }
+
+    void unregisterMember(const std::string& memberId) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        auto next = std::make_shared<MemberSnapshot>(*members.load());
+        auto it = next->find(memberId);
+        if (it == next->end()) {
+            return;
+        }
+        std::shared_ptr<MemberEntry> member = it->second;
+        next->erase(it);
+        members.publish(std::move(next));
+        std::lock_guard<std::mutex> memberLock(member->mutex);
+        member->retired = true;
+        for (size_t i = 0; i < member->loanCount; ++i) {
+            member->loans[i]->available.store(true);
+            member->loans[i].reset();
+        }
+        member->loanCount = 0;
+    }
+
+    Book getBook(const std::string& isbn) const {
+        const CatalogSnapshot& snapshot = catalog.read();
+        auto it = snapshot.books.find(isbn);
+        if (it == snapshot.books.end()) {
+            throw std::runtime_error("Book not found");
+        }
+        return currentState(*it->second);
+    }
+
+    Member getMember(const std::string& memberId) const {
+        const MemberSnapshot& snapshot = members.read();
+        auto it = snapshot.find(memberId);
+        if (it == snapshot.end()) {
+            throw std::runtime_error("Member not found");
+        }
+        return it->second->member;
+    }
+
+    // Copies, since the snapshot the matches came from may be retired as soon
+    // as this returns.
+    std::vector<Book> searchBooks(const std::string& keyword) const {
+        const CatalogSnapshot& snapshot = catalog.read();
+        std::vector<Book> matchingBooks;
+        for (BookId id : snapshot.searchIndex.find(keyword)) {
+            const Book* book = snapshot.searchIndex.get(id);
+            matchingBooks.push_back(currentState(*snapshot.books.at(book->getIsbn())));
+        }
+        return matchingBooks;
+    }
+
+    size_t countMatches(const std::string& keyword) const {
+        return catalog.read().searchIndex.find(keyword).size();
+    }
+
+    bool borrowBook(const std::string& memberId, const std::string& isbn) {
+        std::shared_ptr<MemberEntry> member;
+        std::shared_ptr<BookEntry> book;
+        {
+            const MemberSnapshot& memberSnapshot = members.read();
+            auto memberIt = memberSnapshot.find(memberId);
+            if (memberIt == memberSnapshot.end()) {
+                return false;
+            }
+            member = memberIt->second;
+        }
+        {
+            const CatalogSnapshot& catalogSnapshot = catalog.read();
+            auto bookIt = catalogSnapshot.books.find(isbn);
+            if (bookIt == catalogSnapshot.books.end()) {
+                return false;
+            }
+            book = bookIt->second;
+        }
+
+        std::lock_guard<std::mutex> lock(member->mutex);
+        if (member->retired || member->loanCount == MAX_BOOKS_PER_MEMBER) {
+            return false;
+        }
+        bool expected = true;
+        if (!book->available.compare_exchange_strong(expected, false)) {
+            return false;
+        }
+        member->loans[member->loanCount++] = std::move(book);
+        return true;
+    }
+
+    bool returnBook(const std::string& memberId, const std::string& isbn) {
+        std::shared_ptr<MemberEntry> member;
+        {
+            const MemberSnapshot& memberSnapshot = members.read();
+            auto memberIt = memberSnapshot.find(memberId);
+            if (memberIt == memberSnapshot.end()) {
+                return false;
+            }
+            member = memberIt->second;
+        }
+
+        std::lock_guard<std::mutex> lock(member->mutex);
+        for (size_t i = 0; i < member->loanCount; ++i) {
+            if (member->loans[i]->book.getIsbn() == isbn) {
+                member->loans[i]->available.store(true);
+                size_t last = --member->loanCount;
+                if (i != last) {
+                    member->loans[i] = std::move(member->loans[last]);
+                }
+                member->loans[last].reset();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t getBorrowedCount(const std::string& memberId) const {
+        const MemberSnapshot& snapshot = members.read();
+        auto it = snapshot.find(memberId);
+        if (it == snapshot.end()) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(it->second->mutex);
+        return it->second->loanCount;
+    }
+};
+
+#endif // CONCURRENTLIBRARYMANAGER_H
@@ -1,38 +1,249 @@
+#ifndef LIBRARYMANAGER_H
+#define LIBRARYMANAGER_H
+
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
-#include "Member.cpp"
+#include <stdexcept>
 #include "Book.cpp"
+#include "Member.cpp"
+#include "BookSearchIndex.cpp"
+#include "SearchResultCache.cpp"
+#include "LoanTable.cpp"
+#include "TimingWheel.cpp"
+#include "CoBorrowIndex.cpp"
+#include "CatalogLoader.cpp"
+
+// One page of ranked search results. Pass cursor to searchBooksAfter for
+// the next page; it is only meaningful when hasMore is set.
+struct SearchPage {
+    std::vector<const Book*> books;
+    bool hasMore = false;
+    SearchRank cursor;
+};
+
+// Raised by advanceClock: a reminder shortly before a loan is due, or a
+// notice on the first day it is overdue.
+struct LoanEvent {
+    enum class Type { REMINDER, OVERDUE };
+
+    Type type;
+    std::string memberId;
+    std::string isbn;
+    int64_t dueDay;
+};
 
 class LibraryManager {
 private:
     std::unordered_map<std::string, Book> catalog;
     std::unordered_map<std::string, Member> members;
-    const int MAX_BOOKS_PER_MEMBER = 5;
+    BookSearchIndex searchIndex;
+    // Filled by the const search calls.
+    mutable SearchResultCache searchCache;
+    // The index id generation the cached results were built under.
+    uint64_t searchIdGeneration = 0;
+    LoanTable loans;
+    static constexpr size_t MAX_BOOKS_PER_MEMBER = LoanTable::MAX_LOANS_PER_MEMBER;
+    static constexpr int64_t LOAN_PERIOD_DAYS = 14;
+    static constexpr int64_t REMINDER_DAYS_BEFORE_DUE = 2;
+
+    // Days count from 0 when the library starts. Each loan arms two timers,
+    // 2 * book for its reminder and 2 * book + 1 for its overdue notice.
+    TimingWheel loanTimers;
+    std::vector<int64_t> dueDayByBook;
+    CoBorrowIndex coBorrows;
 
     LibraryManager() {}
 
+    static TimerId reminderTimer(BookHandle book) { return 2 * book; }
+    static TimerId overdueTimer(BookHandle book) { return 2 * book + 1; }
+
+    void startLoanTimers(BookHandle book) {
+        int64_t today = getToday();
+        int64_t dueDay = today + LOAN_PERIOD_DAYS;
+        if (book >= dueDayByBook.size()) {
+            dueDayByBook.resize(book + 1);
+        }
+        dueDayByBook[book] = dueDay;
+        if (dueDay - REMINDER_DAYS_BEFORE_DUE > today) {
+            loanTimers.schedule(reminderTimer(book), static_cast<uint64_t>(dueDay - REMINDER_DAYS_BEFORE_DUE));
+        }
+        loanTimers.schedule(overdueTimer(book), static_cast<uint64_t>(dueDay + 1));
+    }
+
+    void stopLoanTimers(BookHandle book) {
+        loanTimers.cancel(reminderTimer(book));
+        loanTimers.cancel(overdueTimer(book));
+    }
+
+    // Drops the book from cached search results while its old title and
+    // author are still around to find them.
+    void forgetIndexedBook(const std::string& isbn) {
+        BookId id = searchIndex.idOf(isbn);
+        if (id != NO_BOOK_ID) {
+            searchCache.bookRemoved(id, *searchIndex.get(id));
+        }
+    }
+
+    // Cached results hold index ids, which a purge renumbers.
+    void dropStaleSearchResults() {
+        if (searchIndex.getIdGeneration() != searchIdGeneration) {
+            searchIdGeneration = searchIndex.getIdGeneration();
+            searchCache.clear();
+        }
+    }
+
+    // Calls visit(id) for each match, from the result cache when possible.
+    template <typename Visit>
+    void forEachMatchingId(const std::string& keyword, Visit visit) const {
+        if (const std::vector<BookId>* cached = searchCache.find(keyword)) {
+            for (BookId id : *cached) {
+                visit(id);
+            }
+            return;
+        }
+        std::vector<BookId> ids = searchIndex.find(keyword);
+        for (BookId id : ids) {
+            visit(id);
+        }
+        searchCache.insert(keyword, ids);
+    }
+
+    SearchPage toPage(const std::string& keyword, const RankedMatches& matches) const {
+        SearchPage page;
+        page.hasMore = matches.hasMore;
+        for (BookId id : matches.ids) {
+            page.books.push_back(searchIndex.get(id));
+        }
+        if (!matches.ids.empty()) {
+            page.cursor = searchIndex.rankOf(matches.ids.back(), keyword);
+        }
+        return page;
+    }
+
 public:
     static LibraryManager& getInstance() {
         static LibraryManager instance;
         return instance;
     }
 
-    void addBook(const Book& book) { catalog[book.getIsbn()] = book; }
-    void removeBook(const std::string& isbn) { catalog.erase(isbn); }
-    Book getBook(const std::string& isbn) { return catalog[isbn]; }
-    void registerMember(const Member& member) { members[member.getMemberId()] = member; }
-    void unregisterMember(const std::string& memberId) { members.erase(memberId); }
-    Member getMember(const std::string& memberId) { return members[memberId]; }
+    void addBook(const Book& book) {
+        forgetIndexedBook(book.getIsbn());
+        Book& stored = catalog[book.getIsbn()];
+        stored = book;
+        searchCache.bookAdded(searchIndex.add(&stored), stored);
+        dropStaleSearchResults();
+        loans.internBook(book.getIsbn());
+    }
+
+    // Bulk variant of addBook: the catalog grows once and the search index is
+    // built in one pass. Later copies of an ISBN replace earlier ones.
+    void addBooks(const std::vector<Book>& books) {
+        catalog.reserve(catalog.size() + books.size());
+        std::vector<const Book*> stored;
+        stored.reserve(books.size());
+        std::unordered_set<const Book*> seen;
+        for (const Book& book : books) {
+            Book& slot = catalog[book.getIsbn()];
+            slot = book;
+            if (seen.insert(&slot).second) {
+                stored.push_back(&slot);
+            }
+            loans.internBook(book.getIsbn());
+        }
+        searchIndex.addBulk(stored);
+        searchCache.clear();
+        searchIdGeneration = searchIndex.getIdGeneration();
+    }
+
+    // Loads a catalog dump (see CatalogLoader for the format) and prints the
+    // load rate. Malformed rows are skipped and counted in the result.
+    CatalogLoadStats loadCatalog(const std::string& path, unsigned threadCount = CatalogLoader::defaultThreadCount()) {
+        CatalogLoadStats stats;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Book> books;
+        if (!CatalogLoader::parseFile(path, books, stats, threadCount)) {
+            std::cout << "Cannot open catalog file: " << path << std::endl;
+            return stats;
+        }
+        addBooks(books);
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Loaded " << stats.rowsLoaded << " books, rejected " << stats.rowsRejected << " rows, "
+             << static_cast<long long>(stats.getRowsPerSecond()) << " rows/s" << std::endl;
+        return stats;
+    }
+
+    void removeBook(const std::string& isbn) {
+        forgetIndexedBook(isbn);
+        searchIndex.remove(isbn);
+        dropStaleSearchResults();
+        catalog.erase(isbn);
+    }
+
+    Book getBook(const std::string& isbn) {
+        auto it = catalog.find(isbn);
+        if (it != catalog.end()) {
+            return it->second;
+        } else {
+            throw std::runtime_error("Book not found");
+        }
+    }
+    void registerMember(const Member& member) {
+        members[member.getMemberId()] = member;
+        loans.internMember(member.getMemberId());
+    }
+
+    // Also hands back every book the member still holds.
+    void unregisterMember(const std::string& memberId) {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        if (memberHandle != NO_HANDLE) {
+            while (loans.getLoanCount(memberHandle) > 0) {
+                BookHandle bookHandle = *loans.getLoans(memberHandle).begin();
+                loans.returnBook(memberHandle, bookHandle);
+                stopLoanTimers(bookHandle);
+                auto bookIt = catalog.find(loans.getIsbn(bookHandle));
+                if (bookIt != catalog.end()) {
+                    bookIt->second.setAvailable(true);
+                }
+            }
+        }
+        members.erase(memberId);
+    }
+
+    Member getMember(const std::string& memberId) {
+        auto it = members.find(memberId);
+        if (it != members.end()) {
+            return it->second;
+        } else {
+            throw std::runtime_error("Member not found");
+        }
+    }
 
     void borrowBook(const std::string& memberId, const std::string& isbn) {
-        Member& member = members[memberId];
-        Book& book = catalog[isbn];
+        auto memberIt = members.find(memberId);
+        auto bookIt = catalog.find(isbn);
+
+        if (memberIt == members.end()) {
+            std::cout << "Member not found." << std::endl;
+            return;
+        }
+        if (bookIt == catalog.end()) {
+            std::cout << "Book not found." << std::endl;
+            return;
+        }
 
-        if (book.isAvailable() && member.getBorrowedBooks().size() < MAX_BOOKS_PER_MEMBER) {
-            member.borrowBook(book);
+        Member& member = memberIt->second;
+        Book& book = bookIt->second;
+
+        MemberHandle memberHandle = loans.findMember(memberId);
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (book.isAvailable() && loans.borrowBook(memberHandle, bookHandle)) {
             book.setAvailable(false);
+            startLoanTimers(bookHandle);
+            coBorrows.recordBorrow(memberHandle, bookHandle);
             std::cout << "Book borrowed: " << book.getTitle() << " by " << member.getName() << std::endl;
         } else {
             std::cout << "Cannot borrow book." << std::endl;
@@ -40,21 +251,150 @@ public:
     }
 
     void returnBook(const std::string& memberId, const std::string& isbn) {
-        Member& member = members[memberId];
-        Book& book = catalog[isbn];
+        auto memberIt = members.find(memberId);
+        auto bookIt = catalog.find(isbn);
+
+        if (memberIt == members.end()) {
+            std::cout << "Member not found." << std::endl;
+            return;
+        }
+        if (bookIt == catalog.end()) {
+            std::cout << "Book not found." << std::endl;
+            return;
+        }
+
+        Member& member = memberIt->second;
+        Book& book = bookIt->second;
+
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (loans.returnBook(loans.findMember(memberId), bookHandle)) {
+            book.setAvailable(true);
+            stopLoanTimers(bookHandle);
+            std::cout << "Book returned: " << book.getTitle() << " by " << member.getName() << std::endl;
+        } else {
+            std::cout << "Book is not borrowed by this member." << std::endl;
+        }
+    }
+
+    size_t getBorrowedCount(const std::string& memberId) const {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        return memberHandle == NO_HANDLE ? 0 : loans.getLoanCount(memberHandle);
+    }
+
+    int64_t getToday() const {
+        return static_cast<int64_t>(loanTimers.getNow());
+    }
+
+    int64_t getDueDay(const std::string& isbn) const {
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (bookHandle == NO_HANDLE || loans.getHolder(bookHandle) == NO_HANDLE) {
+            throw std::runtime_error("Book is not on loan");
+        }
+        return dueDayByBook[bookHandle];
+    }
+
+    // Moves the library clock forward and returns the reminders and overdue
+    // notices that came due, oldest first. The cost depends on the loans that
+    // expire, not on how many are outstanding. The clock never moves back.
+    std::vector<LoanEvent> advanceClock(int64_t days) {
+        if (days < 0) {
+            throw std::runtime_error("Cannot move the library clock backwards");
+        }
+        std::vector<TimerId> fired;
+        loanTimers.advance(static_cast<uint64_t>(getToday() + days), fired);
+        std::vector<LoanEvent> events;
+        events.reserve(fired.size());
+        for (TimerId timer : fired) {
+            BookHandle bookHandle = timer / 2;
+            LoanEvent::Type type = timer == overdueTimer(bookHandle) ? LoanEvent::Type::OVERDUE : LoanEvent::Type::REMINDER;
+            events.push_back(LoanEvent{type, loans.getMemberId(loans.getHolder(bookHandle)), loans.getIsbn(bookHandle),
+                                       dueDayByBook[bookHandle]});
+        }
+        return events;
+    }
+
+    // "Members who borrowed this also borrowed": up to k catalog books most
+    // often borrowed by the same members as isbn, most frequent first.
+    std::vector<const Book*> getAlsoBorrowed(const std::string& isbn, size_t k) const {
+        std::vector<const Book*> books;
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (k == 0 || bookHandle == NO_HANDLE) {
+            return books;
+        }
+        for (const CoBorrowNeighbour& neighbour : coBorrows.topNeighbours(bookHandle, CoBorrowIndex::MAX_NEIGHBOURS)) {
+            auto bookIt = catalog.find(loans.getIsbn(neighbour.book));
+            if (bookIt != catalog.end()) {
+                books.push_back(&bookIt->second);
+                if (books.size() == k) {
+                    break;
+                }
+            }
+        }
+        return books;
+    }
 
-        member.returnBook(book);
-        book.setAvailable(true);
-        std::cout << "Book returned: " << book.getTitle() << " by " << member.getName() << std::endl;
+    bool saveCoBorrowSnapshot(const std::string& path) const {
+        return coBorrows.save(path, loans);
     }
 
-    std::vector<Book> searchBooks(const std::string& keyword) {
-        std::vector<Book> matchingBooks;
-        for (const auto& [isbn, book] : catalog) {
-            if (book.getTitle().find(keyword) != std::string::npos || book.getAuthor().find(keyword) != std::string::npos) {
-                matchingBooks.push_back(book);
+    bool loadCoBorrowSnapshot(const std::string& path) {
+        return coBorrows.load(path, loans);
+    }
+
+    // Calls visit(book) for each book the member holds, without copying.
+    template <typename Visit>
+    void forEachBorrowedBook(const std::string& memberId, Visit visit) const {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        if (memberHandle == NO_HANDLE) {
+            return;
+        }
+        for (BookHandle bookHandle : loans.getLoans(memberHandle)) {
+            auto bookIt = catalog.find(loans.getIsbn(bookHandle));
+            if (bookIt != catalog.end()) {
+                visit(bookIt->second);
             }
         }
+    }
+
+    // Books whose title or author contains keyword, served from the result
+    // cache or the trigram index. The pointers stay valid until the book is
+    // removed or re-added.
+    std::vector<const Book*> searchBooks(const std::string& keyword) const {
+        std::vector<const Book*> matchingBooks;
+        forEachMatchingId(keyword, [&](BookId id) { matchingBooks.push_back(searchIndex.get(id)); });
         return matchingBooks;
     }
+
+    // Ranked page of matches (see SearchRank), skipping the first offset.
+    // Cost grows with offset + limit, not with the number of matches.
+    SearchPage searchBooksPage(const std::string& keyword, size_t offset, size_t limit) const {
+        return toPage(keyword, searchIndex.findRanked(keyword, offset, limit));
+    }
+
+    // The next limit matches ranked after the cursor of a previous page.
+    SearchPage searchBooksAfter(const std::string& keyword, const SearchRank& cursor, size_t limit) const {
+        return toPage(keyword, searchIndex.findRanked(keyword, 0, limit, &cursor));
+    }
+
+    // Ids name the same books only until the next catalog edit.
+    std::vector<BookId> searchBookIds(const std::string& keyword) const {
+        std::vector<BookId> ids;
+        forEachMatchingId(keyword, [&ids](BookId id) { ids.push_back(id); });
+        return ids;
+    }
+
+    const SearchCacheStats& getSearchCacheStats() const {
+        return searchCache.getStats();
+    }
+
+    // Bounds the search cache by entry count and by ids held in total.
+    void setSearchCacheCapacity(size_t maxEntries, size_t maxIds) {
+        searchCache.setCapacity(maxEntries, maxIds);
+    }
+
+    const Book* getBookById(BookId id) const {
+        return searchIndex.get(id);
+    }
 };
+
+#endif // LIBRARYMANAGER_H
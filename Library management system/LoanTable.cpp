@@ -0,0 +1,121 @@
+#ifndef LOANTABLE_H
+#define LOANTABLE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using MemberHandle = uint32_t;
+using BookHandle = uint32_t;
+
+constexpr uint32_t NO_HANDLE = UINT32_MAX;
+
+// Who holds which book, keyed by dense handles. Handles are handed out when a
+// member registers or a book is added and stay the same for that member id or
+// ISBN from then on. Each member's loans sit in a fixed array and each book
+// remembers its slot in it, so borrowing, returning and counting are O(1) and
+// never allocate.
+class LoanTable {
+public:
+    static constexpr size_t MAX_LOANS_PER_MEMBER = 5;
+
+    // Non-owning view of one member's loans; invalidated by the next change.
+    class LoanView {
+    private:
+        const BookHandle* first;
+        const BookHandle* last;
+
+    public:
+        LoanView(const BookHandle* first, const BookHandle* last) : first(first), last(last) {}
+
+        const BookHandle* begin() const { return first; }
+        const BookHandle* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+    };
+
+private:
+    struct MemberLoans {
+        std::array<BookHandle, MAX_LOANS_PER_MEMBER> books;
+        uint8_t count = 0;
+    };
+
+    std::vector<MemberLoans> loansByMember;
+    std::vector<MemberHandle> holderByBook;
+    std::vector<uint8_t> slotByBook;
+    std::vector<std::string> isbnByBook;
+    std::vector<std::string> idByMember;
+    std::unordered_map<std::string, MemberHandle> memberHandles;
+    std::unordered_map<std::string, BookHandle> bookHandles;
+
+public:
+    MemberHandle internMember(const std::string& memberId) {
+        auto [it, inserted] = memberHandles.emplace(memberId, static_cast<MemberHandle>(loansByMember.size()));
+        if (inserted) {
+            loansByMember.emplace_back();
+            idByMember.push_back(memberId);
+        }
+        return it->second;
+    }
+
+    BookHandle internBook(const std::string& isbn) {
+        auto [it, inserted] = bookHandles.emplace(isbn, static_cast<BookHandle>(holderByBook.size()));
+        if (inserted) {
+            holderByBook.push_back(NO_HANDLE);
+            slotByBook.push_back(0);
+            isbnByBook.push_back(isbn);
+        }
+        return it->second;
+    }
+
+    MemberHandle findMember(const std::string& memberId) const {
+        auto it = memberHandles.find(memberId);
+        return it == memberHandles.end() ? NO_HANDLE : it->second;
+    }
+
+    BookHandle findBook(const std::string& isbn) const {
+        auto it = bookHandles.find(isbn);
+        return it == bookHandles.end() ? NO_HANDLE : it->second;
+    }
+
+    // Fails if the book is already lent out or the member is at the limit.
+    bool borrowBook(MemberHandle member, BookHandle book) {
+        MemberLoans& loans = loansByMember[member];
+        if (holderByBook[book] != NO_HANDLE || loans.count == MAX_LOANS_PER_MEMBER) {
+            return false;
+        }
+        loans.books[loans.count] = book;
+        slotByBook[book] = loans.count++;
+        holderByBook[book] = member;
+        return true;
+    }
+
+    // Fails if the member does not hold the book. The member's last loan
+    // moves into the freed slot.
+    bool returnBook(MemberHandle member, BookHandle book) {
+        if (holderByBook[book] != member) {
+            return false;
+        }
+        MemberLoans& loans = loansByMember[member];
+        BookHandle moved = loans.books[--loans.count];
+        loans.books[slotByBook[book]] = moved;
+        slotByBook[moved] = slotByBook[book];
+        holderByBook[book] = NO_HANDLE;
+        return true;
+    }
+
+    size_t getMemberCount() const { return idByMember.size(); }
+    size_t getBookCount() const { return isbnByBook.size(); }
+    size_t getLoanCount(MemberHandle member) const { return loansByMember[member].count; }
+    MemberHandle getHolder(BookHandle book) const { return holderByBook[book]; }
+    const std::string& getIsbn(BookHandle book) const { return isbnByBook[book]; }
+    const std::string& getMemberId(MemberHandle member) const { return idByMember[member]; }
+
+    LoanView getLoans(MemberHandle member) const {
+        const MemberLoans& loans = loansByMember[member];
+        return LoanView(loans.books.data(), loans.books.data() + loans.count);
+    }
+};
+
+#endif // LOANTABLE_H
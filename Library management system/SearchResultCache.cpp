@@ -0,0 +1,174 @@
+#ifndef SEARCHRESULTCACHE_H
+#define SEARCHRESULTCACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Book.cpp"
+#include "BookSearchIndex.cpp"
+
+struct SearchCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    // Cached lists updated in place by an add or remove instead of dropped.
+    uint64_t patches = 0;
+    size_t entries = 0;
+    size_t cachedIds = 0;
+
+    double getHitRate() const {
+        return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0;
+    }
+};
+
+// LRU cache of keyword -> matching book ids, in ascending id order like
+// BookSearchIndex::find. It is bounded both in entries and in the total
+// number of ids held; a result list larger than the id budget is never
+// admitted. Entries are kept exact rather than dropped when the catalog
+// changes: a keyword can only match a book that contains its first trigram,
+// so entries are also filed under that trigram, and adding or removing a
+// book only checks the entries filed under the book's own trigrams (plus the
+// few keywords shorter than a trigram) and patches their lists. Loans do not
+// change which books match, so borrowing and returning leave it alone.
+class SearchResultCache {
+private:
+    struct Entry {
+        std::string keyword;
+        std::vector<BookId> ids;
+    };
+
+    using EntryIt = std::list<Entry>::iterator;
+
+    size_t maxEntries;
+    size_t maxIds;
+    std::list<Entry> recency;
+    std::unordered_map<std::string, EntryIt> entriesByKeyword;
+    // Entries filed under their keyword's first trigram; keywords shorter
+    // than a trigram are filed under SHORT_KEYWORDS.
+    std::unordered_map<uint32_t, std::vector<EntryIt>> entriesByGram;
+    SearchCacheStats stats;
+
+    static constexpr uint32_t SHORT_KEYWORDS = UINT32_MAX;
+
+    static uint32_t firstGram(const std::string& keyword) {
+        return keyword.size() < BookSearchIndex::GRAM_LENGTH ? SHORT_KEYWORDS : BookSearchIndex::gramAt(keyword, 0);
+    }
+
+    void evict(EntryIt entry) {
+        std::vector<EntryIt>& filed = entriesByGram[firstGram(entry->keyword)];
+        auto position = std::find(filed.begin(), filed.end(), entry);
+        *position = filed.back();
+        filed.pop_back();
+        if (filed.empty()) {
+            entriesByGram.erase(firstGram(entry->keyword));
+        }
+        stats.cachedIds -= entry->ids.size();
+        entriesByKeyword.erase(entry->keyword);
+        recency.erase(entry);
+        --stats.entries;
+    }
+
+    void shrinkToFit() {
+        while (!recency.empty() && (stats.entries > maxEntries || stats.cachedIds > maxIds)) {
+            evict(std::prev(recency.end()));
+            ++stats.evictions;
+        }
+    }
+
+    // Calls patch(ids) for every cached list whose keyword matches book.
+    template <typename Patch>
+    void forEachAffected(const Book& book, Patch patch) {
+        if (recency.empty()) {
+            return;
+        }
+        std::vector<uint32_t> grams;
+        BookSearchIndex::collectGrams(book.getTitle(), grams);
+        BookSearchIndex::collectGrams(book.getAuthor(), grams);
+        grams.push_back(SHORT_KEYWORDS);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        for (uint32_t gram : grams) {
+            auto filed = entriesByGram.find(gram);
+            if (filed == entriesByGram.end()) {
+                continue;
+            }
+            for (EntryIt entry : filed->second) {
+                if (BookSearchIndex::matches(book, entry->keyword)) {
+                    patch(entry->ids);
+                    ++stats.patches;
+                }
+            }
+        }
+    }
+
+public:
+    SearchResultCache(size_t maxEntries = 4096, size_t maxIds = 1 << 22)
+        : maxEntries(maxEntries), maxIds(maxIds) {}
+
+    // The cached ids for keyword, or nullptr on a miss. The pointer is
+    // valid until the cache is next changed.
+    const std::vector<BookId>* find(const std::string& keyword) {
+        auto it = entriesByKeyword.find(keyword);
+        if (it == entriesByKeyword.end()) {
+            ++stats.misses;
+            return nullptr;
+        }
+        ++stats.hits;
+        recency.splice(recency.begin(), recency, it->second);
+        return &it->second->ids;
+    }
+
+    void insert(const std::string& keyword, const std::vector<BookId>& ids) {
+        if (entriesByKeyword.count(keyword) || ids.size() > maxIds || maxEntries == 0) {
+            return;
+        }
+        recency.push_front(Entry{keyword, ids});
+        entriesByKeyword[keyword] = recency.begin();
+        entriesByGram[firstGram(keyword)].push_back(recency.begin());
+        ++stats.entries;
+        stats.cachedIds += ids.size();
+        shrinkToFit();
+    }
+
+    // Call after the index gave book the id. Ids only grow, so appending
+    // keeps the lists sorted.
+    void bookAdded(BookId id, const Book& book) {
+        forEachAffected(book, [this, id](std::vector<BookId>& ids) {
+            ids.push_back(id);
+            ++stats.cachedIds;
+        });
+        shrinkToFit();
+    }
+
+    // Call while book still has its old title and author.
+    void bookRemoved(BookId id, const Book& book) {
+        forEachAffected(book, [this, id](std::vector<BookId>& ids) {
+            auto position = std::lower_bound(ids.begin(), ids.end(), id);
+            if (position != ids.end() && *position == id) {
+                ids.erase(position);
+                --stats.cachedIds;
+            }
+        });
+    }
+
+    void clear() {
+        recency.clear();
+        entriesByKeyword.clear();
+        entriesByGram.clear();
+        stats.entries = 0;
+        stats.cachedIds = 0;
+    }
+
+    void setCapacity(size_t entries, size_t ids) {
+        maxEntries = entries;
+        maxIds = ids;
+        shrinkToFit();
+    }
+
+    const SearchCacheStats& getStats() const { return stats; }
+};
+
+#endif // SEARCHRESULTCACHE_H
@@ -0,0 +1,184 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using TimerId = uint32_t;
+
+// Hierarchical timing wheel over integer ticks. Level l has 64 slots, each
+// covering 64^l ticks; a timer sits on the lowest level whose slot still
+// shares every higher digit with the current tick, and moves down a level
+// when the clock enters its slot. Each slot is an intrusive doubly linked
+// list of timers, so scheduling and cancelling are O(1). A bitmap of occupied
+// slots per level lets advance() jump straight to the next tick that has
+// work, so advancing costs the number of timers that fire or cascade (at
+// most one move per level each) rather than the number of ticks or the
+// number of pending timers. Timer ids are chosen by the caller and should be
+// dense, since they index the timer table.
+class TimingWheel {
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1 << SLOT_BITS;
+    static constexpr unsigned LEVELS = 6;
+    // Timers scheduled at or before the current tick wait here.
+    static constexpr unsigned READY_BUCKET = LEVELS * SLOTS;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Timer {
+        uint64_t expiry = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t bucket = NONE;
+    };
+
+    std::vector<Timer> timers;
+    std::array<uint32_t, LEVELS * SLOTS + 1> heads;
+    std::array<uint64_t, LEVELS> occupied{};
+    uint64_t now = 0;
+
+    static unsigned lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned bit = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static uint64_t digit(uint64_t tick, unsigned level) {
+        return (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    }
+
+    void link(TimerId id, uint32_t bucket) {
+        Timer& timer = timers[id];
+        timer.bucket = bucket;
+        timer.prev = NONE;
+        timer.next = heads[bucket];
+        if (timer.next != NONE) {
+            timers[timer.next].prev = id;
+        }
+        heads[bucket] = id;
+        if (bucket != READY_BUCKET) {
+            occupied[bucket / SLOTS] |= uint64_t(1) << (bucket % SLOTS);
+        }
+    }
+
+    void unlink(TimerId id) {
+        Timer& timer = timers[id];
+        if (timer.prev != NONE) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            heads[timer.bucket] = timer.next;
+            if (timer.next == NONE && timer.bucket != READY_BUCKET) {
+                occupied[timer.bucket / SLOTS] &= ~(uint64_t(1) << (timer.bucket % SLOTS));
+            }
+        }
+        if (timer.next != NONE) {
+            timers[timer.next].prev = timer.prev;
+        }
+        timer.bucket = NONE;
+    }
+
+    // Files a timer with expiry >= now on the lowest level that can hold it.
+    void place(TimerId id) {
+        uint64_t expiry = timers[id].expiry;
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            unsigned higherBits = SLOT_BITS * (level + 1);
+            if ((expiry >> higherBits) == (now >> higherBits)) {
+                link(id, static_cast<uint32_t>(level * SLOTS + digit(expiry, level)));
+                return;
+            }
+        }
+        throw std::runtime_error("Timer expiry is beyond the wheel's range");
+    }
+
+    // Next tick after now at which some slot needs cascading or firing, or
+    // UINT64_MAX if the wheel is empty.
+    uint64_t nextBusyTick() const {
+        uint64_t next = UINT64_MAX;
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            uint64_t current = digit(now, level);
+            uint64_t later = current == SLOTS - 1 ? 0 : occupied[level] & (~uint64_t(0) << (current + 1));
+            if (later) {
+                unsigned higherBits = SLOT_BITS * (level + 1);
+                uint64_t tick = (now >> higherBits << higherBits) |
+                                (uint64_t(lowestBit(later)) << (SLOT_BITS * level));
+                next = std::min(next, tick);
+            }
+        }
+        return next;
+    }
+
+    void drain(uint32_t bucket, std::vector<TimerId>& fired) {
+        while (heads[bucket] != NONE) {
+            TimerId id = heads[bucket];
+            unlink(id);
+            fired.push_back(id);
+        }
+    }
+
+public:
+    TimingWheel() {
+        heads.fill(NONE);
+    }
+
+    uint64_t getNow() const { return now; }
+
+    bool isScheduled(TimerId id) const {
+        return id < timers.size() && timers[id].bucket != NONE;
+    }
+
+    // Arms or re-arms a timer. One at or before the current tick fires on the
+    // next advance().
+    void schedule(TimerId id, uint64_t expiry) {
+        if (id >= timers.size()) {
+            timers.resize(id + 1);
+        }
+        cancel(id);
+        timers[id].expiry = expiry;
+        if (expiry <= now) {
+            link(id, READY_BUCKET);
+        } else {
+            place(id);
+        }
+    }
+
+    void cancel(TimerId id) {
+        if (isScheduled(id)) {
+            unlink(id);
+        }
+    }
+
+    // Moves the clock forward to tick and appends the timers that expired,
+    // in expiry order, to fired. Fired timers are disarmed.
+    void advance(uint64_t tick, std::vector<TimerId>& fired) {
+        drain(READY_BUCKET, fired);
+        while (true) {
+            uint64_t next = nextBusyTick();
+            if (next > tick) {
+                now = std::max(now, tick);
+                return;
+            }
+            now = next;
+            for (unsigned level = LEVELS - 1; level > 0; --level) {
+                uint32_t bucket = static_cast<uint32_t>(level * SLOTS + digit(now, level));
+                while (heads[bucket] != NONE) {
+                    TimerId id = heads[bucket];
+                    unlink(id);
+                    place(id);
+                }
+            }
+            drain(static_cast<uint32_t>(digit(now, 0)), fired);
+        }
+    }
+};
+
+#endif // TIMINGWHEEL_H
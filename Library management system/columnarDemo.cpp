@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ColumnarCatalog.cpp"
+#include "LibraryManager.cpp"
+
+// Loads the same randomized catalog into LibraryManager and ColumnarCatalog,
+// replaces and removes part of it in both, and checks that lookups and
+// substring searches agree. Then compares the bytes per book and the time of
+// a brute-force substring scan against an unordered_map of Books.
+
+// Heap bytes of an unordered_map<string, Book> under libstdc++: one node per
+// book holding the next pointer, the pair and the cached hash, the bucket
+// array, and every string too long for the small-string buffer.
+static size_t mapMemoryUsage(const std::unordered_map<std::string, Book>& books) {
+    size_t bytes = books.bucket_count() * sizeof(void*);
+    auto heapBytes = [](const std::string& text) {
+        return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0;
+    };
+    for (const auto& [isbn, book] : books) {
+        bytes += sizeof(void*) + sizeof(std::pair<const std::string, Book>) + sizeof(size_t);
+        bytes += heapBytes(isbn) + heapBytes(book.getIsbn()) + heapBytes(book.getTitle()) + heapBytes(book.getAuthor());
+    }
+    return bytes;
+}
+
+int main() {
+    const int bookCount = 13000;
+    const std::vector<std::string> words = {"River", "Stone", "Night", "Garden", "Winter", "Glass", "Harbor",
+                                            "Silver", "Shadow", "Empire", "Letters", "Orchard", "Lantern", "Tide"};
+    const std::vector<std::string> names = {"Ada", "Noor", "Ilse", "Tomas", "Mirela", "Kenji", "Odile", "Ruth"};
+    std::mt19937 rng(12);
+    auto pick = [&rng](const std::vector<std::string>& from) { return from[rng() % from.size()]; };
+
+    std::vector<Book> books;
+    for (int i = 0; i < bookCount; ++i) {
+        std::string title = pick(words);
+        for (int word = 1 + static_cast<int>(rng() % 5); word > 0; --word) {
+            title += " " + pick(words);
+        }
+        std::string isbn = "978-" + std::to_string(rng() % 10) + "-" + std::to_string(10000 + i) + "-" +
+                           std::to_string(100 + rng() % 900) + "-" + std::to_string(rng() % 10);
+        books.emplace_back(isbn, title, pick(names) + " " + pick(words) + "son", 1900 + static_cast<int>(rng() % 125));
+    }
+
+    LibraryManager& libraryManager = LibraryManager::getInstance();
+    ColumnarCatalog columnar;
+    std::unordered_map<std::string, Book> mapCatalog;
+    for (const Book& book : books) {
+        libraryManager.addBook(book);
+        columnar.addBook(book);
+        mapCatalog[book.getIsbn()] = book;
+    }
+    // Replace every fifth book and remove every seventh, so rows move and
+    // the arena gets compacted along the way.
+    for (int i = 0; i < bookCount; ++i) {
+        const Book& book = books[i];
+        if (i % 7 == 0) {
+            libraryManager.removeBook(book.getIsbn());
+            columnar.removeBook(book.getIsbn());
+            mapCatalog.erase(book.getIsbn());
+        } else if (i % 5 == 0) {
+            Book renamed(book.getIsbn(), "Revised " + book.getTitle(), book.getAuthor(), book.getPublicationYear() + 1);
+            libraryManager.addBook(renamed);
+            columnar.addBook(renamed);
+            mapCatalog[book.getIsbn()] = renamed;
+        }
+    }
+
+    int mismatches = 0;
+    for (const auto& [isbn, book] : mapCatalog) {
+        Book stored = columnar.getBook(isbn);
+        Book expected = libraryManager.getBook(isbn);
+        if (stored.getTitle() != expected.getTitle() || stored.getAuthor() != expected.getAuthor() ||
+            stored.getPublicationYear() != expected.getPublicationYear()) {
+            ++mismatches;
+        }
+    }
+    const std::vector<std::string> keywords = {"Revised", "River Stone", "Noor", "Glass Tide", "son", "Lantern Night",
+                                               "Ada Empire", "ter", "xyz"};
+    for (const std::string& keyword : keywords) {
+        std::vector<std::string> expected;
+        for (const Book* book : libraryManager.searchBooks(keyword)) {
+            expected.push_back(book->getIsbn());
+        }
+        std::vector<std::string> found;
+        for (BookRow row : columnar.searchBooks(keyword)) {
+            found.emplace_back(columnar.getIsbn(row));
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        mismatches += expected != found;
+    }
+    std::cout << "Books: " << columnar.size() << ", mismatches against LibraryManager: " << mismatches << std::endl;
+
+    std::cout << "Bytes per book: columnar " << columnar.getMemoryUsage() / columnar.size() << ", unordered_map "
+              << mapMemoryUsage(mapCatalog) / mapCatalog.size() << std::endl;
+
+    const int rounds = 50;
+    size_t columnarMatches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const std::string& keyword : keywords) {
+            columnarMatches += columnar.searchBooks(keyword).size();
+        }
+    }
+    double columnarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t mapMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const std::string& keyword : keywords) {
+            std::vector<const Book*> matching;
+            for (const auto& [isbn, book] : mapCatalog) {
+                if (book.getTitle().find(keyword) != std::string::npos ||
+                    book.getAuthor().find(keyword) != std::string::npos) {
+                    matching.push_back(&book);
+                }
+            }
+            mapMatches += matching.size();
+        }
+    }
+    double mapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Substring scan: columnar " << columnarSeconds * 1000 << " ms, unordered_map " << mapSeconds * 1000
+              << " ms (" << (columnarMatches == mapMatches ? "same" : "different") << " matches)" << std::endl;
+
+    return mismatches == 0 && columnarMatches == mapMatches ? 0 : 1;
+}
@@ -3,75 +3,1823 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <queue>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
-class Book {
+class Book {
+private:
+    string isbn;
+    string title;
+    string author;
+    int publicationYear;
+    bool available;
+
+public:
+     Book() : isbn(""), title(""), author(""), publicationYear(0), available(true) {}
+    Book(string isbn, string title, string author, int publicationYear)
+        : isbn(isbn), title(title), author(author), publicationYear(publicationYear), available(true) {}
+
+    const string& getIsbn() const { return isbn; }
+    const string& getTitle() const { return title; }
+    const string& getAuthor() const { return author; }
+    int getPublicationYear() const { return publicationYear; }
+    bool isAvailable() const { return available; }
+    void setAvailable(bool available) { this->available = available; }
+
+    bool operator==(const Book& other) const {
+        return isbn == other.isbn;
+    }
+};
+
+class Member {
+private:
+    string memberId;
+    string name;
+    string contactInfo;
+
+public:
+      Member() : memberId(""), name(""), contactInfo("") {}
+    Member(string memberId, string name, string contactInfo)
+        : memberId(memberId), name(name), contactInfo(contactInfo) {}
+
+    string getMemberId() const { return memberId; }
+    string getName() const { return name; }
+};
+
+using BookRow = uint32_t;
+
+// ISBN packed into a fixed-width, NUL-padded key, wide enough for a
+// hyphenated ISBN-13.
+struct IsbnKey {
+    static constexpr size_t SIZE = 20;
+    std::array<char, SIZE> bytes{};
+
+    bool operator==(const IsbnKey& other) const { return bytes == other.bytes; }
+};
+
+// Catalog layout with one column per Book field instead of one heap node per
+// book. Titles and authors are appended to a single character arena and
+// referenced by offset and length; ISBNs are stored as fixed-width keys and
+// looked up through an open-addressing table of row numbers. A substring
+// scan therefore walks contiguous memory, and a book costs a few dozen bytes
+// plus its text. Rows are dense: removing a book moves the last row into its
+// place, so row numbers are only stable until the next removal.
+//
+// It mirrors LibraryManager's add, remove, get and search operations but is
+// not LibraryManager's store: the search index, search pages and
+// recommendations hand out pointers to stored Book objects that stay put and
+// are updated in place on borrow, and rows here neither hold Book objects
+// nor stay put. columnarDemo checks the two against each other.
+class ColumnarCatalog {
+private:
+    std::vector<IsbnKey> isbns;
+    std::vector<uint32_t> titleOffsets;
+    std::vector<uint32_t> titleLengths;
+    std::vector<uint32_t> authorOffsets;
+    std::vector<uint32_t> authorLengths;
+    std::vector<int32_t> publicationYears;
+    std::vector<uint8_t> availability;
+    std::string arena;
+    size_t deadArenaBytes = 0;
+
+    // Slot holds row + 1; 0 marks an empty slot. Kept at most half full.
+    std::vector<BookRow> slots;
+
+    static uint64_t hash(const IsbnKey& key) {
+        uint64_t value = 14695981039346656037ULL;
+        for (char byte : key.bytes) {
+            value = (value ^ static_cast<unsigned char>(byte)) * 1099511628211ULL;
+        }
+        return value;
+    }
+
+    size_t slotOf(const IsbnKey& key) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = hash(key) & mask;
+        while (slots[slot] != 0 && !(isbns[slots[slot] - 1] == key)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rehash(size_t slotCount) {
+        slots.assign(slotCount, 0);
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            slots[slotOf(isbns[row])] = row + 1;
+        }
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    void eraseSlot(size_t slot) {
+        size_t mask = slots.size() - 1;
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; slots[next] != 0; next = (next + 1) & mask) {
+            size_t home = hash(isbns[slots[next] - 1]) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        slots[hole] = 0;
+    }
+
+    uint32_t appendText(const std::string& text) {
+        uint32_t offset = static_cast<uint32_t>(arena.size());
+        arena.append(text);
+        return offset;
+    }
+
+    void compactArena() {
+        std::string compacted;
+        compacted.reserve(arena.size() - deadArenaBytes);
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            uint32_t titleOffset = static_cast<uint32_t>(compacted.size());
+            compacted.append(arena, titleOffsets[row], titleLengths[row]);
+            uint32_t authorOffset = static_cast<uint32_t>(compacted.size());
+            compacted.append(arena, authorOffsets[row], authorLengths[row]);
+            titleOffsets[row] = titleOffset;
+            authorOffsets[row] = authorOffset;
+        }
+        arena.swap(compacted);
+        deadArenaBytes = 0;
+    }
+
+public:
+    static bool packIsbn(std::string_view isbn, IsbnKey& key) {
+        if (isbn.size() > IsbnKey::SIZE || isbn.find('\0') != std::string_view::npos) {
+            return false;
+        }
+        key.bytes.fill('\0');
+        std::memcpy(key.bytes.data(), isbn.data(), isbn.size());
+        return true;
+    }
+
+    // Adds or replaces a book. Fails for ISBNs wider than IsbnKey::SIZE.
+    bool addBook(const Book& book) {
+        IsbnKey key;
+        if (!packIsbn(book.getIsbn(), key)) {
+            return false;
+        }
+        removeBook(book.getIsbn());
+        if ((isbns.size() + 1) * 2 > slots.size()) {
+            rehash(std::max<size_t>(16, slots.size() * 2));
+        }
+        isbns.push_back(key);
+        titleOffsets.push_back(appendText(book.getTitle()));
+        titleLengths.push_back(static_cast<uint32_t>(book.getTitle().size()));
+        authorOffsets.push_back(appendText(book.getAuthor()));
+        authorLengths.push_back(static_cast<uint32_t>(book.getAuthor().size()));
+        publicationYears.push_back(book.getPublicationYear());
+        availability.push_back(book.isAvailable());
+        slots[slotOf(key)] = static_cast<BookRow>(isbns.size());
+        return true;
+    }
+
+    void removeBook(std::string_view isbn) {
+        IsbnKey key;
+        if (slots.empty() || !packIsbn(isbn, key)) {
+            return;
+        }
+        size_t slot = slotOf(key);
+        if (slots[slot] == 0) {
+            return;
+        }
+        BookRow row = slots[slot] - 1;
+        BookRow last = static_cast<BookRow>(isbns.size() - 1);
+        deadArenaBytes += titleLengths[row] + authorLengths[row];
+        eraseSlot(slot);
+        if (row != last) {
+            slots[slotOf(isbns[last])] = row + 1;
+            isbns[row] = isbns[last];
+            titleOffsets[row] = titleOffsets[last];
+            titleLengths[row] = titleLengths[last];
+            authorOffsets[row] = authorOffsets[last];
+            authorLengths[row] = authorLengths[last];
+            publicationYears[row] = publicationYears[last];
+            availability[row] = availability[last];
+        }
+        isbns.pop_back();
+        titleOffsets.pop_back();
+        titleLengths.pop_back();
+        authorOffsets.pop_back();
+        authorLengths.pop_back();
+        publicationYears.pop_back();
+        availability.pop_back();
+        if (deadArenaBytes > arena.size() / 2) {
+            compactArena();
+        }
+    }
+
+    // Row of the book, or size() if it is not in the catalog.
+    BookRow findRow(std::string_view isbn) const {
+        IsbnKey key;
+        if (slots.empty() || !packIsbn(isbn, key)) {
+            return static_cast<BookRow>(isbns.size());
+        }
+        BookRow stored = slots[slotOf(key)];
+        return stored == 0 ? static_cast<BookRow>(isbns.size()) : stored - 1;
+    }
+
+    Book getBook(std::string_view isbn) const {
+        BookRow row = findRow(isbn);
+        if (row == isbns.size()) {
+            throw std::runtime_error("Book not found");
+        }
+        Book book{std::string(getIsbn(row)), std::string(getTitle(row)), std::string(getAuthor(row)),
+                  publicationYears[row]};
+        book.setAvailable(availability[row] != 0);
+        return book;
+    }
+
+    // Rows of the books whose title or author contains keyword, scanning the
+    // arena directly.
+    std::vector<BookRow> searchBooks(std::string_view keyword) const {
+        std::vector<BookRow> rows;
+        for (BookRow row = 0; row < isbns.size(); ++row) {
+            if (getTitle(row).find(keyword) != std::string_view::npos ||
+                getAuthor(row).find(keyword) != std::string_view::npos) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    size_t size() const { return isbns.size(); }
+
+    std::string_view getIsbn(BookRow row) const {
+        const char* bytes = isbns[row].bytes.data();
+        const void* padding = std::memchr(bytes, '\0', IsbnKey::SIZE);
+        return std::string_view(bytes, padding ? static_cast<const char*>(padding) - bytes : IsbnKey::SIZE);
+    }
+    std::string_view getTitle(BookRow row) const { return std::string_view(arena).substr(titleOffsets[row], titleLengths[row]); }
+    std::string_view getAuthor(BookRow row) const { return std::string_view(arena).substr(authorOffsets[row], authorLengths[row]); }
+    int getPublicationYear(BookRow row) const { return publicationYears[row]; }
+    bool isAvailable(BookRow row) const { return availability[row] != 0; }
+    void setAvailable(BookRow row, bool available) { availability[row] = available; }
+
+    // Bytes held by the columns, the arena and the lookup table.
+    size_t getMemoryUsage() const {
+        return isbns.capacity() * sizeof(IsbnKey) +
+               (titleOffsets.capacity() + titleLengths.capacity() + authorOffsets.capacity() +
+                authorLengths.capacity()) * sizeof(uint32_t) +
+               publicationYears.capacity() * sizeof(int32_t) + availability.capacity() +
+               arena.capacity() + slots.capacity() * sizeof(BookRow);
+    }
+};
+
+using BookId = uint32_t;
+
+constexpr BookId NO_BOOK_ID = UINT32_MAX;
+
+// Where a match sits in ranked results: title matches before author-only
+// matches, then newer publication years first, then ascending ISBN so the
+// order is total. The rank of the last result on a page is the cursor for the
+// next one.
+struct SearchRank {
+    bool titleMatch = false;
+    int publicationYear = 0;
+    std::string isbn;
+};
+
+struct RankedMatches {
+    std::vector<BookId> ids;
+    bool hasMore = false;
+};
+
+// Trigram inverted index over book titles and authors. Every distinct
+// three-byte sequence of either field maps to a sorted posting list of book
+// ids. A keyword's trigrams narrow the catalog to a few candidates, which are
+// then checked with std::string::find, so results match a substring scan.
+// Ids are handed out in increasing order, which keeps the posting lists
+// sorted on append. A removed book only loses its live flag. Once more books
+// have died since the last purge than are live, dead ids are purged from the
+// lists and the live books renumbered densely in their old order, so each
+// purge is paid for by the removals before it and the id space stays within
+// twice the live catalog. Renumbering changes getIdGeneration().
+class BookSearchIndex {
+public:
+    static constexpr size_t GRAM_LENGTH = 3;
+
+    static uint32_t gramAt(const std::string& text, size_t offset) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(text[offset])) << 16 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[offset + 1])) << 8 |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[offset + 2]));
+    }
+
+    static void collectGrams(const std::string& text, std::vector<uint32_t>& grams) {
+        for (size_t offset = 0; offset + GRAM_LENGTH <= text.size(); ++offset) {
+            grams.push_back(gramAt(text, offset));
+        }
+    }
+
+    static bool matches(const Book& book, const std::string& keyword) {
+        return book.getTitle().find(keyword) != std::string::npos ||
+               book.getAuthor().find(keyword) != std::string::npos;
+    }
+
+private:
+    static constexpr uint32_t GRAM_SPACE = 1 << 24;
+    static constexpr size_t MIN_BULK_BOOKS = 1 << 16;
+
+    std::unordered_map<uint32_t, std::vector<BookId>> postings;
+    std::vector<const Book*> booksById;
+    std::unordered_map<std::string, BookId> idByIsbn;
+    size_t liveCount = 0;
+    // Removed ids still sitting in posting lists.
+    size_t deadCount = 0;
+    uint64_t idGeneration = 0;
+
+    void purgeDeadIds() {
+        std::vector<BookId> renumbered(booksById.size(), NO_BOOK_ID);
+        std::vector<const Book*> live;
+        live.reserve(liveCount);
+        for (BookId id = 0; id < booksById.size(); ++id) {
+            if (booksById[id]) {
+                renumbered[id] = static_cast<BookId>(live.size());
+                live.push_back(booksById[id]);
+            }
+        }
+        // The mapping is increasing, so the lists stay sorted.
+        for (auto it = postings.begin(); it != postings.end();) {
+            std::vector<BookId>& ids = it->second;
+            size_t kept = 0;
+            for (BookId id : ids) {
+                if (renumbered[id] != NO_BOOK_ID) {
+                    ids[kept++] = renumbered[id];
+                }
+            }
+            ids.resize(kept);
+            it = ids.empty() ? postings.erase(it) : std::next(it);
+        }
+        for (auto& [isbn, id] : idByIsbn) {
+            id = renumbered[id];
+        }
+        booksById.swap(live);
+        deadCount = 0;
+        ++idGeneration;
+    }
+
+    // Drops the ISBN's entry but leaves its id in the posting lists.
+    void markRemoved(const std::string& isbn) {
+        auto it = idByIsbn.find(isbn);
+        if (it == idByIsbn.end()) {
+            return;
+        }
+        booksById[it->second] = nullptr;
+        idByIsbn.erase(it);
+        --liveCount;
+        ++deadCount;
+    }
+
+public:
+    // Indexes a book stored elsewhere; the pointer must stay valid until the
+    // book is removed. Adding an ISBN again replaces the earlier entry.
+    BookId add(const Book* book) {
+        remove(book->getIsbn());
+        BookId id = static_cast<BookId>(booksById.size());
+        booksById.push_back(book);
+        idByIsbn[book->getIsbn()] = id;
+        ++liveCount;
+
+        std::vector<uint32_t> grams;
+        collectGrams(book->getTitle(), grams);
+        collectGrams(book->getAuthor(), grams);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        for (uint32_t gram : grams) {
+            postings[gram].push_back(id);
+        }
+        return id;
+    }
+
+    // Indexes many books at once. Each thread extracts the distinct trigrams
+    // of a contiguous slice of the batch; the pairs are then bucketed by gram
+    // with a counting sort over the 24-bit gram space, so every posting list
+    // is appended to once instead of once per book. Books already indexed
+    // are dropped up front and the lists purged at most once, so reloading a
+    // catalog costs the same as loading it. The books must have distinct
+    // ISBNs.
+    void addBulk(const std::vector<const Book*>& books,
+                 unsigned threadCount = std::max(1u, std::thread::hardware_concurrency())) {
+        if (books.size() < MIN_BULK_BOOKS) {
+            for (const Book* book : books) {
+                add(book);
+            }
+            return;
+        }
+        for (const Book* book : books) {
+            markRemoved(book->getIsbn());
+        }
+        if (deadCount > liveCount) {
+            purgeDeadIds();
+        }
+
+        // Per slice: the distinct grams of each book back to back, and where
+        // each book's grams end.
+        struct GramSlice {
+            std::vector<uint32_t> grams;
+            std::vector<size_t> ends;
+        };
+        size_t sliceCount = std::min<size_t>(threadCount, books.size() / MIN_BULK_BOOKS + 1);
+        size_t sliceSize = (books.size() + sliceCount - 1) / sliceCount;
+        std::vector<GramSlice> slices(sliceCount);
+        auto extract = [&](size_t slice) {
+            GramSlice& out = slices[slice];
+            size_t end = std::min(books.size(), (slice + 1) * sliceSize);
+            for (size_t i = slice * sliceSize; i < end; ++i) {
+                size_t begin = out.grams.size();
+                collectGrams(books[i]->getTitle(), out.grams);
+                collectGrams(books[i]->getAuthor(), out.grams);
+                std::sort(out.grams.begin() + begin, out.grams.end());
+                out.grams.erase(std::unique(out.grams.begin() + begin, out.grams.end()), out.grams.end());
+                out.ends.push_back(out.grams.size());
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t slice = 1; slice < sliceCount; ++slice) {
+            threads.emplace_back(extract, slice);
+        }
+        extract(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // offsets[gram] ends up as the end of that gram's bucket in ids.
+        std::vector<uint32_t> offsets(GRAM_SPACE + 1, 0);
+        for (const GramSlice& slice : slices) {
+            for (uint32_t gram : slice.grams) {
+                ++offsets[gram + 1];
+            }
+        }
+        for (size_t gram = 1; gram <= GRAM_SPACE; ++gram) {
+            offsets[gram] += offsets[gram - 1];
+        }
+        std::vector<BookId> ids(offsets[GRAM_SPACE]);
+        booksById.reserve(booksById.size() + books.size());
+        idByIsbn.reserve(idByIsbn.size() + books.size());
+        size_t bookIndex = 0;
+        for (const GramSlice& slice : slices) {
+            size_t begin = 0;
+            for (size_t end : slice.ends) {
+                const Book* book = books[bookIndex++];
+                BookId id = static_cast<BookId>(booksById.size());
+                booksById.push_back(book);
+                idByIsbn[book->getIsbn()] = id;
+                for (size_t i = begin; i < end; ++i) {
+                    ids[offsets[slice.grams[i]]++] = id;
+                }
+                begin = end;
+            }
+        }
+        liveCount += books.size();
+
+        for (uint32_t gram = 0; gram < GRAM_SPACE; ++gram) {
+            uint32_t begin = gram == 0 ? 0 : offsets[gram - 1];
+            if (offsets[gram] > begin) {
+                std::vector<BookId>& list = postings[gram];
+                list.insert(list.end(), ids.begin() + begin, ids.begin() + offsets[gram]);
+            }
+        }
+    }
+
+    void remove(const std::string& isbn) {
+        markRemoved(isbn);
+        if (deadCount > liveCount) {
+            purgeDeadIds();
+        }
+    }
+
+    // Changes whenever add, addBulk or remove renumbers the ids; ids obtained
+    // before that no longer name the same books.
+    uint64_t getIdGeneration() const { return idGeneration; }
+
+    // Ids in use, live or awaiting a purge.
+    size_t getIdSpace() const { return booksById.size(); }
+
+    // The id the ISBN is indexed under, or NO_BOOK_ID.
+    BookId idOf(const std::string& isbn) const {
+        auto it = idByIsbn.find(isbn);
+        return it == idByIsbn.end() ? NO_BOOK_ID : it->second;
+    }
+
+    const Book* get(BookId id) const {
+        return id < booksById.size() ? booksById[id] : nullptr;
+    }
+
+    // Ids of the books whose title or author contains keyword, in ascending
+    // id order.
+    std::vector<BookId> find(const std::string& keyword) const {
+        std::vector<BookId> result;
+        forEachMatch(keyword, [&result](BookId id, const Book&) { result.push_back(id); });
+        return result;
+    }
+
+    // The best `limit` matches ranked after `after` (from the top if null),
+    // best first, skipping the first `offset` of them. Matches are streamed
+    // through a bounded max-heap, so memory and sorting cost depend on
+    // offset + limit rather than on the number of matches; prefer a cursor
+    // over a large offset. hasMore says whether further matches exist.
+    RankedMatches findRanked(const std::string& keyword, size_t offset, size_t limit,
+                             const SearchRank* after = nullptr) const {
+        RankedMatches result;
+        if (limit == 0) {
+            return result;
+        }
+        struct Entry {
+            bool titleMatch;
+            int publicationYear;
+            const std::string* isbn;
+            BookId id;
+        };
+        auto ranksBefore = [](const Entry& a, const Entry& b) {
+            if (a.titleMatch != b.titleMatch) {
+                return a.titleMatch;
+            }
+            if (a.publicationYear != b.publicationYear) {
+                return a.publicationYear > b.publicationYear;
+            }
+            return *a.isbn < *b.isbn;
+        };
+        // One extra entry tells whether anything follows the page.
+        size_t keep = offset + limit + 1;
+        std::priority_queue<Entry, std::vector<Entry>, decltype(ranksBefore)> worstOnTop(ranksBefore);
+        Entry cursor{};
+        if (after) {
+            cursor = Entry{after->titleMatch, after->publicationYear, &after->isbn, 0};
+        }
+
+        forEachMatch(keyword, [&](BookId id, const Book& book) {
+            Entry entry{book.getTitle().find(keyword) != std::string::npos, book.getPublicationYear(),
+                        &book.getIsbn(), id};
+            if (after && !ranksBefore(cursor, entry)) {
+                return;
+            }
+            if (worstOnTop.size() < keep) {
+                worstOnTop.push(entry);
+            } else if (ranksBefore(entry, worstOnTop.top())) {
+                worstOnTop.pop();
+                worstOnTop.push(entry);
+            }
+        });
+
+        result.hasMore = worstOnTop.size() == keep;
+        if (result.hasMore) {
+            worstOnTop.pop();
+        }
+        std::vector<BookId> ranked(worstOnTop.size());
+        for (size_t i = ranked.size(); i-- > 0; worstOnTop.pop()) {
+            ranked[i] = worstOnTop.top().id;
+        }
+        if (offset < ranked.size()) {
+            result.ids.assign(ranked.begin() + offset, ranked.end());
+        }
+        return result;
+    }
+
+    SearchRank rankOf(BookId id, const std::string& keyword) const {
+        const Book& book = *booksById[id];
+        return SearchRank{book.getTitle().find(keyword) != std::string::npos, book.getPublicationYear(),
+                          book.getIsbn()};
+    }
+
+    // Calls visit(id, book) for every live book whose title or author
+    // contains keyword, in ascending id order. Keywords shorter than a
+    // trigram match most of the catalog anyway and are answered by checking
+    // every live book.
+    template <typename Visit>
+    void forEachMatch(const std::string& keyword, Visit visit) const {
+        if (keyword.size() < GRAM_LENGTH) {
+            for (BookId id = 0; id < booksById.size(); ++id) {
+                if (booksById[id] && matches(*booksById[id], keyword)) {
+                    visit(id, *booksById[id]);
+                }
+            }
+            return;
+        }
+
+        std::vector<uint32_t> grams;
+        collectGrams(keyword, grams);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        std::vector<const std::vector<BookId>*> lists;
+        for (uint32_t gram : grams) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) {
+                return;
+            }
+            lists.push_back(&it->second);
+        }
+        std::sort(lists.begin(), lists.end(),
+                  [](const std::vector<BookId>* a, const std::vector<BookId>* b) { return a->size() < b->size(); });
+
+        // Walk the shortest list and binary-search the rest for each id.
+        for (BookId id : *lists.front()) {
+            const Book* book = booksById[id];
+            if (!book) {
+                continue;
+            }
+            bool inAll = std::all_of(lists.begin() + 1, lists.end(), [id](const std::vector<BookId>* ids) {
+                return std::binary_search(ids->begin(), ids->end(), id);
+            });
+            if (inAll && matches(*book, keyword)) {
+                visit(id, *book);
+            }
+        }
+    }
+};
+
+struct SearchCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    // Cached lists updated in place by an add or remove instead of dropped.
+    uint64_t patches = 0;
+    size_t entries = 0;
+    size_t cachedIds = 0;
+
+    double getHitRate() const {
+        return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0;
+    }
+};
+
+// LRU cache of keyword -> matching book ids, in ascending id order like
+// BookSearchIndex::find. It is bounded both in entries and in the total
+// number of ids held; a result list larger than the id budget is never
+// admitted. Entries are kept exact rather than dropped when the catalog
+// changes: a keyword can only match a book that contains its first trigram,
+// so entries are also filed under that trigram, and adding or removing a
+// book only checks the entries filed under the book's own trigrams (plus the
+// few keywords shorter than a trigram) and patches their lists. Loans do not
+// change which books match, so borrowing and returning leave it alone.
+class SearchResultCache {
+private:
+    struct Entry {
+        std::string keyword;
+        std::vector<BookId> ids;
+    };
+
+    using EntryIt = std::list<Entry>::iterator;
+
+    size_t maxEntries;
+    size_t maxIds;
+    std::list<Entry> recency;
+    std::unordered_map<std::string, EntryIt> entriesByKeyword;
+    // Entries filed under their keyword's first trigram; keywords shorter
+    // than a trigram are filed under SHORT_KEYWORDS.
+    std::unordered_map<uint32_t, std::vector<EntryIt>> entriesByGram;
+    SearchCacheStats stats;
+
+    static constexpr uint32_t SHORT_KEYWORDS = UINT32_MAX;
+
+    static uint32_t firstGram(const std::string& keyword) {
+        return keyword.size() < BookSearchIndex::GRAM_LENGTH ? SHORT_KEYWORDS : BookSearchIndex::gramAt(keyword, 0);
+    }
+
+    void evict(EntryIt entry) {
+        std::vector<EntryIt>& filed = entriesByGram[firstGram(entry->keyword)];
+        auto position = std::find(filed.begin(), filed.end(), entry);
+        *position = filed.back();
+        filed.pop_back();
+        if (filed.empty()) {
+            entriesByGram.erase(firstGram(entry->keyword));
+        }
+        stats.cachedIds -= entry->ids.size();
+        entriesByKeyword.erase(entry->keyword);
+        recency.erase(entry);
+        --stats.entries;
+    }
+
+    void shrinkToFit() {
+        while (!recency.empty() && (stats.entries > maxEntries || stats.cachedIds > maxIds)) {
+            evict(std::prev(recency.end()));
+            ++stats.evictions;
+        }
+    }
+
+    // Calls patch(ids) for every cached list whose keyword matches book.
+    template <typename Patch>
+    void forEachAffected(const Book& book, Patch patch) {
+        if (recency.empty()) {
+            return;
+        }
+        std::vector<uint32_t> grams;
+        BookSearchIndex::collectGrams(book.getTitle(), grams);
+        BookSearchIndex::collectGrams(book.getAuthor(), grams);
+        grams.push_back(SHORT_KEYWORDS);
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+        for (uint32_t gram : grams) {
+            auto filed = entriesByGram.find(gram);
+            if (filed == entriesByGram.end()) {
+                continue;
+            }
+            for (EntryIt entry : filed->second) {
+                if (BookSearchIndex::matches(book, entry->keyword)) {
+                    patch(entry->ids);
+                    ++stats.patches;
+                }
+            }
+        }
+    }
+
+public:
+    SearchResultCache(size_t maxEntries = 4096, size_t maxIds = 1 << 22)
+        : maxEntries(maxEntries), maxIds(maxIds) {}
+
+    // The cached ids for keyword, or nullptr on a miss. The pointer is
+    // valid until the cache is next changed.
+    const std::vector<BookId>* find(const std::string& keyword) {
+        auto it = entriesByKeyword.find(keyword);
+        if (it == entriesByKeyword.end()) {
+            ++stats.misses;
+            return nullptr;
+        }
+        ++stats.hits;
+        recency.splice(recency.begin(), recency, it->second);
+        return &it->second->ids;
+    }
+
+    void insert(const std::string& keyword, const std::vector<BookId>& ids) {
+        if (entriesByKeyword.count(keyword) || ids.size() > maxIds || maxEntries == 0) {
+            return;
+        }
+        recency.push_front(Entry{keyword, ids});
+        entriesByKeyword[keyword] = recency.begin();
+        entriesByGram[firstGram(keyword)].push_back(recency.begin());
+        ++stats.entries;
+        stats.cachedIds += ids.size();
+        shrinkToFit();
+    }
+
+    // Call after the index gave book the id. Ids only grow, so appending
+    // keeps the lists sorted.
+    void bookAdded(BookId id, const Book& book) {
+        forEachAffected(book, [this, id](std::vector<BookId>& ids) {
+            ids.push_back(id);
+            ++stats.cachedIds;
+        });
+        shrinkToFit();
+    }
+
+    // Call while book still has its old title and author.
+    void bookRemoved(BookId id, const Book& book) {
+        forEachAffected(book, [this, id](std::vector<BookId>& ids) {
+            auto position = std::lower_bound(ids.begin(), ids.end(), id);
+            if (position != ids.end() && *position == id) {
+                ids.erase(position);
+                --stats.cachedIds;
+            }
+        });
+    }
+
+    void clear() {
+        recency.clear();
+        entriesByKeyword.clear();
+        entriesByGram.clear();
+        stats.entries = 0;
+        stats.cachedIds = 0;
+    }
+
+    void setCapacity(size_t entries, size_t ids) {
+        maxEntries = entries;
+        maxIds = ids;
+        shrinkToFit();
+    }
+
+    const SearchCacheStats& getStats() const { return stats; }
+};
+
+using MemberHandle = uint32_t;
+using BookHandle = uint32_t;
+
+constexpr uint32_t NO_HANDLE = UINT32_MAX;
+
+// Who holds which book, keyed by dense handles. Handles are handed out when a
+// member registers or a book is added and stay the same for that member id or
+// ISBN from then on. Each member's loans sit in a fixed array and each book
+// remembers its slot in it, so borrowing, returning and counting are O(1) and
+// never allocate.
+class LoanTable {
+public:
+    static constexpr size_t MAX_LOANS_PER_MEMBER = 5;
+
+    // Non-owning view of one member's loans; invalidated by the next change.
+    class LoanView {
+    private:
+        const BookHandle* first;
+        const BookHandle* last;
+
+    public:
+        LoanView(const BookHandle* first, const BookHandle* last) : first(first), last(last) {}
+
+        const BookHandle* begin() const { return first; }
+        const BookHandle* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+    };
+
+private:
+    struct MemberLoans {
+        std::array<BookHandle, MAX_LOANS_PER_MEMBER> books;
+        uint8_t count = 0;
+    };
+
+    std::vector<MemberLoans> loansByMember;
+    std::vector<MemberHandle> holderByBook;
+    std::vector<uint8_t> slotByBook;
+    std::vector<std::string> isbnByBook;
+    std::vector<std::string> idByMember;
+    std::unordered_map<std::string, MemberHandle> memberHandles;
+    std::unordered_map<std::string, BookHandle> bookHandles;
+
+public:
+    MemberHandle internMember(const std::string& memberId) {
+        auto [it, inserted] = memberHandles.emplace(memberId, static_cast<MemberHandle>(loansByMember.size()));
+        if (inserted) {
+            loansByMember.emplace_back();
+            idByMember.push_back(memberId);
+        }
+        return it->second;
+    }
+
+    BookHandle internBook(const std::string& isbn) {
+        auto [it, inserted] = bookHandles.emplace(isbn, static_cast<BookHandle>(holderByBook.size()));
+        if (inserted) {
+            holderByBook.push_back(NO_HANDLE);
+            slotByBook.push_back(0);
+            isbnByBook.push_back(isbn);
+        }
+        return it->second;
+    }
+
+    MemberHandle findMember(const std::string& memberId) const {
+        auto it = memberHandles.find(memberId);
+        return it == memberHandles.end() ? NO_HANDLE : it->second;
+    }
+
+    BookHandle findBook(const std::string& isbn) const {
+        auto it = bookHandles.find(isbn);
+        return it == bookHandles.end() ? NO_HANDLE : it->second;
+    }
+
+    // Fails if the book is already lent out or the member is at the limit.
+    bool borrowBook(MemberHandle member, BookHandle book) {
+        MemberLoans& loans = loansByMember[member];
+        if (holderByBook[book] != NO_HANDLE || loans.count == MAX_LOANS_PER_MEMBER) {
+            return false;
+        }
+        loans.books[loans.count] = book;
+        slotByBook[book] = loans.count++;
+        holderByBook[book] = member;
+        return true;
+    }
+
+    // Fails if the member does not hold the book. The member's last loan
+    // moves into the freed slot.
+    bool returnBook(MemberHandle member, BookHandle book) {
+        if (holderByBook[book] != member) {
+            return false;
+        }
+        MemberLoans& loans = loansByMember[member];
+        BookHandle moved = loans.books[--loans.count];
+        loans.books[slotByBook[book]] = moved;
+        slotByBook[moved] = slotByBook[book];
+        holderByBook[book] = NO_HANDLE;
+        return true;
+    }
+
+    size_t getMemberCount() const { return idByMember.size(); }
+    size_t getBookCount() const { return isbnByBook.size(); }
+    size_t getLoanCount(MemberHandle member) const { return loansByMember[member].count; }
+    MemberHandle getHolder(BookHandle book) const { return holderByBook[book]; }
+    const std::string& getIsbn(BookHandle book) const { return isbnByBook[book]; }
+    const std::string& getMemberId(MemberHandle member) const { return idByMember[member]; }
+
+    LoanView getLoans(MemberHandle member) const {
+        const MemberLoans& loans = loansByMember[member];
+        return LoanView(loans.books.data(), loans.books.data() + loans.count);
+    }
+};
+
+// Read-only view of a whole file. Uses mmap where available so snapshots and
+// catalog dumps are parsed straight from the page cache; on Windows the file
+// is read into memory.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#else
+    void* mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping) {
+            munmap(mapping, size);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        buffer.resize(length > 0 ? static_cast<size_t>(length) : 0);
+        size_t read = std::fread(buffer.data(), 1, buffer.size(), file);
+        std::fclose(file);
+        data = buffer.data();
+        size = read;
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                size = 0;
+                ::close(fd);
+                return false;
+            }
+            data = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+// Pushes a stdio stream's buffered bytes all the way to stable storage.
+inline bool syncToDisk(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+struct CatalogLoadStats {
+    size_t rowsLoaded = 0;
+    size_t rowsRejected = 0;
+    std::vector<size_t> rejectedLines;
+    double seconds = 0;
+
+    double getRowsPerSecond() const {
+        return seconds > 0 ? static_cast<double>(rowsLoaded + rowsRejected) / seconds : 0;
+    }
+};
+
+// Parses catalog dumps with one book per line: isbn,title,author,year. Fields
+// may be double-quoted, with "" standing for a quote inside them; a quoted
+// field cannot span lines. An optional header line starting with "isbn" is
+// skipped, as are blank lines. The file is memory-mapped and split at line
+// boundaries into one chunk per thread; malformed rows are counted and
+// skipped without stopping the run.
+class CatalogLoader {
+private:
+    static constexpr size_t FIELD_COUNT = 4;
+    static constexpr size_t MAX_REPORTED_REJECTS = 100;
+
+    struct ChunkResult {
+        std::vector<Book> books;
+        size_t lineCount = 0;
+        size_t rejectedCount = 0;
+        std::vector<size_t> rejectedLines;
+    };
+
+    // Splits one line into fields; false if a quote is left open, text
+    // follows a closing quote, or the field count is wrong.
+    static bool splitFields(std::string_view line, std::string fields[FIELD_COUNT]) {
+        size_t fieldCount = 0;
+        size_t position = 0;
+        while (true) {
+            if (fieldCount == FIELD_COUNT) {
+                return false;
+            }
+            std::string& field = fields[fieldCount++];
+            field.clear();
+            if (position < line.size() && line[position] == '"') {
+                ++position;
+                while (true) {
+                    size_t quote = line.find('"', position);
+                    if (quote == std::string_view::npos) {
+                        return false;
+                    }
+                    field.append(line.substr(position, quote - position));
+                    position = quote + 1;
+                    if (position < line.size() && line[position] == '"') {
+                        field.push_back('"');
+                        ++position;
+                    } else {
+                        break;
+                    }
+                }
+                if (position < line.size() && line[position] != ',') {
+                    return false;
+                }
+            } else {
+                size_t comma = std::min(line.find(',', position), line.size());
+                field.assign(line.substr(position, comma - position));
+                position = comma;
+            }
+            if (position == line.size()) {
+                return fieldCount == FIELD_COUNT;
+            }
+            ++position;
+        }
+    }
+
+    static void parseChunk(const char* begin, const char* end, bool skipHeader, ChunkResult& result) {
+        std::string fields[FIELD_COUNT];
+        for (const char* lineStart = begin; lineStart < end;) {
+            const char* newline = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+            const char* lineEnd = newline ? newline : end;
+            std::string_view line(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+            size_t lineIndex = result.lineCount++;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            if (line.empty() || (skipHeader && lineIndex == 0 && isHeader(line))) {
+                continue;
+            }
+            int year = 0;
+            if (splitFields(line, fields) && !fields[0].empty() && parseYear(fields[3], year)) {
+                result.books.emplace_back(fields[0], fields[1], fields[2], year);
+            } else {
+                ++result.rejectedCount;
+                if (result.rejectedLines.size() < MAX_REPORTED_REJECTS) {
+                    result.rejectedLines.push_back(lineIndex);
+                }
+            }
+        }
+    }
+
+    static bool isHeader(std::string_view line) {
+        if (line.size() < 4) {
+            return false;
+        }
+        std::string prefix(line.substr(0, 4));
+        std::transform(prefix.begin(), prefix.end(), prefix.begin(), [](unsigned char c) { return std::tolower(c); });
+        return prefix == "isbn" && (line.size() == 4 || line[4] == ',');
+    }
+
+    static bool parseYear(const std::string& text, int& year) {
+        const char* end = text.data() + text.size();
+        auto [parsed, error] = std::from_chars(text.data(), end, year);
+        return error == std::errc() && parsed == end;
+    }
+
+public:
+    static unsigned defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Appends every well-formed row of the file to books, in file order.
+    // Returns false only if the file cannot be opened. Rejected line numbers
+    // (1-based) are reported for the first MAX_REPORTED_REJECTS rows.
+    static bool parseFile(const std::string& path, std::vector<Book>& books, CatalogLoadStats& stats,
+                          unsigned threadCount = defaultThreadCount()) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        const char* data = file.getData();
+        size_t size = file.getSize();
+        if (size == 0) {
+            return true;
+        }
+
+        std::vector<const char*> boundaries{data};
+        for (unsigned chunk = 1; chunk < threadCount; ++chunk) {
+            const char* guess = std::max(data + size * chunk / threadCount, boundaries.back());
+            const char* newline = static_cast<const char*>(std::memchr(guess, '\n', data + size - guess));
+            boundaries.push_back(newline ? newline + 1 : data + size);
+        }
+        boundaries.push_back(data + size);
+
+        std::vector<ChunkResult> results(boundaries.size() - 1);
+        std::vector<std::thread> threads;
+        for (size_t chunk = 1; chunk < results.size(); ++chunk) {
+            threads.emplace_back(parseChunk, boundaries[chunk], boundaries[chunk + 1], false, std::ref(results[chunk]));
+        }
+        parseChunk(boundaries[0], boundaries[1], true, results[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        size_t total = books.size();
+        for (const ChunkResult& result : results) {
+            total += result.books.size();
+        }
+        books.reserve(total);
+        size_t firstLine = 1;
+        for (ChunkResult& result : results) {
+            std::move(result.books.begin(), result.books.end(), std::back_inserter(books));
+            stats.rowsLoaded += result.books.size();
+            stats.rowsRejected += result.rejectedCount;
+            for (size_t line : result.rejectedLines) {
+                if (stats.rejectedLines.size() < MAX_REPORTED_REJECTS) {
+                    stats.rejectedLines.push_back(firstLine + line);
+                }
+            }
+            firstLine += result.lineCount;
+        }
+        return true;
+    }
+};
+
+// Little helpers for the fixed-layout binary files written by the logs,
+// snapshots and indexes. Values are stored in host byte order; the files are
+// meant to be read back by the same build, not exchanged between machines.
+inline uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+class BinaryWriter {
 private:
-    string isbn;
-    string title;
-    string author;
-    int publicationYear;
-    bool available;
+    std::vector<char>& buffer;
 
 public:
-     Book() : isbn(""), title(""), author(""), publicationYear(0), available(true) {}
-    Book(string isbn, string title, string author, int publicationYear)
-        : isbn(isbn), title(title), author(author), publicationYear(publicationYear), available(true) {}
+    explicit BinaryWriter(std::vector<char>& buffer) : buffer(buffer) {}
 
-    string getIsbn() const { return isbn; }
-    string getTitle() const { return title; }
-    string getAuthor() const { return author; }
-    bool isAvailable() const { return available; }
-    void setAvailable(bool available) { this->available = available; }
+    template <typename T>
+    void write(const T& value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
 
-    bool operator==(const Book& other) const {
-        return isbn == other.isbn;
+    void writeString(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
     }
 };
 
-class Member {
+// Bounds-checked reader over a byte range, typically a memory-mapped file.
+// Once a read runs past the end, ok() turns false and later reads yield zeros.
+class BinaryReader {
 private:
-    string memberId;
-    string name;
-    string contactInfo;
-    vector<Book> borrowedBooks;
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+    bool valid = true;
 
 public:
-      Member() : memberId(""), name(""), contactInfo("") {}
-    Member(string memberId, string name, string contactInfo)
-        : memberId(memberId), name(name), contactInfo(contactInfo) {}
+    BinaryReader(const char* data, size_t size) : data(data), size(size) {}
 
-    void borrowBook(const Book& book) { borrowedBooks.push_back(book); }
-    void returnBook(const Book& book) {
-        auto it = remove_if(borrowedBooks.begin(), borrowedBooks.end(), 
-                            [&](const Book& b) { return b.getIsbn() == book.getIsbn(); });
-        if (it != borrowedBooks.end()) {
-            borrowedBooks.erase(it, borrowedBooks.end());
+    bool ok() const { return valid; }
+    size_t position() const { return offset; }
+    size_t remaining() const { return size - offset; }
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!valid || remaining() < sizeof(T)) {
+            valid = false;
+            return value;
         }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
     }
 
-    string getMemberId() const { return memberId; }
-    string getName() const { return name; }
-    vector<Book> getBorrowedBooks() const { return borrowedBooks; }
+    std::string readString() {
+        uint32_t length = read<uint32_t>();
+        if (!valid || remaining() < length) {
+            valid = false;
+            return std::string();
+        }
+        std::string value(data + offset, length);
+        offset += length;
+        return value;
+    }
+};
+
+struct CoBorrowNeighbour {
+    BookHandle book;
+    uint32_t count;
+};
+
+// Sparse "members who borrowed this also borrowed" matrix, kept up to date
+// on every borrow. Each member remembers the last MAX_HISTORY distinct books
+// they borrowed; a new borrow bumps the pair count between the new book and
+// each of those, in both directions. A book keeps at most MAX_NEIGHBOURS
+// counters, sorted by count, and when a new neighbour arrives at a full list
+// it takes over the smallest counter (the Space-Saving scheme), so frequent
+// co-borrows are kept and counts near the bottom may be overestimates. A
+// borrow costs at most MAX_HISTORY * MAX_NEIGHBOURS steps and a top-k lookup
+// is a copy of the head of one list.
+class CoBorrowIndex {
+public:
+    static constexpr size_t MAX_NEIGHBOURS = 32;
+    static constexpr size_t MAX_HISTORY = 64;
+
+private:
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x31494243; // "CBI1"
+
+    // Oldest first; once full, next is the slot the following borrow
+    // overwrites.
+    struct History {
+        std::vector<BookHandle> books;
+        size_t next = 0;
+    };
+
+    std::vector<std::vector<CoBorrowNeighbour>> neighboursByBook;
+    std::vector<History> historyByMember;
+
+    void bump(BookHandle book, BookHandle neighbour) {
+        if (book >= neighboursByBook.size()) {
+            neighboursByBook.resize(book + 1);
+        }
+        std::vector<CoBorrowNeighbour>& list = neighboursByBook[book];
+        auto it = std::find_if(list.begin(), list.end(),
+                               [neighbour](const CoBorrowNeighbour& entry) { return entry.book == neighbour; });
+        if (it != list.end()) {
+            ++it->count;
+        } else if (list.size() < MAX_NEIGHBOURS) {
+            list.push_back(CoBorrowNeighbour{neighbour, 1});
+            return;
+        } else {
+            it = list.end() - 1;
+            *it = CoBorrowNeighbour{neighbour, it->count + 1};
+        }
+        for (; it != list.begin() && std::prev(it)->count < it->count; --it) {
+            std::iter_swap(it, std::prev(it));
+        }
+    }
+
+public:
+    void recordBorrow(MemberHandle member, BookHandle book) {
+        if (member >= historyByMember.size()) {
+            historyByMember.resize(member + 1);
+        }
+        History& history = historyByMember[member];
+        if (std::find(history.books.begin(), history.books.end(), book) != history.books.end()) {
+            return;
+        }
+        for (BookHandle earlier : history.books) {
+            bump(earlier, book);
+            bump(book, earlier);
+        }
+        if (history.books.size() < MAX_HISTORY) {
+            history.books.push_back(book);
+        } else {
+            history.books[history.next] = book;
+            history.next = (history.next + 1) % MAX_HISTORY;
+        }
+    }
+
+    // The k books most often borrowed by the same members as book, most
+    // frequent first.
+    std::vector<CoBorrowNeighbour> topNeighbours(BookHandle book, size_t k) const {
+        if (book >= neighboursByBook.size()) {
+            return {};
+        }
+        const std::vector<CoBorrowNeighbour>& list = neighboursByBook[book];
+        return std::vector<CoBorrowNeighbour>(list.begin(), list.begin() + std::min(k, list.size()));
+    }
+
+    // Snapshot layout: magic, the ISBNs and member ids of every handle the
+    // loan table knows, each book's neighbour list and each member's history
+    // (oldest first) in handle order, and a trailing checksum. Handles are
+    // only meaningful within one process, so load() maps them back through
+    // the ids. Written to a temp file and renamed.
+    bool save(const std::string& path, const LoanTable& loans) const {
+        std::vector<char> buffer;
+        BinaryWriter writer(buffer);
+        writer.write(SNAPSHOT_MAGIC);
+        writer.write(static_cast<uint64_t>(loans.getBookCount()));
+        for (BookHandle book = 0; book < loans.getBookCount(); ++book) {
+            writer.writeString(loans.getIsbn(book));
+        }
+        writer.write(static_cast<uint64_t>(loans.getMemberCount()));
+        for (MemberHandle member = 0; member < loans.getMemberCount(); ++member) {
+            writer.writeString(loans.getMemberId(member));
+        }
+        for (BookHandle book = 0; book < loans.getBookCount(); ++book) {
+            size_t count = book < neighboursByBook.size() ? neighboursByBook[book].size() : 0;
+            writer.write(static_cast<uint32_t>(count));
+            for (size_t i = 0; i < count; ++i) {
+                writer.write(neighboursByBook[book][i].book);
+                writer.write(neighboursByBook[book][i].count);
+            }
+        }
+        for (MemberHandle member = 0; member < loans.getMemberCount(); ++member) {
+            if (member >= historyByMember.size()) {
+                writer.write(static_cast<uint32_t>(0));
+                continue;
+            }
+            const History& history = historyByMember[member];
+            writer.write(static_cast<uint32_t>(history.books.size()));
+            for (size_t i = 0; i < history.books.size(); ++i) {
+                writer.write(history.books[(history.next + i) % history.books.size()]);
+            }
+        }
+        writer.write(checksum(buffer.data(), buffer.size()));
+
+        std::string tempPath = path + ".tmp";
+        std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        // The bytes must be on disk before the rename publishes them, or a
+        // crash could leave a truncated index under the real name.
+        bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && syncToDisk(file);
+        written = std::fclose(file) == 0 && written;
+        std::error_code error;
+        if (!written) {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    // Replaces the index with a snapshot. Books and members loans does not
+    // know are dropped rather than interned, so a stale snapshot cannot add
+    // handles. Leaves the index untouched if the file is missing or damaged.
+    bool load(const std::string& path, const LoanTable& loans) {
+        MappedFile mapped;
+        if (!mapped.open(path) || mapped.getSize() < sizeof(uint32_t)) {
+            return false;
+        }
+        size_t bodySize = mapped.getSize() - sizeof(uint32_t);
+        BinaryReader trailer(mapped.getData() + bodySize, sizeof(uint32_t));
+        if (trailer.read<uint32_t>() != checksum(mapped.getData(), bodySize)) {
+            return false;
+        }
+        BinaryReader reader(mapped.getData(), bodySize);
+        if (reader.read<uint32_t>() != SNAPSHOT_MAGIC) {
+            return false;
+        }
+        // Every string costs at least its length prefix, which bounds the
+        // counts before anything is allocated.
+        auto readStringCount = [&reader]() {
+            uint64_t count = reader.read<uint64_t>();
+            return std::min<uint64_t>(count, reader.remaining() / sizeof(uint32_t));
+        };
+        std::vector<std::string> isbns(readStringCount());
+        for (std::string& isbn : isbns) {
+            isbn = reader.readString();
+        }
+        std::vector<std::string> memberIds(readStringCount());
+        for (std::string& memberId : memberIds) {
+            memberId = reader.readString();
+        }
+
+        std::vector<std::vector<CoBorrowNeighbour>> neighbours(isbns.size());
+        std::vector<std::vector<BookHandle>> histories(memberIds.size());
+        auto readBook = [&reader, &isbns]() {
+            BookHandle book = reader.read<BookHandle>();
+            return book < isbns.size() ? book : NO_HANDLE;
+        };
+        for (std::vector<CoBorrowNeighbour>& list : neighbours) {
+            for (uint32_t i = reader.read<uint32_t>(); i > 0 && reader.ok(); --i) {
+                BookHandle book = readBook();
+                list.push_back(CoBorrowNeighbour{book, reader.read<uint32_t>()});
+            }
+        }
+        for (std::vector<BookHandle>& history : histories) {
+            for (uint32_t i = reader.read<uint32_t>(); i > 0 && reader.ok(); --i) {
+                history.push_back(readBook());
+            }
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+
+        std::vector<BookHandle> bookHandles;
+        for (const std::string& isbn : isbns) {
+            bookHandles.push_back(loans.findBook(isbn));
+        }
+        std::vector<MemberHandle> memberHandles;
+        for (const std::string& memberId : memberIds) {
+            memberHandles.push_back(loans.findMember(memberId));
+        }
+        neighboursByBook.assign(loans.getBookCount(), {});
+        historyByMember.assign(loans.getMemberCount(), {});
+        auto known = [&bookHandles](BookHandle book) { return book != NO_HANDLE && bookHandles[book] != NO_HANDLE; };
+        for (size_t book = 0; book < neighbours.size(); ++book) {
+            if (bookHandles[book] == NO_HANDLE) {
+                continue;
+            }
+            std::vector<CoBorrowNeighbour>& list = neighboursByBook[bookHandles[book]];
+            for (const CoBorrowNeighbour& entry : neighbours[book]) {
+                if (known(entry.book) && list.size() < MAX_NEIGHBOURS) {
+                    list.push_back(CoBorrowNeighbour{bookHandles[entry.book], entry.count});
+                }
+            }
+        }
+        for (size_t member = 0; member < histories.size(); ++member) {
+            if (memberHandles[member] == NO_HANDLE) {
+                continue;
+            }
+            History& history = historyByMember[memberHandles[member]];
+            for (BookHandle book : histories[member]) {
+                if (known(book) && history.books.size() < MAX_HISTORY) {
+                    history.books.push_back(bookHandles[book]);
+                }
+            }
+        }
+        return true;
+    }
+};
+
+using TimerId = uint32_t;
+
+// Hierarchical timing wheel over integer ticks. Level l has 64 slots, each
+// covering 64^l ticks; a timer sits on the lowest level whose slot still
+// shares every higher digit with the current tick, and moves down a level
+// when the clock enters its slot. Each slot is an intrusive doubly linked
+// list of timers, so scheduling and cancelling are O(1). A bitmap of occupied
+// slots per level lets advance() jump straight to the next tick that has
+// work, so advancing costs the number of timers that fire or cascade (at
+// most one move per level each) rather than the number of ticks or the
+// number of pending timers. Timer ids are chosen by the caller and should be
+// dense, since they index the timer table.
+class TimingWheel {
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1 << SLOT_BITS;
+    static constexpr unsigned LEVELS = 6;
+    // Timers scheduled at or before the current tick wait here.
+    static constexpr unsigned READY_BUCKET = LEVELS * SLOTS;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Timer {
+        uint64_t expiry = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t bucket = NONE;
+    };
+
+    std::vector<Timer> timers;
+    std::array<uint32_t, LEVELS * SLOTS + 1> heads;
+    std::array<uint64_t, LEVELS> occupied{};
+    uint64_t now = 0;
+
+    static unsigned lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned bit = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    static uint64_t digit(uint64_t tick, unsigned level) {
+        return (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    }
+
+    void link(TimerId id, uint32_t bucket) {
+        Timer& timer = timers[id];
+        timer.bucket = bucket;
+        timer.prev = NONE;
+        timer.next = heads[bucket];
+        if (timer.next != NONE) {
+            timers[timer.next].prev = id;
+        }
+        heads[bucket] = id;
+        if (bucket != READY_BUCKET) {
+            occupied[bucket / SLOTS] |= uint64_t(1) << (bucket % SLOTS);
+        }
+    }
+
+    void unlink(TimerId id) {
+        Timer& timer = timers[id];
+        if (timer.prev != NONE) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            heads[timer.bucket] = timer.next;
+            if (timer.next == NONE && timer.bucket != READY_BUCKET) {
+                occupied[timer.bucket / SLOTS] &= ~(uint64_t(1) << (timer.bucket % SLOTS));
+            }
+        }
+        if (timer.next != NONE) {
+            timers[timer.next].prev = timer.prev;
+        }
+        timer.bucket = NONE;
+    }
+
+    // Files a timer with expiry >= now on the lowest level that can hold it.
+    void place(TimerId id) {
+        uint64_t expiry = timers[id].expiry;
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            unsigned higherBits = SLOT_BITS * (level + 1);
+            if ((expiry >> higherBits) == (now >> higherBits)) {
+                link(id, static_cast<uint32_t>(level * SLOTS + digit(expiry, level)));
+                return;
+            }
+        }
+        throw std::runtime_error("Timer expiry is beyond the wheel's range");
+    }
+
+    // Next tick after now at which some slot needs cascading or firing, or
+    // UINT64_MAX if the wheel is empty.
+    uint64_t nextBusyTick() const {
+        uint64_t next = UINT64_MAX;
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            uint64_t current = digit(now, level);
+            uint64_t later = current == SLOTS - 1 ? 0 : occupied[level] & (~uint64_t(0) << (current + 1));
+            if (later) {
+                unsigned higherBits = SLOT_BITS * (level + 1);
+                uint64_t tick = (now >> higherBits << higherBits) |
+                                (uint64_t(lowestBit(later)) << (SLOT_BITS * level));
+                next = std::min(next, tick);
+            }
+        }
+        return next;
+    }
+
+    void drain(uint32_t bucket, std::vector<TimerId>& fired) {
+        while (heads[bucket] != NONE) {
+            TimerId id = heads[bucket];
+            unlink(id);
+            fired.push_back(id);
+        }
+    }
+
+public:
+    TimingWheel() {
+        heads.fill(NONE);
+    }
+
+    uint64_t getNow() const { return now; }
+
+    bool isScheduled(TimerId id) const {
+        return id < timers.size() && timers[id].bucket != NONE;
+    }
+
+    // Arms or re-arms a timer. One at or before the current tick fires on the
+    // next advance().
+    void schedule(TimerId id, uint64_t expiry) {
+        if (id >= timers.size()) {
+            timers.resize(id + 1);
+        }
+        cancel(id);
+        timers[id].expiry = expiry;
+        if (expiry <= now) {
+            link(id, READY_BUCKET);
+        } else {
+            place(id);
+        }
+    }
+
+    void cancel(TimerId id) {
+        if (isScheduled(id)) {
+            unlink(id);
+        }
+    }
+
+    // Moves the clock forward to tick and appends the timers that expired,
+    // in expiry order, to fired. Fired timers are disarmed.
+    void advance(uint64_t tick, std::vector<TimerId>& fired) {
+        drain(READY_BUCKET, fired);
+        while (true) {
+            uint64_t next = nextBusyTick();
+            if (next > tick) {
+                now = std::max(now, tick);
+                return;
+            }
+            now = next;
+            for (unsigned level = LEVELS - 1; level > 0; --level) {
+                uint32_t bucket = static_cast<uint32_t>(level * SLOTS + digit(now, level));
+                while (heads[bucket] != NONE) {
+                    TimerId id = heads[bucket];
+                    unlink(id);
+                    place(id);
+                }
+            }
+            drain(static_cast<uint32_t>(digit(now, 0)), fired);
+        }
+    }
+};
+
+// One page of ranked search results. Pass cursor to searchBooksAfter for
+// the next page; it is only meaningful when hasMore is set.
+struct SearchPage {
+    std::vector<const Book*> books;
+    bool hasMore = false;
+    SearchRank cursor;
+};
+
+// Raised by advanceClock: a reminder shortly before a loan is due, or a
+// notice on the first day it is overdue.
+struct LoanEvent {
+    enum class Type { REMINDER, OVERDUE };
+
+    Type type;
+    std::string memberId;
+    std::string isbn;
+    int64_t dueDay;
 };
 
 class LibraryManager {
 private:
     unordered_map<string, Book> catalog;
     unordered_map<string, Member> members;
-    const int MAX_BOOKS_PER_MEMBER = 5;
+    BookSearchIndex searchIndex;
+    // Filled by the const search calls.
+    mutable SearchResultCache searchCache;
+    // The index id generation the cached results were built under.
+    uint64_t searchIdGeneration = 0;
+    LoanTable loans;
+    static constexpr size_t MAX_BOOKS_PER_MEMBER = LoanTable::MAX_LOANS_PER_MEMBER;
+    static constexpr int64_t LOAN_PERIOD_DAYS = 14;
+    static constexpr int64_t REMINDER_DAYS_BEFORE_DUE = 2;
+
+    // Days count from 0 when the library starts. Each loan arms two timers,
+    // 2 * book for its reminder and 2 * book + 1 for its overdue notice.
+    TimingWheel loanTimers;
+    vector<int64_t> dueDayByBook;
+    CoBorrowIndex coBorrows;
 
     LibraryManager() {}
 
+    static TimerId reminderTimer(BookHandle book) { return 2 * book; }
+    static TimerId overdueTimer(BookHandle book) { return 2 * book + 1; }
+
+    void startLoanTimers(BookHandle book) {
+        int64_t today = getToday();
+        int64_t dueDay = today + LOAN_PERIOD_DAYS;
+        if (book >= dueDayByBook.size()) {
+            dueDayByBook.resize(book + 1);
+        }
+        dueDayByBook[book] = dueDay;
+        if (dueDay - REMINDER_DAYS_BEFORE_DUE > today) {
+            loanTimers.schedule(reminderTimer(book), static_cast<uint64_t>(dueDay - REMINDER_DAYS_BEFORE_DUE));
+        }
+        loanTimers.schedule(overdueTimer(book), static_cast<uint64_t>(dueDay + 1));
+    }
+
+    void stopLoanTimers(BookHandle book) {
+        loanTimers.cancel(reminderTimer(book));
+        loanTimers.cancel(overdueTimer(book));
+    }
+
+    // Drops the book from cached search results while its old title and
+    // author are still around to find them.
+    void forgetIndexedBook(const string& isbn) {
+        BookId id = searchIndex.idOf(isbn);
+        if (id != NO_BOOK_ID) {
+            searchCache.bookRemoved(id, *searchIndex.get(id));
+        }
+    }
+
+    // Cached results hold index ids, which a purge renumbers.
+    void dropStaleSearchResults() {
+        if (searchIndex.getIdGeneration() != searchIdGeneration) {
+            searchIdGeneration = searchIndex.getIdGeneration();
+            searchCache.clear();
+        }
+    }
+
+    // Calls visit(id) for each match, from the result cache when possible.
+    template <typename Visit>
+    void forEachMatchingId(const string& keyword, Visit visit) const {
+        if (const vector<BookId>* cached = searchCache.find(keyword)) {
+            for (BookId id : *cached) {
+                visit(id);
+            }
+            return;
+        }
+        vector<BookId> ids = searchIndex.find(keyword);
+        for (BookId id : ids) {
+            visit(id);
+        }
+        searchCache.insert(keyword, ids);
+    }
+
+    SearchPage toPage(const string& keyword, const RankedMatches& matches) const {
+        SearchPage page;
+        page.hasMore = matches.hasMore;
+        for (BookId id : matches.ids) {
+            page.books.push_back(searchIndex.get(id));
+        }
+        if (!matches.ids.empty()) {
+            page.cursor = searchIndex.rankOf(matches.ids.back(), keyword);
+        }
+        return page;
+    }
+
 public:
     static LibraryManager& getInstance() {
         static LibraryManager instance;
         return instance;
     }
 
-    void addBook(const Book& book) { catalog[book.getIsbn()] = book; }
-    void removeBook(const string& isbn) { catalog.erase(isbn); }
+    void addBook(const Book& book) {
+        forgetIndexedBook(book.getIsbn());
+        Book& stored = catalog[book.getIsbn()];
+        stored = book;
+        searchCache.bookAdded(searchIndex.add(&stored), stored);
+        dropStaleSearchResults();
+        loans.internBook(book.getIsbn());
+    }
+
+    // Bulk variant of addBook: the catalog grows once and the search index is
+    // built in one pass. Later copies of an ISBN replace earlier ones.
+    void addBooks(const vector<Book>& books) {
+        catalog.reserve(catalog.size() + books.size());
+        vector<const Book*> stored;
+        stored.reserve(books.size());
+        unordered_set<const Book*> seen;
+        for (const Book& book : books) {
+            Book& slot = catalog[book.getIsbn()];
+            slot = book;
+            if (seen.insert(&slot).second) {
+                stored.push_back(&slot);
+            }
+            loans.internBook(book.getIsbn());
+        }
+        searchIndex.addBulk(stored);
+        searchCache.clear();
+        searchIdGeneration = searchIndex.getIdGeneration();
+    }
+
+    // Loads a catalog dump (see CatalogLoader for the format) and prints the
+    // load rate. Malformed rows are skipped and counted in the result.
+    CatalogLoadStats loadCatalog(const string& path, unsigned threadCount = CatalogLoader::defaultThreadCount()) {
+        CatalogLoadStats stats;
+        auto start = chrono::steady_clock::now();
+        vector<Book> books;
+        if (!CatalogLoader::parseFile(path, books, stats, threadCount)) {
+            cout << "Cannot open catalog file: " << path << endl;
+            return stats;
+        }
+        addBooks(books);
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "Loaded " << stats.rowsLoaded << " books, rejected " << stats.rowsRejected << " rows, "
+             << static_cast<long long>(stats.getRowsPerSecond()) << " rows/s" << endl;
+        return stats;
+    }
+
+    void removeBook(const string& isbn) {
+        forgetIndexedBook(isbn);
+        searchIndex.remove(isbn);
+        dropStaleSearchResults();
+        catalog.erase(isbn);
+    }
+
     Book getBook(const string& isbn) {
         auto it = catalog.find(isbn);
         if (it != catalog.end()) {
@@ -80,8 +1828,28 @@ public:
             throw runtime_error("Book not found");
         }
     }
-    void registerMember(const Member& member) { members[member.getMemberId()] = member; }
-    void unregisterMember(const string& memberId) { members.erase(memberId); }
+    void registerMember(const Member& member) {
+        members[member.getMemberId()] = member;
+        loans.internMember(member.getMemberId());
+    }
+
+    // Also hands back every book the member still holds.
+    void unregisterMember(const string& memberId) {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        if (memberHandle != NO_HANDLE) {
+            while (loans.getLoanCount(memberHandle) > 0) {
+                BookHandle bookHandle = *loans.getLoans(memberHandle).begin();
+                loans.returnBook(memberHandle, bookHandle);
+                stopLoanTimers(bookHandle);
+                auto bookIt = catalog.find(loans.getIsbn(bookHandle));
+                if (bookIt != catalog.end()) {
+                    bookIt->second.setAvailable(true);
+                }
+            }
+        }
+        members.erase(memberId);
+    }
+
     Member getMember(const string& memberId) {
         auto it = members.find(memberId);
         if (it != members.end()) {
@@ -107,9 +1875,12 @@ public:
         Member& member = memberIt->second;
         Book& book = bookIt->second;
 
-        if (book.isAvailable() && member.getBorrowedBooks().size() < MAX_BOOKS_PER_MEMBER) {
-            member.borrowBook(book);
+        MemberHandle memberHandle = loans.findMember(memberId);
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (book.isAvailable() && loans.borrowBook(memberHandle, bookHandle)) {
             book.setAvailable(false);
+            startLoanTimers(bookHandle);
+            coBorrows.recordBorrow(memberHandle, bookHandle);
             cout << "Book borrowed: " << book.getTitle() << " by " << member.getName() << endl;
         } else {
             cout << "Cannot borrow book." << endl;
@@ -132,20 +1903,135 @@ public:
         Member& member = memberIt->second;
         Book& book = bookIt->second;
 
-        member.returnBook(book);
-        book.setAvailable(true);
-        cout << "Book returned: " << book.getTitle() << " by " << member.getName() << endl;
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (loans.returnBook(loans.findMember(memberId), bookHandle)) {
+            book.setAvailable(true);
+            stopLoanTimers(bookHandle);
+            cout << "Book returned: " << book.getTitle() << " by " << member.getName() << endl;
+        } else {
+            cout << "Book is not borrowed by this member." << endl;
+        }
+    }
+
+    size_t getBorrowedCount(const string& memberId) const {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        return memberHandle == NO_HANDLE ? 0 : loans.getLoanCount(memberHandle);
+    }
+
+    int64_t getToday() const {
+        return static_cast<int64_t>(loanTimers.getNow());
+    }
+
+    int64_t getDueDay(const string& isbn) const {
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (bookHandle == NO_HANDLE || loans.getHolder(bookHandle) == NO_HANDLE) {
+            throw runtime_error("Book is not on loan");
+        }
+        return dueDayByBook[bookHandle];
+    }
+
+    // Moves the library clock forward and returns the reminders and overdue
+    // notices that came due, oldest first. The cost depends on the loans that
+    // expire, not on how many are outstanding. The clock never moves back.
+    vector<LoanEvent> advanceClock(int64_t days) {
+        if (days < 0) {
+            throw runtime_error("Cannot move the library clock backwards");
+        }
+        vector<TimerId> fired;
+        loanTimers.advance(static_cast<uint64_t>(getToday() + days), fired);
+        vector<LoanEvent> events;
+        events.reserve(fired.size());
+        for (TimerId timer : fired) {
+            BookHandle bookHandle = timer / 2;
+            LoanEvent::Type type = timer == overdueTimer(bookHandle) ? LoanEvent::Type::OVERDUE : LoanEvent::Type::REMINDER;
+            events.push_back(LoanEvent{type, loans.getMemberId(loans.getHolder(bookHandle)), loans.getIsbn(bookHandle),
+                                       dueDayByBook[bookHandle]});
+        }
+        return events;
+    }
+
+    // "Members who borrowed this also borrowed": up to k catalog books most
+    // often borrowed by the same members as isbn, most frequent first.
+    vector<const Book*> getAlsoBorrowed(const string& isbn, size_t k) const {
+        vector<const Book*> books;
+        BookHandle bookHandle = loans.findBook(isbn);
+        if (k == 0 || bookHandle == NO_HANDLE) {
+            return books;
+        }
+        for (const CoBorrowNeighbour& neighbour : coBorrows.topNeighbours(bookHandle, CoBorrowIndex::MAX_NEIGHBOURS)) {
+            auto bookIt = catalog.find(loans.getIsbn(neighbour.book));
+            if (bookIt != catalog.end()) {
+                books.push_back(&bookIt->second);
+                if (books.size() == k) {
+                    break;
+                }
+            }
+        }
+        return books;
+    }
+
+    bool saveCoBorrowSnapshot(const string& path) const {
+        return coBorrows.save(path, loans);
     }
 
-    vector<Book> searchBooks(const string& keyword) {
-        vector<Book> matchingBooks;
-        for (const auto& [isbn, book] : catalog) {
-            if (book.getTitle().find(keyword) != string::npos || book.getAuthor().find(keyword) != string::npos) {
-                matchingBooks.push_back(book);
+    bool loadCoBorrowSnapshot(const string& path) {
+        return coBorrows.load(path, loans);
+    }
+
+    // Calls visit(book) for each book the member holds, without copying.
+    template <typename Visit>
+    void forEachBorrowedBook(const string& memberId, Visit visit) const {
+        MemberHandle memberHandle = loans.findMember(memberId);
+        if (memberHandle == NO_HANDLE) {
+            return;
+        }
+        for (BookHandle bookHandle : loans.getLoans(memberHandle)) {
+            auto bookIt = catalog.find(loans.getIsbn(bookHandle));
+            if (bookIt != catalog.end()) {
+                visit(bookIt->second);
             }
         }
+    }
+
+    // Books whose title or author contains keyword, served from the result
+    // cache or the trigram index. The pointers stay valid until the book is
+    // removed or re-added.
+    vector<const Book*> searchBooks(const string& keyword) const {
+        vector<const Book*> matchingBooks;
+        forEachMatchingId(keyword, [&](BookId id) { matchingBooks.push_back(searchIndex.get(id)); });
         return matchingBooks;
     }
+
+    // Ranked page of matches (see SearchRank), skipping the first offset.
+    // Cost grows with offset + limit, not with the number of matches.
+    SearchPage searchBooksPage(const string& keyword, size_t offset, size_t limit) const {
+        return toPage(keyword, searchIndex.findRanked(keyword, offset, limit));
+    }
+
+    // The next limit matches ranked after the cursor of a previous page.
+    SearchPage searchBooksAfter(const string& keyword, const SearchRank& cursor, size_t limit) const {
+        return toPage(keyword, searchIndex.findRanked(keyword, 0, limit, &cursor));
+    }
+
+    // Ids name the same books only until the next catalog edit.
+    vector<BookId> searchBookIds(const string& keyword) const {
+        vector<BookId> ids;
+        forEachMatchingId(keyword, [&ids](BookId id) { ids.push_back(id); });
+        return ids;
+    }
+
+    const SearchCacheStats& getSearchCacheStats() const {
+        return searchCache.getStats();
+    }
+
+    // Bounds the search cache by entry count and by ids held in total.
+    void setSearchCacheCapacity(size_t maxEntries, size_t maxIds) {
+        searchCache.setCapacity(maxEntries, maxIds);
+    }
+
+    const Book* getBookById(BookId id) const {
+        return searchIndex.get(id);
+    }
 };
 
 int main() {
@@ -167,11 +2053,30 @@ int main() {
     // Return books
     libraryManager.returnBook("M1", "ISBN1");
 
+    // Advance the library clock past the due date
+    for (const auto& event : libraryManager.advanceClock(15)) {
+        cout << (event.type == LoanEvent::Type::OVERDUE ? "Overdue: " : "Reminder: ") << event.isbn
+             << " held by " << event.memberId << endl;
+    }
+
     // Search books
     auto searchResults = libraryManager.searchBooks("Book");
     cout << "Search Results:" << endl;
     for (const auto& book : searchResults) {
-        cout << book.getTitle() << " by " << book.getAuthor() << endl;
+        cout << book->getTitle() << " by " << book->getAuthor() << endl;
+    }
+
+    // Ranked search, two results per page
+    auto page = libraryManager.searchBooksPage("Book", 0, 2);
+    cout << "Ranked Results:" << endl;
+    while (true) {
+        for (const auto& book : page.books) {
+            cout << book->getTitle() << " (" << book->getPublicationYear() << ")" << endl;
+        }
+        if (!page.hasMore) {
+            break;
+        }
+        page = libraryManager.searchBooksAfter("Book", page.cursor, 2);
     }
 
     return 0;
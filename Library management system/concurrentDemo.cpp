@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentLibraryManager.cpp"
+
+// Mixed read/write benchmark: reader threads run searches and lookups while
+// two writer threads keep borrowing and returning books. Prints read
+// throughput per reader count; on a multi-core machine it should grow with
+// the number of readers since reads take no locks.
+int main() {
+    ConcurrentLibraryManager libraryManager;
+    const int bookCount = 100000;
+    const int memberCount = 1000;
+    const std::vector<std::string> words = {"River", "Stone", "Night", "Garden", "Winter", "Glass", "Harbor", "Silver"};
+
+    std::vector<Book> books;
+    for (int i = 0; i < bookCount; ++i) {
+        books.emplace_back("ISBN" + std::to_string(i),
+                           words[i % words.size()] + " " + words[(i / 8) % words.size()] + " " + std::to_string(i),
+                           "Author " + std::to_string(i % 5000), 1950 + i % 70);
+    }
+    libraryManager.addBooks(books);
+    for (int i = 0; i < memberCount; ++i) {
+        libraryManager.registerMember(Member("M" + std::to_string(i), "Member " + std::to_string(i), ""));
+    }
+
+    const auto duration = std::chrono::milliseconds(500);
+    unsigned maxReaders = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned readers = 1; readers <= maxReaders; readers *= 2) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> reads{0};
+        std::atomic<uint64_t> writes{0};
+        std::atomic<size_t> matchesSeen{0};
+        std::vector<std::thread> threads;
+        for (unsigned r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r]() {
+                uint64_t count = 0;
+                size_t matches = 0;
+                for (unsigned i = r; !stop.load(std::memory_order_relaxed); ++i) {
+                    if (i % 4 == 0) {
+                        matches += libraryManager.countMatches("Author " + std::to_string(i % 5000) + "0");
+                    } else {
+                        matches += libraryManager.getBook("ISBN" + std::to_string(i % bookCount)).isAvailable();
+                    }
+                    ++count;
+                }
+                reads += count;
+                matchesSeen += matches;
+            });
+        }
+        for (int w = 0; w < 2; ++w) {
+            threads.emplace_back([&, w]() {
+                uint64_t count = 0;
+                for (unsigned i = w; !stop.load(std::memory_order_relaxed); i += 2) {
+                    std::string memberId = "M" + std::to_string(i % memberCount);
+                    std::string isbn = "ISBN" + std::to_string((i * 7919) % bookCount);
+                    if (libraryManager.borrowBook(memberId, isbn)) {
+                        libraryManager.returnBook(memberId, isbn);
+                    }
+                    ++count;
+                }
+                writes += count;
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(duration).count();
+        std::cout << readers << " reader(s): " << static_cast<uint64_t>(reads / seconds) << " reads/s, "
+                  << static_cast<uint64_t>(writes / seconds) << " borrow/return cycles/s" << std::endl;
+    }
+
+    // Every borrow above was returned, so all books must be available again.
+    int unavailable = 0;
+    for (int i = 0; i < bookCount; ++i) {
+        unavailable += !libraryManager.getBook("ISBN" + std::to_string(i)).isAvailable();
+    }
+    std::cout << "Books still marked borrowed: " << unavailable << std::endl;
+    return unavailable == 0 ? 0 : 1;
+}
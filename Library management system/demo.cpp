@@ -23,11 +23,30 @@ int main() {
     // Return books
     libraryManager.returnBook("M1", "ISBN1");
 
+    // Advance the library clock past the due date
+    for (const auto& event : libraryManager.advanceClock(15)) {
+        std::cout << (event.type == LoanEvent::Type::OVERDUE ? "Overdue: " : "Reminder: ") << event.isbn
+                  << " held by " << event.memberId << std::endl;
+    }
+
     // Search books
     auto searchResults = libraryManager.searchBooks("Book");
     std::cout << "Search Results:" << std::endl;
     for (const auto& book : searchResults) {
-        std::cout << book.getTitle() << " by " << book.getAuthor() << std::endl;
+        std::cout << book->getTitle() << " by " << book->getAuthor() << std::endl;
+    }
+
+    // Ranked search, two results per page
+    auto page = libraryManager.searchBooksPage("Book", 0, 2);
+    std::cout << "Ranked Results:" << std::endl;
+    while (true) {
+        for (const auto& book : page.books) {
+            std::cout << book->getTitle() << " (" << book->getPublicationYear() << ")" << std::endl;
+        }
+        if (!page.hasMore) {
+            break;
+        }
+        page = libraryManager.searchBooksAfter("Book", page.cursor, 2);
     }
 
     return 0;
@@ -0,0 +1,46 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BookSearchIndex.cpp"
+#include "LibraryManager.cpp"
+
+// Replaces the same catalog over and over, as a nightly reload would, and
+// checks that each round costs about the same, that searches still find
+// every book once, and that the search index's id space follows the live
+// catalog rather than every book ever loaded.
+int main() {
+    const int bookCount = 20000;
+    const int rounds = 20;
+    std::vector<Book> books;
+    for (int i = 0; i < bookCount; ++i) {
+        books.emplace_back("RELOAD" + std::to_string(i), "Reloaded title " + std::to_string(i),
+                           "Reload author " + std::to_string(i % 100), 1990 + i % 30);
+    }
+
+    LibraryManager& libraryManager = LibraryManager::getInstance();
+    BookSearchIndex index;
+    size_t largestIdSpace = 0;
+    bool consistent = true;
+    for (int round = 0; round < rounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (const Book& book : books) {
+            libraryManager.addBook(book);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t found = libraryManager.searchBooks("Reloaded title").size();
+        consistent = consistent && found == books.size();
+
+        for (const Book& book : books) {
+            index.add(&book);
+            largestIdSpace = std::max(largestIdSpace, index.getIdSpace());
+        }
+        if (round % 5 == 0 || round == rounds - 1) {
+            std::cout << "Round " << round << ": " << seconds * 1000 << " ms, " << found << " found" << std::endl;
+        }
+    }
+    std::cout << "Largest id space: " << largestIdSpace << " for " << books.size() << " live books" << std::endl;
+    consistent = consistent && largestIdSpace <= 2 * books.size() + 1;
+    std::cout << "Consistent: " << (consistent ? "yes" : "no") << std::endl;
+    return consistent ? 0 : 1;
+}